@@ -0,0 +1,84 @@
+"""
+Reader of the binary time series written by obstream.c (see the comments
+at the top of modules/comp_mat_science/obstream.c for the format).
+
+    import sys
+    sys.path.append("..")
+    import obstream
+
+    data = obstream.load("energy_and_nbrsJ0-0.4T300.obs")
+    energy = data["energy"]
+    layer = data["first_layer"]
+
+load() returns a numpy structured array with one field per column, the
+header (column names, stride, format) is returned by header().
+"""
+
+import numpy as np
+
+OBS_DOUBLE = 0
+OBS_INT = 1
+
+OBS_BINARY = 1
+OBS_DELTA = 2
+OBS_RLE = 4
+
+NAME_LENGTH = 16
+BYTE_ORDER = 0x01020304
+
+
+def _parse_header(buf):
+    if buf[:8].tobytes() != b"OBSTREAM":
+        raise ValueError("not an observable stream")
+
+    for order in ("<", ">"):
+        if np.frombuffer(buf, dtype=order + "i4", count=1, offset=8)[0] == BYTE_ORDER:
+            break
+    else:
+        raise ValueError("unknown byte order")
+
+    version, n_columns, stride, fmt = np.frombuffer(buf, dtype=order + "i4", count=4, offset=12)
+
+    if version != 1:
+        raise ValueError("version %d not supported" % version)
+
+    offset = 28
+    fields = []
+
+    for c in range(n_columns):
+        name = buf[offset:offset + NAME_LENGTH].tobytes().split(b"\0")[0].decode()
+        kind = np.frombuffer(buf, dtype=order + "i4", count=1, offset=offset + NAME_LENGTH)[0]
+        fields.append((name, order + ("f8" if kind == OBS_DOUBLE else "i4")))
+        offset += NAME_LENGTH + 4
+
+    return {"names": [f[0] for f in fields], "dtype": np.dtype(fields), "stride": int(stride),
+            "format": int(fmt), "order": order, "offset": offset}
+
+
+def header(file_name):
+    """Column names, row dtype, stride and format of the file."""
+    return _parse_header(np.fromfile(file_name, dtype=np.uint8, count=4096))
+
+
+def load(file_name):
+    """All the rows of the file as a structured array."""
+    buf = np.fromfile(file_name, dtype=np.uint8)
+    h = _parse_header(buf)
+    body = buf[h["offset"]:]
+
+    if h["format"] & OBS_RLE:
+        runs = np.frombuffer(body, dtype=np.dtype([("run", h["order"] + "i4"), ("row", h["dtype"])]))
+        rows = np.repeat(runs["row"], runs["run"])
+    else:
+        rows = np.frombuffer(body, dtype=h["dtype"]).copy()
+
+    if h["format"] & OBS_DELTA:
+        for name in h["names"]:
+            column = rows[name]
+            if column.dtype.kind == "f":
+                bits = np.ascontiguousarray(column).view(h["order"] + "u8")
+                rows[name] = np.bitwise_xor.accumulate(bits).view(column.dtype)
+            else:
+                rows[name] = np.cumsum(column, dtype=column.dtype)
+
+    return rows
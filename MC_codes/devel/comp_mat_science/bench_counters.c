@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *
+ * File bench_counters.c
+ *
+ * Hardware counters of the kernels of the lattice gas (see perfcount.c).
+ * After N_TERM moves of thermalization, N_SWEEP moves are made with
+ * teleports only and with local hops only, and eval_E() and
+ * count_bonds_contacts() are called N_CALLS times. For every region the
+ * CPU time per move or per call is printed, followed by the instructions
+ * per cycle, the cache misses per thousand instructions and the fraction
+ * of mispredicted branches (n/a where the counters are not available).
+ * T is 300 K if not given, e.g.
+ *
+ *  ./bench_counters T=300 LX=60 LY=60 N=1000 N_SWEEP=10000000
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+#include "perfcount.h"
+
+#define N_CALLS 1000
+
+int main(int argc, char *argv[])
+{
+    int i, k, b, c;
+    char *regions[2] = {"teleport", "local_hop"};
+    double fractions[2] = {0, 1}, e;
+    parameters_t par;
+    lattice_t *lat;
+
+    read_parameters(argc, argv, &par);
+    if (par.temperature == 0)
+        par.temperature = 300;
+
+    printf("N = %d, T = %.1f, J0 = %.3f, %d + %d moves, %d hardware counters available\n",
+           par.n_atoms, par.temperature, par.j0, par.n_term, par.n_sweep, perf_available());
+
+    for (k = 0; k < 2; k++)
+    {
+        par.hop_fraction = fractions[k];
+        lat = new_lattice(&par);
+        init_configuration(lat);
+
+        for (i = 0; i < par.n_term; i++)
+            sweep(lat);
+
+        perf_start(regions[k]);
+        for (i = 0; i < par.n_sweep; i++)
+            sweep(lat);
+        perf_stop(regions[k]);
+
+        printf("%-10s %8.2f ns per move\n", regions[k],
+               perf_count(regions[k], PERF_TASK_CLOCK) / par.n_sweep);
+
+        free_lattice(lat);
+    }
+
+    lat = new_lattice(&par);
+    init_configuration(lat);
+    e = 0;
+
+    perf_start("eval_E");
+    for (i = 0; i < N_CALLS; i++)
+        e += eval_E(lat);
+    perf_stop("eval_E");
+
+    perf_start("bonds_contacts");
+    for (i = 0; i < N_CALLS; i++)
+    {
+        count_bonds_contacts(lat, &b, &c);
+        e -= lat->j1 * b + lat->j0 * c;
+    }
+    perf_stop("bonds_contacts");
+
+    error(e > 1e-6 * N_CALLS || e < -1e-6 * N_CALLS, 1, "main [bench_counters.c]",
+          "eval_E() and count_bonds_contacts() disagree");
+
+    printf("%-10s %8.2f us per call\n", "eval_E", 1e-3 * perf_count("eval_E", PERF_TASK_CLOCK) / N_CALLS);
+    printf("%-10s %8.2f us per call\n", "bonds",
+           1e-3 * perf_count("bonds_contacts", PERF_TASK_CLOCK) / N_CALLS);
+
+    free_lattice(lat);
+    perf_print(stdout);
+
+    return 0;
+}
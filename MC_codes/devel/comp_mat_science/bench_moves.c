@@ -0,0 +1,92 @@
+/*******************************************************************************
+ *
+ * File bench_moves.c
+ *
+ * Efficiency of the mixed hop/teleport move sets of sweep(). For hop
+ * fractions between 0 (only teleports) and 1 (only local hops) the lattice
+ * is thermalized with N_TERM moves, then N_SWEEP moves are made and the
+ * energy is sampled every N moves (one move per atom). The acceptance of
+ * the two kinds of moves, the integrated autocorrelation time of the
+ * energy (in moves) and the number of independent samples per CPU second
+ * are printed. T is 300 K if not given, e.g.
+ *
+ *  ./bench_moves T=300 J0=-0.4 N_SWEEP=10000000
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "autocorrelation.h"
+#include <time.h>
+
+#define N_FRACTIONS 6
+
+int main(int argc, char *argv[])
+{
+    int i, k, n, window;
+    double fractions[N_FRACTIONS] = {0, 0.5, 0.8, 0.9, 0.99, 1};
+    double *energy, tau, seconds, mean;
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat;
+
+    read_parameters(argc, argv, &par);
+    if (par.temperature == 0)
+        par.temperature = 300;
+
+    n = par.n_sweep / par.n_atoms;
+    energy = (double *)malloc(n * sizeof(double));
+    error(n < 100 || energy == NULL, 1, "main [bench_moves.c]", "N_SWEEP too small");
+
+    printf("N = %d, T = %.1f, J0 = %.3f, %d + %d moves, one sample every %d moves\n",
+           par.n_atoms, par.temperature, par.j0, par.n_term, par.n_sweep, par.n_atoms);
+    printf("hops   acc(teleport)  acc(hop)   <E>         tau_E (moves)  window  "
+           "time (s)  samples/s\n");
+
+    for (k = 0; k < N_FRACTIONS; k++)
+    {
+        par.hop_fraction = fractions[k];
+        lat = new_lattice(&par);
+        init_configuration(lat);
+
+        for (i = 0; i < par.n_term; i++)
+            sweep(lat);
+
+        start = clock();
+
+        for (i = 0; i < n * par.n_atoms; i++)
+        {
+            if (i % par.n_atoms == 0)
+                energy[i / par.n_atoms] = eval_E(lat);
+
+            sweep(lat);
+        }
+
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        mean = 0;
+        for (i = 0; i < n; i++)
+            mean += energy[i] / n;
+
+        tau = autocorrelation_time(energy, n, &window);
+
+        printf("%.2f   %.6f       %.6f   %10.6f  %12.1f  %6d%s  %7.3f  %9.1f\n", fractions[k],
+               acceptance_rate(lat, MOVE_TELEPORT), acceptance_rate(lat, MOVE_HOP), mean,
+               tau * par.n_atoms, window, (window >= n / 2 - 1) ? "*" : " ", seconds,
+               n / (2 * tau) / seconds);
+
+        free_lattice(lat);
+    }
+
+    printf("(* the series is too short for a reliable estimate of tau)\n");
+
+    free(energy);
+
+    return 0;
+}
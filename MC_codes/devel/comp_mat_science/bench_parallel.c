@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *
+ * File bench_parallel.c
+ *
+ * Cost of sweep() and scaling of parallel_sweep() with the number of
+ * threads. The time per Metropolis move is measured over N_BENCH*N moves on
+ * one thread; then for each number of threads the same initial
+ * configuration is evolved for N_BENCH parallel sweeps and the wall-clock
+ * time per hop attempt is printed, together with the final energy. The
+ * final configuration must be the same for every number of threads, which
+ * is checked against the one obtained on one thread.
+ *
+ * The parameters are read from the command line, the benchmarks used so far
+ * are
+ *
+ *  ./bench_parallel DIM=2 LX=512 LY=512 N=52429 T=600
+ *  ./bench_parallel LX=256 LY=256 LZ=32 N=209715 T=600
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "montecarlo.h"
+#include "random.h"
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define N_BENCH 100
+
+static double wall_time()
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    int i, nthreads, max_threads, *sites;
+    double start, elapsed, t1;
+    parameters_t par;
+    lattice_t *lat;
+
+    read_parameters(argc, argv, &par);
+    lat = new_lattice(&par);
+    sites = (int *)malloc(lat->n_atoms * sizeof(int));
+    assert(sites != NULL);
+
+    max_threads = 1;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+
+    printf("DIM=%d LX=%d LY=%d LZ=%d N=%d T=%.1f, %d sweeps\n", lat->dim, lat->lx, lat->ly,
+           lat->lz, lat->n_atoms, lat->temperature, N_BENCH);
+
+    init_configuration(lat);
+
+    start = wall_time();
+    for (i = 0; i < N_BENCH * lat->n_atoms; i++)
+        sweep(lat);
+    elapsed = wall_time() - start;
+
+    printf("sweep: %.3f ns/move, final energy %.6f\n",
+           1e9 * elapsed / ((double)N_BENCH * lat->n_atoms), eval_E(lat));
+    printf("threads  ns/hop    speedup  final energy  same as 1 thread\n");
+
+    t1 = 0;
+
+    for (nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(nthreads);
+#endif
+        init_configuration(lat);
+
+        start = wall_time();
+        for (i = 0; i < N_BENCH; i++)
+            parallel_sweep(lat);
+        elapsed = wall_time() - start;
+
+        if (nthreads == 1)
+        {
+            t1 = elapsed;
+            memcpy(sites, lat->atom_site, lat->n_atoms * sizeof(int));
+        }
+
+        printf("%7d  %8.3f  %7.2f  %.6f  %s\n", nthreads,
+               1e9 * elapsed / ((double)N_BENCH * lat->n_atoms), t1 / elapsed, eval_E(lat),
+               memcmp(sites, lat->atom_site, lat->n_atoms * sizeof(int)) ? "no" : "yes");
+    }
+
+    free(sites);
+    free_lattice(lat);
+
+    return 0;
+}
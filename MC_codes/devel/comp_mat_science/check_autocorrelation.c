@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *
+ * File check_autocorrelation.c
+ *
+ * Checks autocorrelation_time() on AR(1) series of N_SAMPLES samples,
+ *
+ *  x_i = a*x_{i-1} + sqrt(1-a^2)*g_i,
+ *
+ * g_i being independent Gaussian numbers, whose autocorrelation function is
+ * a^t and whose integrated autocorrelation time is (1+a)/(2*(1-a)). The
+ * program exits with status 1 if any estimate is more than TOLERANCE times
+ * the error tau*sqrt(2*(2*window+1)/n) of Sokal away from the exact value,
+ * or if the window is not reached before n/2. The seed is read from the
+ * command line as in read_parameters(), e.g.
+ *
+ *  ./check_autocorrelation SEED=3
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "autocorrelation.h"
+#include "random.h"
+
+#define N_SAMPLES 1000000
+#define N_SERIES 5
+#define TOLERANCE 5.0
+
+int main(int argc, char *argv[])
+{
+    int i, k, window, fail, bad;
+    double a, c, exact, tau, err, *x, *g;
+    double coefficient[N_SERIES] = {0.0, 0.5, 0.8, 0.9, 0.98};
+    parameters_t par;
+
+    read_parameters(argc, argv, &par);
+    rlxd_init(1, par.seed);
+
+    x = (double *)malloc(2 * N_SAMPLES * sizeof(double));
+    error(x == NULL, 1, "main [check_autocorrelation.c]", "Unable to allocate the series");
+    g = x + N_SAMPLES;
+
+    printf("Seed %d, %d samples\n", par.seed, N_SAMPLES);
+    printf("    a     exact tau    tau            window   z\n");
+
+    fail = 0;
+
+    for (k = 0; k < N_SERIES; k++)
+    {
+        a = coefficient[k];
+        c = sqrt(1 - a * a);
+        gauss_dble(g, N_SAMPLES);
+
+        /*stationary from the first sample*/
+        x[0] = g[0];
+        for (i = 1; i < N_SAMPLES; i++)
+            x[i] = a * x[i - 1] + c * g[i];
+
+        exact = (1 + a) / (2 * (1 - a));
+        tau = autocorrelation_time(x, N_SAMPLES, &window);
+        err = tau * sqrt(2.0 * (2 * window + 1) / N_SAMPLES);
+
+        bad = (window >= N_SAMPLES / 2) || (fabs(tau - exact) > TOLERANCE * err);
+        fail |= bad;
+
+        printf("%6.2f %9.4f   %8.4f +- %.4f %6d %6.2f %s\n", a, exact, tau, err, window,
+               (tau - exact) / err, bad ? "FAILED" : "ok");
+    }
+
+    free(x);
+
+    error(fail, 1, "main [check_autocorrelation.c]",
+          "The autocorrelation times differ from the exact ones");
+
+    return 0;
+}
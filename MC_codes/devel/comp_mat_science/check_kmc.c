@@ -0,0 +1,248 @@
+/*******************************************************************************
+ *
+ * File check_kmc.c
+ *
+ * Compares the averages of energy and number of neighbours obtained with
+ * Metropolis moves (sweep) and with the rejection-free dynamics (kmc_step)
+ * over the same number of Metropolis moves, together with the CPU time.
+ * The statistical errors are estimated from N_BLOCKS blocks of N_MOVES /
+ * N_BLOCKS moves each.
+ *
+ * If the lattice has at most MAX_CONFIGURATIONS configurations and T>0 the
+ * exact averages are obtained by enumerating all of them, and the program
+ * exits with status 1 if any of the two dynamics is more than TOLERANCE
+ * standard errors away. Without parameters on the command line the check is
+ * made on a 4x4 lattice with 2 atoms at T=1500 K. Other cases used so far
+ * are
+ *
+ *  ./check_kmc DIM=2 LX=6 LY=6 N=3 T=1000
+ *  ./check_kmc LX=25 LY=25 LZ=10 N=27 T=600
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "kmc.h"
+#include "random.h"
+#include <time.h>
+
+#define N_MOVES 1000000
+#define N_BLOCKS 20
+#define MAX_CONFIGURATIONS 1e7
+#define TOLERANCE 5.0
+
+/*
+ * Adds to sum the Boltzmann weight, and the weighted energy and number of
+ * neighbours, of all the configurations with the atoms k...n_atoms-1 on
+ * sites from first on. Energies are measured from E0.
+ */
+static void enumerate(lattice_t *lat, double E0, int k, int first, double sum[3])
+{
+    int s;
+    double E, w;
+
+    if (k == lat->n_atoms)
+    {
+        E = eval_E(lat);
+        w = exp(-(E - E0) / (KB * lat->temperature));
+        sum[0] += w;
+        sum[1] += w * E;
+        sum[2] += w * mean_number_of_nbrs(lat);
+        return;
+    }
+
+    for (s = first; s <= lat->n_sites - (lat->n_atoms - k); s++)
+    {
+        lat->occupation[s] = 1;
+        lat->atom_site[k] = s;
+        enumerate(lat, E0, k + 1, s + 1, sum);
+        lat->occupation[s] = 0;
+    }
+}
+
+/*
+ * Mean of the block averages block[b][obs] and its standard error
+ */
+static void mean_error(double block[N_BLOCKS][2], int obs, double *mean, double *err)
+{
+    int b;
+    double m, var;
+
+    m = 0;
+    for (b = 0; b < N_BLOCKS; b++)
+        m += block[b][obs];
+    m /= N_BLOCKS;
+
+    var = 0;
+    for (b = 0; b < N_BLOCKS; b++)
+        var += (block[b][obs] - m) * (block[b][obs] - m);
+
+    *mean = m;
+    *err = sqrt(var / ((double)N_BLOCKS * (N_BLOCKS - 1)));
+}
+
+/*
+ * Prints the averages of a run and returns 1 if they differ from the exact
+ * ones (if given) by more than TOLERANCE errors
+ */
+static int report(char name[], double block[N_BLOCKS][2], double exact[2], char extra[])
+{
+    int obs, fail;
+    double mean[2], err[2];
+
+    for (obs = 0; obs < 2; obs++)
+        mean_error(block, obs, mean + obs, err + obs);
+
+    printf("%-11s E = %.6f +- %.6f nbrs = %.6f +- %.6f %s", name, mean[0], err[0], mean[1],
+           err[1], extra);
+
+    fail = 0;
+
+    if (exact != NULL)
+    {
+        for (obs = 0; obs < 2; obs++)
+            if (fabs(mean[obs] - exact[obs]) > TOLERANCE * err[obs] + 1e-12)
+                fail = 1;
+        printf(" %s", fail ? "FAILED" : "ok");
+    }
+
+    printf("\n");
+
+    return fail;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, b, events, fail;
+    double t, dt, d, t_block, E_now, nbrs_now, sum[3], E0;
+    double block[N_BLOCKS][2], exact[2], *exact_p;
+    char extra[100];
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat;
+    kmc_t *kmc;
+
+    read_parameters(argc, argv, &par);
+
+    if (argc == 1)
+    {
+        par.dim = 2;
+        par.lx = 4;
+        par.ly = 4;
+        par.n_atoms = 2;
+        par.temperature = 1500;
+        par.n_term = 1000;
+    }
+
+    lat = new_lattice(&par);
+
+    /*Exact averages*/
+    exact_p = NULL;
+    sum[0] = 1;
+
+    for (i = 0; i < lat->n_atoms; i++)
+        sum[0] *= (double)(lat->n_sites - i) / (i + 1);
+
+    if (lat->temperature > 0 && sum[0] <= MAX_CONFIGURATIONS)
+    {
+        /*E0: lowest energy bound, keeps the weights finite*/
+        E0 = lat->n_atoms * (0.5 * lat->n_nbrs * lat->j1 + lat->j0);
+        sum[0] = sum[1] = sum[2] = 0;
+        enumerate(lat, E0, 0, 0, sum);
+        exact[0] = sum[1] / sum[0];
+        exact[1] = sum[2] / sum[0];
+        exact_p = exact;
+        printf("Exact:      E = %.6f nbrs = %.6f\n", exact[0], exact[1]);
+    }
+
+    /*Metropolis*/
+    init_configuration(lat);
+
+    for (i = 0; i < par.n_term; i++)
+        sweep(lat);
+
+    for (b = 0; b < N_BLOCKS; b++)
+        block[b][0] = block[b][1] = 0;
+
+    start = clock();
+
+    for (i = 0; i < N_MOVES; i++)
+    {
+        b = i / (N_MOVES / N_BLOCKS);
+        block[b][0] += eval_E(lat);
+        block[b][1] += mean_number_of_nbrs(lat);
+        sweep(lat);
+    }
+
+    for (b = 0; b < N_BLOCKS; b++)
+    {
+        block[b][0] /= N_MOVES / N_BLOCKS;
+        block[b][1] /= N_MOVES / N_BLOCKS;
+    }
+
+    sprintf(extra, "(%d moves, %.3f s)", N_MOVES, (double)(clock() - start) / CLOCKS_PER_SEC);
+    fail = report("Metropolis:", block, exact_p, extra);
+
+    /*Rejection-free, the residence times are split among the blocks*/
+    init_configuration(lat);
+    kmc = kmc_init(lat);
+
+    while (kmc_time(kmc) < par.n_term)
+        if (kmc_step(kmc) < 0)
+            break;
+
+    for (b = 0; b < N_BLOCKS; b++)
+        block[b][0] = block[b][1] = 0;
+
+    t_block = (double)N_MOVES / N_BLOCKS;
+    t = 0;
+    events = 0;
+    start = clock();
+
+    while (t < N_MOVES)
+    {
+        E_now = eval_E(lat);
+        nbrs_now = mean_number_of_nbrs(lat);
+        dt = kmc_step(kmc);
+        events++;
+
+        if (dt < 0) /*frozen*/
+            dt = N_MOVES - t;
+
+        while (dt > 0 && t < N_MOVES)
+        {
+            b = (int)(t / t_block);
+            if (b >= N_BLOCKS) /*round-off*/
+                b = N_BLOCKS - 1;
+            d = (b + 1) * t_block - t;
+            if (dt < d)
+                d = dt;
+            block[b][0] += E_now * d;
+            block[b][1] += nbrs_now * d;
+            t += d;
+            dt -= d;
+        }
+    }
+
+    for (b = 0; b < N_BLOCKS; b++)
+    {
+        block[b][0] /= t_block;
+        block[b][1] /= t_block;
+    }
+
+    sprintf(extra, "(%d events, %.3f s)", events, (double)(clock() - start) / CLOCKS_PER_SEC);
+    fail |= report("KMC:", block, exact_p, extra);
+
+    kmc_free(kmc);
+    free_lattice(lat);
+
+    error(fail, 1, "main [check_kmc.c]", "The averages differ from the exact ones");
+
+    return 0;
+}
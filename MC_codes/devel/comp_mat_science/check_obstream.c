@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *
+ * File check_obstream.c
+ *
+ * Writes the energy, the mean number of neighbours and the atoms in the
+ * first layer of N_ROWS sweeps in every format of obstream.c, prints the
+ * time spent writing and the size of the files, and checks that the binary
+ * files are read back exactly (the text file up to its 16 digits), also
+ * with a stride. The parameters are read from the command line, e.g.
+ *
+ *  ./check_obstream T=300
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "montecarlo.h"
+#include "obstream.h"
+#include "random.h"
+#include <assert.h>
+#include <time.h>
+
+#define N_ROWS 1000000
+#define N_FORMATS 5
+
+static int check_file(char file_name[], int format, int stride, double *rows)
+{
+    int i, c, errors;
+    double x[3];
+    FILE *fd;
+    obs_stream_t *s;
+
+    errors = 0;
+
+    if (format == OBS_TEXT)
+    {
+        fd = fopen(file_name, "r");
+        assert(fd != NULL);
+
+        for (i = 0; i < N_ROWS; i += stride)
+        {
+            if (fscanf(fd, "%lf %lf %lf", x, x + 1, x + 2) != 3)
+                return errors + 1;
+
+            for (c = 0; c < 3; c++)
+                if (fabs(x[c] - rows[3 * i + c]) > 1e-14 * fabs(rows[3 * i + c]))
+                    errors++;
+        }
+
+        fclose(fd);
+
+        return errors;
+    }
+
+    s = obs_open_read(file_name);
+
+    if (s->n_columns != 3 || s->stride != stride || s->format != format ||
+        obs_column(s, "first_layer") != 2)
+        errors++;
+
+    for (i = 0; i < N_ROWS; i += stride)
+    {
+        if (obs_read(s, x) != 1)
+            return errors + 1;
+
+        for (c = 0; c < 3; c++)
+            if (x[c] != rows[3 * i + c])
+                errors++;
+    }
+
+    if (obs_read(s, x) != 0)
+        errors++;
+
+    obs_close(s);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, f, stride, errors, types[3] = {OBS_DOUBLE, OBS_DOUBLE, OBS_INT};
+    int formats[N_FORMATS] = {OBS_TEXT, OBS_BINARY, OBS_BINARY | OBS_DELTA, OBS_BINARY | OBS_RLE,
+                              OBS_BINARY | OBS_DELTA | OBS_RLE};
+    char file_name[100], *names[3] = {"energy", "nbrs", "first_layer"};
+    double *rows;
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat;
+    obs_stream_t *s;
+    FILE *fd;
+
+    read_parameters(argc, argv, &par);
+    lat = new_lattice(&par);
+    rows = (double *)malloc(3 * N_ROWS * sizeof(double));
+    assert(rows != NULL);
+
+    init_configuration(lat);
+
+    for (i = 0; i < par.n_term; i++)
+        sweep(lat);
+
+    for (i = 0; i < N_ROWS; i++)
+    {
+        rows[3 * i] = eval_E(lat);
+        rows[3 * i + 1] = mean_number_of_nbrs(lat);
+        rows[3 * i + 2] = count_first_layer(lat);
+        sweep(lat);
+    }
+
+    printf("T = %.1f K, %d rows\n", lat->temperature, N_ROWS);
+    printf("format  stride  write (s)  size (bytes)  errors\n");
+
+    for (stride = 1; stride <= 10; stride *= 10)
+    {
+        for (f = 0; f < N_FORMATS; f++)
+        {
+            sprintf(file_name, "check_obstream.%s", obs_suffix(formats[f]));
+
+            start = clock();
+            s = obs_open(file_name, 3, names, types, stride, formats[f]);
+            for (i = 0; i < N_ROWS; i++)
+                obs_write(s, rows + 3 * i);
+            obs_close(s);
+
+            printf("%6d  %6d  %9.3f", formats[f], stride,
+                   (double)(clock() - start) / CLOCKS_PER_SEC);
+
+            fd = fopen(file_name, "rb");
+            assert(fd != NULL);
+            fseek(fd, 0, SEEK_END);
+            printf("  %12ld", ftell(fd));
+            fclose(fd);
+
+            errors = check_file(file_name, formats[f], stride, rows);
+            printf("  %6d\n", errors);
+
+            remove(file_name);
+        }
+    }
+
+    free(rows);
+    free_lattice(lat);
+
+    return 0;
+}
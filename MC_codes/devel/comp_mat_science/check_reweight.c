@@ -0,0 +1,222 @@
+/*******************************************************************************
+ *
+ * File check_reweight.c
+ *
+ * Histogram reweighting against direct simulation. Runs of N_MOVES moves
+ * are made at T and 1.5*T (T from the command line, 400 K if zero) and at
+ * the coupling J0, their histograms are combined with WHAM and the averages
+ * at 1.25*T and at (1.25*T, J0+0.05) are compared with those of direct runs
+ * at these parameters. The errors of the direct averages are obtained from
+ * N_BLOCKS blocks of each run, those of the reweighted ones by jackknife,
+ * dropping the same block from the two runs combined by WHAM. Each
+ * difference is printed in units of the combined error, z, and the program
+ * exits with status 1 if any |z| exceeds Z_MAX. Also checks that the bonds
+ * and contacts counted by the histogram give the energy of eval_E() and the
+ * atoms of count_first_layer(). E.g.
+ *
+ *  ./check_reweight T=300 N_TERM=100000
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+#include "random.h"
+#include <time.h>
+
+#define N_MOVES 2000000
+#define N_RUNS 4
+#define N_WHAM 2
+#define N_BLOCKS 10
+#define N_OBSERVABLES 3
+#define Z_MAX 5.0
+
+/*
+ * Mean of x[0...n-1] and its standard error, scale being 1/(n(n-1)) for
+ * independent blocks and (n-1)/n for jackknife estimates
+ */
+static void mean_error(double x[], int n, double scale, double *mean, double *err)
+{
+    int b;
+    double m, var;
+
+    m = 0;
+    for (b = 0; b < n; b++)
+        m += x[b];
+    m /= n;
+
+    var = 0;
+    for (b = 0; b < n; b++)
+        var += (x[b] - m) * (x[b] - m);
+
+    *mean = m;
+    *err = sqrt(scale * var);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, k, b, bonds, c, o, x, it, n_bins, errors, fail;
+    double t, t_run[N_RUNS], j0_run[N_RUNS], average[4], *log_g, z, sigma, mean;
+    double block[N_RUNS][N_OBSERVABLES][N_BLOCKS], jack[N_RUNS][N_OBSERVABLES][N_BLOCKS];
+    double direct[N_RUNS][N_OBSERVABLES], direct_err[N_RUNS][N_OBSERVABLES];
+    double rw[N_RUNS][N_OBSERVABLES], rw_err[N_RUNS][N_OBSERVABLES];
+    char *name[N_OBSERVABLES] = {"E", "nbrs", "first layer"};
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat;
+    histogram_t *h[N_RUNS], *hb[N_WHAM][N_BLOCKS], *hj[N_WHAM];
+
+    read_parameters(argc, argv, &par);
+
+    t = (par.temperature > 0) ? par.temperature : 400;
+    t_run[0] = t;
+    t_run[1] = 1.5 * t;
+    t_run[2] = 1.25 * t;
+    t_run[3] = 1.25 * t;
+    j0_run[0] = par.j0;
+    j0_run[1] = par.j0;
+    j0_run[2] = par.j0;
+    j0_run[3] = par.j0 + 0.05;
+
+    errors = 0;
+
+    for (k = 0; k < N_RUNS; k++)
+    {
+        par.temperature = t_run[k];
+        par.j0 = j0_run[k];
+        lat = new_lattice(&par);
+        h[k] = new_histogram(lat);
+
+        /*histograms of the blocks and jackknife histograms of the WHAM runs*/
+        if (k < N_WHAM)
+        {
+            for (b = 0; b < N_BLOCKS; b++)
+                hb[k][b] = new_histogram(lat);
+            hj[k] = new_histogram(lat);
+        }
+
+        init_configuration(lat);
+
+        for (i = 0; i < par.n_term; i++)
+            sweep(lat);
+
+        for (o = 0; o < N_OBSERVABLES; o++)
+            for (b = 0; b < N_BLOCKS; b++)
+                block[k][o][b] = 0;
+
+        for (i = 0; i < N_MOVES; i++)
+        {
+            b = i / (N_MOVES / N_BLOCKS);
+            histogram_sample(h[k], lat);
+            if (k < N_WHAM)
+                histogram_sample(hb[k][b], lat);
+            block[k][0][b] += eval_E(lat);
+            block[k][1][b] += mean_number_of_nbrs(lat);
+            block[k][2][b] += count_first_layer(lat);
+
+            if (i % 1000 == 0)
+            {
+                count_bonds_contacts(lat, &bonds, &c);
+                if (fabs(lat->j1 * bonds + lat->j0 * c - eval_E(lat)) > 1e-10 ||
+                    c != count_first_layer(lat))
+                    errors++;
+            }
+
+            sweep(lat);
+        }
+
+        for (o = 0; o < N_OBSERVABLES; o++)
+        {
+            for (b = 0; b < N_BLOCKS; b++)
+                block[k][o][b] /= N_MOVES / N_BLOCKS;
+            mean_error(block[k][o], N_BLOCKS, 1.0 / (N_BLOCKS * (N_BLOCKS - 1.0)),
+                       &direct[k][o], &direct_err[k][o]);
+        }
+
+        free_lattice(lat);
+    }
+
+    printf("N = %d, %d moves per run, %d inconsistent samples\n", par.n_atoms, N_MOVES, errors);
+
+    start = clock();
+    log_g = wham(h, N_WHAM, 1e-10, &it);
+    printf("WHAM of the runs at T = %.1f and %.1f: %d iterations, %.3f s\n", t_run[0], t_run[1],
+           it, (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    /*Reweighted averages, jackknife over the blocks*/
+    for (k = 0; k < N_RUNS; k++)
+    {
+        reweight(h[0], log_g, t_run[k], j0_run[k], h[0]->j1, average);
+        for (o = 0; o < N_OBSERVABLES; o++)
+            rw[k][o] = average[o];
+    }
+
+    n_bins = (h[0]->max_bonds + 1) * (h[0]->max_contacts + 1);
+    free(log_g);
+
+    for (b = 0; b < N_BLOCKS; b++)
+    {
+        for (i = 0; i < N_WHAM; i++)
+        {
+            for (x = 0; x < n_bins; x++)
+                hj[i]->count[x] = h[i]->count[x] - hb[i][b]->count[x];
+            hj[i]->n_samples = h[i]->n_samples - hb[i][b]->n_samples;
+        }
+
+        log_g = wham(hj, N_WHAM, 1e-10, &it);
+
+        for (k = 0; k < N_RUNS; k++)
+        {
+            reweight(hj[0], log_g, t_run[k], j0_run[k], hj[0]->j1, average);
+            for (o = 0; o < N_OBSERVABLES; o++)
+                jack[k][o][b] = average[o];
+        }
+
+        free(log_g);
+    }
+
+    fail = (errors != 0);
+
+    printf("T        J0      observable   direct                  reweighted              z\n");
+
+    for (k = 0; k < N_RUNS; k++)
+    {
+        for (o = 0; o < N_OBSERVABLES; o++)
+        {
+            mean_error(jack[k][o], N_BLOCKS, (N_BLOCKS - 1.0) / N_BLOCKS, &mean,
+                       &rw_err[k][o]);
+
+            sigma = sqrt(direct_err[k][o] * direct_err[k][o] + rw_err[k][o] * rw_err[k][o]);
+            z = (sigma > 0) ? (direct[k][o] - rw[k][o]) / sigma : 0;
+
+            if (fabs(direct[k][o] - rw[k][o]) > Z_MAX * sigma + 1e-10)
+                fail = 1;
+
+            printf("%7.1f  %6.3f  %-11s  %11.6f +- %8.6f  %11.6f +- %8.6f  %6.2f\n", t_run[k],
+                   j0_run[k], name[o], direct[k][o], direct_err[k][o], rw[k][o], rw_err[k][o], z);
+        }
+    }
+
+    printf("%s (|z| <= %.1f)\n", fail ? "FAILED" : "ok", Z_MAX);
+
+    for (k = 0; k < N_RUNS; k++)
+        free_histogram(h[k]);
+
+    for (k = 0; k < N_WHAM; k++)
+    {
+        for (b = 0; b < N_BLOCKS; b++)
+            free_histogram(hb[k][b]);
+        free_histogram(hj[k]);
+    }
+
+    error(fail, 1, "main [check_reweight.c]",
+          "Inconsistent samples or reweighted averages different from the direct ones");
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ *
+ * File check_wang_landau.c
+ *
+ * Wang-Landau sampling against exact enumeration. The density of states
+ * g(b,c) of a small lattice (3x3x3 with 4 atoms unless given on the command
+ * line) is obtained by enumerating all configurations and by a Wang-Landau
+ * walk, and the largest error of log g and the averages at a few
+ * temperatures are printed. Also checks that a walk saved in a checkpoint
+ * and resumed gives exactly the same density of states as the uninterrupted
+ * one. E.g.
+ *
+ *  ./check_wang_landau LX=4 LY=4 LZ=2 N=5 LOG_F_FINAL=1e-7
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+#include "wanglandau.h"
+#include <time.h>
+
+#define CHECKPOINT "check_wang_landau.bin"
+#define N_CHECK 200000
+
+/*
+ * Adds to h all the configurations with the atoms k...n_atoms-1 on sites
+ * from first on
+ */
+static void enumerate(lattice_t *lat, histogram_t *h, int k, int first)
+{
+    int s;
+
+    if (k == lat->n_atoms)
+    {
+        histogram_sample(h, lat);
+        return;
+    }
+
+    for (s = first; s <= lat->n_sites - (lat->n_atoms - k); s++)
+    {
+        lat->occupation[s] = 1;
+        lat->atom_site[k] = s;
+        enumerate(lat, h, k + 1, s + 1);
+        lat->occupation[s] = 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, x, n_bins, same;
+    double max_error, t, exact[4], average[4], *log_g, *log_g_exact;
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat, *lat2;
+    histogram_t *h;
+    wang_landau_t *w, *w2;
+
+    read_parameters(argc, argv, &par);
+
+    if (argc == 1 || (par.lx == LX && par.ly == LY && par.lz == LZ && par.n_atoms == N))
+    {
+        par.dim = 3;
+        par.lx = 3;
+        par.ly = 3;
+        par.lz = 3;
+        par.n_atoms = 4;
+    }
+
+    /*exact density of states*/
+    lat = new_lattice(&par);
+    h = new_histogram(lat);
+    start = clock();
+    enumerate(lat, h, 0, 0);
+    n_bins = (h->max_bonds + 1) * (h->max_contacts + 1);
+
+    log_g_exact = (double *)malloc(n_bins * sizeof(double));
+    error(log_g_exact == NULL, 1, "main [check_wang_landau.c]", "Unable to allocate the arrays");
+
+    for (x = 0; x < n_bins; x++)
+        log_g_exact[x] = (h->count[x] > 0) ? log(h->count[x]) : -HUGE_VAL;
+
+    printf("%dD %dx%dx%d, N = %d: %.0f configurations enumerated in %.2f s\n", lat->dim, lat->lx,
+           lat->ly, lat->lz, lat->n_atoms, h->n_samples, (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    /*Wang-Landau*/
+    init_configuration(lat);
+    w = new_wang_landau(lat, par.log_f_final, par.flatness, par.schedule);
+    start = clock();
+
+    while (!wl_converged(w))
+        wl_run(w, 1e6);
+
+    log_g = wl_dos(w);
+    max_error = 0;
+    same = (w->n_bins > 0);
+
+    for (x = 0; x < n_bins; x++)
+    {
+        if ((log_g[x] == -HUGE_VAL) != (log_g_exact[x] == -HUGE_VAL))
+            same = 0;
+        else if (log_g[x] != -HUGE_VAL && fabs(log_g[x] - log_g_exact[x]) > max_error)
+            max_error = fabs(log_g[x] - log_g_exact[x]);
+    }
+
+    printf("Wang-Landau (schedule %d, flatness %.2f): %.0f moves, %d stages, %.2f s\n",
+           w->schedule, w->flatness, w->n_moves, w->stage,
+           (double)(clock() - start) / CLOCKS_PER_SEC);
+    printf("%d bins, %s the exact ones, max |log g - log g_exact| = %.4f\n", w->n_bins,
+           same ? "the same as" : "DIFFERENT FROM", max_error);
+    printf("T        E (exact, WL)             nbrs (exact, WL)          C (exact, WL)\n");
+
+    for (i = 1; i <= 4; i++)
+    {
+        t = 200.0 * i;
+        reweight(h, log_g_exact, t, par.j0, par.j1, exact);
+        reweight(h, log_g, t, par.j0, par.j1, average);
+        printf("%6.1f  %11.6f %11.6f  %11.6f %11.6f  %11.6f %11.6f\n", t, exact[0], average[0],
+               exact[1], average[1], exact[3], average[3]);
+    }
+
+    free(log_g);
+    free_wang_landau(w);
+
+    /*checkpoint and restart*/
+    init_configuration(lat);
+    w = new_wang_landau(lat, par.log_f_final, par.flatness, par.schedule);
+    wl_run(w, N_CHECK);
+    save_wang_landau(w, CHECKPOINT);
+    wl_run(w, N_CHECK);
+
+    lat2 = new_lattice(&par);
+    init_configuration(lat2);
+    w2 = new_wang_landau(lat2, par.log_f_final, 0.5, WL_HALVING);
+    error(load_wang_landau(w2, CHECKPOINT) != 1, 1, "main [check_wang_landau.c]",
+          "Checkpoint not found");
+    wl_run(w2, N_CHECK);
+    remove(CHECKPOINT);
+
+    same = (w->n_moves == w2->n_moves && w->log_f == w2->log_f && w->stage == w2->stage &&
+            memcmp(w->log_g, w2->log_g, n_bins * sizeof(double)) == 0 &&
+            memcmp(lat->atom_site, lat2->atom_site, lat->n_atoms * sizeof(int)) == 0);
+    printf("Restart from checkpoint after %d moves: %s\n", N_CHECK,
+           same ? "identical walk" : "DIFFERENT WALK");
+
+    free_wang_landau(w);
+    free_wang_landau(w2);
+    free_histogram(h);
+    free(log_g_exact);
+    free_lattice(lat);
+    free_lattice(lat2);
+
+    return 0;
+}
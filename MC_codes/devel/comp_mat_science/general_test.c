@@ -20,10 +20,12 @@
 
 int main(int argc, char *argv[])
 {
-    seed = time(NULL);
+    parameters_t par;
+
+    read_parameters(argc, argv, &par);
 
     printf("%f\n", powerd(2, 31) - 1);
-    printf("%d\n", seed);
+    printf("%d\n", par.seed);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+
+/*******************************************************************************
+*
+* File check5.c
+*
+* Buffered generator (ranbuf): the doubles must be the numbers of ranlxd
+* with the same seed, across several refills of the buffer, and the random
+* integers of ranbuf_int and ranbuf_index must be floor(k*n/2^48), where k
+* is the 48-bit integer behind the double. The latter is checked with an
+* independent splitting of the product
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "random.h"
+
+#define N (3*RANBUF_SIZE+17)
+#define TWO48 281474976710656LL
+
+
+static int check_index(long long k,int n,int i)
+{
+   long long nh,nl,lhs,low;
+
+   if ((i<0)||(i>=n))
+      return 1;
+
+   /* i*2^48 <= k*n < (i+1)*2^48 with n=nh*2^16+nl */
+   nh=(long long)(n>>16);
+   nl=(long long)(n&0xffff);
+   lhs=((long long)i<<32)-k*nh;
+
+   low=(long long)(((unsigned long long)k*(unsigned long long)nl)>>16);
+
+   if (lhs>low)
+      return 1;
+
+   if ((lhs+(1LL<<32))<=low)
+      return 1;
+
+   return 0;
+}
+
+
+int main(void)
+{
+   int k,i,n,errors;
+   static int sizes[]={1,2,3,6,10,25,27,512,32768,65537,1000003,2147483647};
+   long long raw;
+   double r[N];
+   ranbuf_t *b;
+   rlxd_state_t st;
+
+   errors=0;
+   b=malloc(sizeof(ranbuf_t));
+
+   rlxd_init(1,271828);
+   ranlxd(r,N);
+   ranbuf_init(b,1,271828);
+
+   for (k=0;k<N;k++)
+   {
+      if (ranbuf_double(b)!=r[k])
+         errors++;
+   }
+
+   rlxd_init_r(&st,2,314159);
+   ranbuf_init(b,2,314159);
+
+   for (k=0;k<N;k++)
+   {
+      n=sizes[k%12];
+      ranlxd_r(&st,r,1);
+      raw=(long long)(r[0]*(double)(TWO48));
+
+      if (n<=32768)
+         i=ranbuf_int(b,n);
+      else
+         i=ranbuf_index(b,n);
+
+      if (check_index(raw,n,i)!=0)
+         errors++;
+   }
+
+   free(b);
+
+   printf("\n");
+
+   if (errors==0)
+      printf("Buffered generator agrees with ranlxd\n");
+   else
+      printf("%d numbers differ => buffered generator does not work\n",errors);
+
+   printf("\n");
+   exit(0);
+}
+
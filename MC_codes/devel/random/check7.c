@@ -0,0 +1,110 @@
+/*******************************************************************************
+*
+* File check7.c
+*
+* Counter-based generator (philox): the bijection must reproduce the known
+* answers of the reference implementation (Random123), a stream must give
+* the same numbers when they are drawn in pieces or all at once, the doubles
+* must be the 48-bit integers times 2^-48, and the streams of different
+* atoms, steps, replicas and seeds must differ
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "random.h"
+
+#define N 1000
+#define TWO48 281474976710656.0
+
+static unsigned int kat[3][10]=
+{
+   {0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,
+    0x6627e8d5,0xe169c58d,0xbc57ac4c,0x9b00dbd8},
+   {0xffffffff,0xffffffff,0xffffffff,0xffffffff,0xffffffff,0xffffffff,
+    0x408f276d,0x41c83b0e,0xa20bc7c6,0x6d5451fd},
+   {0x243f6a88,0x85a308d3,0x13198a2e,0x03707344,0xa4093822,0x299f31d0,
+    0xd16cfe09,0x94fdcceb,0x5001e420,0x24126ea1}
+};
+
+
+int main(void)
+{
+   int k,j,errors;
+   unsigned int x[4];
+   long long raw[N],raw2[N];
+   double r[N],mean;
+   phx_state_t st;
+
+   errors=0;
+
+   for (k=0;k<3;k++)
+   {
+      philox4x32(kat[k],kat[k]+4,x);
+
+      for (j=0;j<4;j++)
+      {
+         if (x[j]!=kat[k][6+j])
+            errors++;
+      }
+   }
+
+   if (errors!=0)
+      printf("Known answers of philox4x32 not reproduced\n");
+
+   phx_init_r(&st,1234,5,-7,42);
+   ranphx_raw_r(&st,raw,N);
+
+   phx_init_r(&st,1234,5,-7,42);
+   for (k=0;k<N;k+=j)
+   {
+      j=1+k%5;
+      if ((k+j)>N)
+         j=N-k;
+      ranphx_raw_r(&st,raw2+k,j);
+   }
+
+   phx_init_r(&st,1234,5,-7,42);
+   ranphx_r(&st,r,N);
+   mean=0.0;
+
+   for (k=0;k<N;k++)
+   {
+      if ((raw2[k]!=raw[k])||(raw[k]<0)||(raw[k]>=(1LL<<48)))
+         errors++;
+      if (r[k]!=(double)(raw[k])/TWO48)
+         errors++;
+      mean+=r[k];
+   }
+
+   mean/=(double)(N);
+
+   if (fabs(mean-0.5)>5.0/sqrt(12.0*(double)(N)))
+      errors++;
+
+   for (k=0;k<4;k++)
+   {
+      phx_init_r(&st,1234+(k==0),5+(k==1),-7+(k==2),42+(k==3));
+      ranphx_raw_r(&st,raw2,4);
+
+      for (j=0;j<4;j++)
+      {
+         if (raw2[j]==raw[j])
+            errors++;
+      }
+   }
+
+   printf("\n");
+
+   if (errors==0)
+      printf("Counter-based generator works correctly\n");
+   else
+      printf("%d errors => counter-based generator does not work\n",errors);
+
+   printf("\n");
+   exit(0);
+}
+
@@ -4,7 +4,8 @@
 * File time1.c
 *
 * Measurement of the processor time required to produce single-precision
-* random numbers using ranlxs
+* random numbers using ranlxs, with the generator of the file and with an
+* explicit state, for every kernel of the update available on this machine
 *
 * Author: Martin Luescher <luscher@mail.cern.ch>
 *
@@ -19,15 +20,12 @@
 #define NLOOPS 100000
 
 
-int main()
+static void time_ranlxs(void)
 {
    int k,level;
    float t1,t2,dt;
    float r[N];
-
-   printf("\n");
-   printf("Timing of ranlxs (average time per random number in microsec)\n");
-   printf("\n");
+   rlxs_state_t st;
 
    for (level=0;level<=2;level++)
    {
@@ -44,8 +42,53 @@ int main()
       printf("%4.3f (level %1d)  ",dt,level);
    }
 
-   printf("\n\n");
-   exit(0);
+   printf("\n");
+
+   for (level=0;level<=2;level++)
+   {
+      rlxs_init_r(&st,level,1);
+
+      t1=(float)clock();
+      for (k=1;k<=NLOOPS;k++) 
+         ranlxs_r(&st,r,N);
+      t2=(float)clock();
+      
+      dt=(t2-t1)/(float)(CLOCKS_PER_SEC);
+      dt*=1.0e6f/(float)(N*NLOOPS);
+
+      printf("%4.3f (level %1d)  ",dt,level);
+   }
+
+   printf(" with an explicit state (ranlxs_r)\n\n");
 }
 
 
+int main()
+{
+   int b,n;
+
+   printf("\n");
+   printf("Timing of ranlxs (average time per random number in microsec)\n");
+   printf("\n");
+
+   n=0;
+
+   for (b=0;b<RLX_NBACKENDS;b++)
+   {
+      if (rlx_backend_available(b))
+      {
+         rlx_set_backend(b);
+         printf("Kernel %s:\n",rlx_backend_name(b));
+         time_ranlxs();
+         n+=1;
+      }
+   }
+
+   if (n==0)
+   {
+      printf("Kernel %s:\n",rlx_backend_name(rlx_backend()));
+      time_ranlxs();
+   }
+
+   exit(0);
+}
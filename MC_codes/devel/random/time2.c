@@ -4,7 +4,8 @@
 * File time2.c
 *
 * Measurement of the processor time required to produce double-precision
-* random numbers using ranlxd
+* random numbers using ranlxd, with the generator of the file and with an
+* explicit state, for every kernel of the update available on this machine
 *
 * Author: Martin Luescher <luscher@mail.cern.ch>
 *
@@ -18,15 +19,12 @@
 #define N 100
 #define NLOOPS 100000
 
-  int main()
+  static void time_ranlxd(void)
   {
     int k,level;
     float t1,t2,dt;
     double r[N];
-
-    printf("\n");
-    printf("Timing of ranlxd (average time per random number in microsec)\n");
-    printf("\n");
+    rlxd_state_t st;
 
     for (level=1;level<=2;level++)
     {
@@ -43,7 +41,53 @@
       printf("%4.3f (level %1d)  ",dt,level);
     }
     printf("\n");
+
+    for (level=1;level<=2;level++)
+    {
+      rlxd_init_r(&st,level,1);
+
+      t1=(float)clock();
+      for (k=1;k<=NLOOPS;k++) 
+        ranlxd_r(&st,r,N);
+      t2=(float)clock();
+      
+      dt=(t2-t1)/(float)(CLOCKS_PER_SEC);
+      dt*=1.0e6f/(float)(N*NLOOPS);      
+      
+      printf("%4.3f (level %1d)  ",dt,level);
+    }
+    printf(" with an explicit state (ranlxd_r)\n");
     printf("\n");
+  }
+
+
+  int main()
+  {
+    int b,n;
+
+    printf("\n");
+    printf("Timing of ranlxd (average time per random number in microsec)\n");
+    printf("\n");
+
+    n=0;
+
+    for (b=0;b<RLX_NBACKENDS;b++)
+    {
+      if (rlx_backend_available(b))
+      {
+        rlx_set_backend(b);
+        printf("Kernel %s:\n",rlx_backend_name(b));
+        time_ranlxd();
+        n+=1;
+      }
+    }
+
+    if (n==0)
+    {
+      printf("Kernel %s:\n",rlx_backend_name(rlx_backend()));
+      time_ranlxd();
+    }
+
     exit(0);
   }
 
@@ -0,0 +1,72 @@
+
+/*******************************************************************************
+*
+* File time4.c
+*
+* Measurement of the processor time required to produce double-precision
+* Gaussian random numbers with gauss_dble, gauss_dble_block and
+* gauss_dble_zig, in blocks of various sizes
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "random.h"
+
+#define NTOT 10000000
+
+
+static void time_gauss(char *name,void (*gen)(double rd[],int n),double rd[])
+{
+   int k,n,nloops;
+   float t1,t2,dt;
+
+   printf("%-18s",name);
+
+   for (n=10;n<=100000;n*=100)
+   {
+      rlxd_init(1,1);
+      nloops=NTOT/n;
+
+      t1=(float)clock();
+      for (k=0;k<nloops;k++)
+         gen(rd,n);
+      t2=(float)clock();
+
+      dt=(t2-t1)/(float)(CLOCKS_PER_SEC);
+      dt*=1.0e6f/(float)(n*nloops);
+
+      printf("%4.3f (n=%6d)  ",dt,n);
+   }
+
+   printf("\n");
+}
+
+
+int main(void)
+{
+   double *rd;
+
+   rd=malloc(100000*sizeof(double));
+
+   printf("\n");
+   printf("Timing of the Gaussian generators ");
+   printf("(average time per random number in microsec)\n");
+   printf("\n");
+
+   time_gauss("gauss_dble",gauss_dble,rd);
+   time_gauss("gauss_dble_block",gauss_dble_block,rd);
+   time_gauss("gauss_dble_zig",gauss_dble_zig,rd);
+
+   printf("\n");
+   printf("(uniform numbers from ranlxd at level 1, kernel %s)\n",
+          rlx_backend_name(rlx_backend()));
+   printf("\n");
+
+   free(rd);
+   exit(0);
+}
+
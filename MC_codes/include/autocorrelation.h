@@ -0,0 +1,7 @@
+#ifndef AUTOCORRELATION_H
+#define AUTOCORRELATION_H
+
+double autocorrelation(double x[], int n, int t);
+double autocorrelation_time(double x[], int n, int *window);
+
+#endif /*AUTOCORRELATION_H*/
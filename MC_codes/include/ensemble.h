@@ -0,0 +1,9 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "montecarlo.h"
+
+void run_ensemble(parameters_t *par, int sample_interval, char file_name[],
+                  char raw_file_name[], double average[], double sigma[]);
+
+#endif /*ENSEMBLE_H*/
@@ -1,30 +1,35 @@
-
 /*******************************************************************************
  *
  * File global.h
  *
- * Global parameters and arrays
+ * Default values of the parameters, which can be changed at run time (see
+ * read_parameters() in montecarlo.c)
  *
  * KB Boltzmann constant
+ * DIM dimension (2 or 3)
  * LX grid lenght along x
  * LY grid lenght along y
- * LZ grid lenght along z
+ * LZ grid lenght along z (ignored in two dimensions)
  * N number of atoms
  * J0 energy between atoms and substrate
  * J1 energy between first neighbours atom
  * N_SWEEP number of sweeps performed after thermalization
  * T temperature
  * N_TERM number of sweeps to reach thermalization
- * DIM3 or DIM2 according to dimension
- *
- * occupation_matrix: 0 if the cell is empty, 1 otherwise
- * left_nbrs: coordinate of left neighbours
- * right_nbrs: coordinate of right neighbours
- * up_nbrs: coordinate of up neighbours
- * down_nbrs: coordinate of down neighbours
- * top_nbrs: coordinate of top neighbours
- * bottom_nbrs: coordinate of bottom neighbours
- * atom_position: coordinate of positions of all atoms
+ * N_REPLICAS number of replicas (ensemble and tempering runs)
+ * T_MIN, T_MAX lowest and highest temperature of the tempering ladder
+ * SWAP_INTERVAL number of sweeps between two swaps of the tempering runs
+ * SAMPLE_INTERVAL number of sweeps between two samples of the ensemble runs
+ * RAW_OUTPUT 1 to write the observables of every replica of an ensemble
+ * OUTPUT format of the time series: 0 text, 1 binary, plus 2 for delta and
+ *  4 for run-length coding (see obstream.c)
+ * STRIDE one sample every STRIDE sweeps is written in the time series
+ * HOP_FRACTION fraction of the moves that are hops to a neighbouring site,
+ *  the others move an atom to a random empty site
+ * LOG_F_FINAL final modification factor of the Wang-Landau runs
+ * FLATNESS flatness of the Wang-Landau histograms
+ * SCHEDULE schedule of the Wang-Landau modification factor: 0 halving, 1
+ *  1/t (see wanglandau.c)
  *
  * Author: Lorenzo Tasca
  *
@@ -34,6 +39,7 @@
 #define GLOBAL_H
 
 #define KB 0.00008618460742911316 /*eV/K*/
+#define DIM 3
 #define LX 25
 #define LY 25
 #define LZ 10
@@ -43,36 +49,17 @@
 #define N_SWEEP 1000000
 #define T 0 /*K*/
 #define N_TERM 200000
-#define DIM3
-
-#ifdef MAIN_PROGRAM
-#define EXTERN
-#else
-#define EXTERN extern
-#endif /*MAIN_PROGRAM*/
-
-EXTERN int seed;
-
-#ifdef DIM2
-EXTERN short occupation_matrix[LX][LY];
-EXTERN int left_nbrs[LX][LY][2];
-EXTERN int right_nbrs[LX][LY][2];
-EXTERN int up_nbrs[LX][LY][2];
-EXTERN int down_nbrs[LX][LY][2];
-EXTERN int atom_position[N][2];
-#endif /*DIM2*/
-
-#ifdef DIM3
-EXTERN short occupation_matrix[LX][LY][LZ];
-EXTERN int left_nbrs[LX][LY][LZ][3];
-EXTERN int right_nbrs[LX][LY][LZ][3];
-EXTERN int up_nbrs[LX][LY][LZ][3];
-EXTERN int down_nbrs[LX][LY][LZ][3];
-EXTERN int top_nbrs[LX][LY][LZ][3];
-EXTERN int bottom_nbrs[LX][LY][LZ][3];
-EXTERN int atom_position[N][3];
-#endif /*DIM3*/
-
-#undef EXTERN
+#define N_REPLICAS 8
+#define T_MIN 100.0  /*K*/
+#define T_MAX 1500.0 /*K*/
+#define SWAP_INTERVAL 100
+#define SAMPLE_INTERVAL 100
+#define RAW_OUTPUT 0
+#define OUTPUT 0
+#define STRIDE 1
+#define HOP_FRACTION 0
+#define LOG_F_FINAL 1e-6
+#define FLATNESS 0.8
+#define SCHEDULE 1
 
 #endif /*GLOBAL_H*/
@@ -0,0 +1,30 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "montecarlo.h"
+
+/*
+ * Joint histogram of the number of bonds b and of the atoms in contact with
+ * the substrate c (see histogram.c), sampled at the given temperature and
+ * couplings.
+ *
+ * count[b*(max_contacts+1)+c]: number of samples with b bonds and c contacts
+ * n_samples: total number of samples
+ */
+typedef struct
+{
+    int n_atoms, max_bonds, max_contacts;
+    double temperature, j0, j1, n_samples;
+    double *count;
+} histogram_t;
+
+histogram_t *new_histogram(lattice_t *lat);
+void free_histogram(histogram_t *h);
+void count_bonds_contacts(lattice_t *lat, int *bonds, int *contacts);
+void histogram_sample(histogram_t *h, lattice_t *lat);
+void save_histogram(histogram_t *h, char file_name[]);
+histogram_t *load_histogram(char file_name[]);
+double *wham(histogram_t *h[], int n, double tol, int *iterations);
+void reweight(histogram_t *h, double log_g[], double t, double j0, double j1, double average[]);
+
+#endif /*HISTOGRAM_H*/
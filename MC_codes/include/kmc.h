@@ -0,0 +1,40 @@
+#ifndef KMC_H
+#define KMC_H
+
+#include "montecarlo.h"
+
+/*class of a site: 2 * (occupied neighbours) + (contact with the substrate)*/
+#define KMC_MAX_NCLASS 14
+
+/*
+ * Rejection-free dynamics of a lattice (see kmc.c), created by kmc_init()
+ *
+ * lat: lattice, whose configuration and generator are used by kmc_step()
+ * n_class, n_sites: number of classes and of sites of the lattice
+ * occupied_nbrs[s]: occupied neighbours of the site s, occupied_nbrs[n_sites]
+ *  (the missing neighbour along z) is always 0
+ * site_atom[s]: atom on the site s, -1 if the site is empty
+ * group[s]: group of the site s. Groups 0...n_class-1 collect the occupied
+ *  sites, groups n_class...2*n_class-1 the empty ones
+ * members[g*n_sites+i], i=0...population[g]-1: sites of the group g,
+ *  where[s] is the position of the site s in the list of its group
+ * rate[a][b]: rate of a move from the class a to the class b
+ * time_elapsed: time since kmc_init(), in Metropolis moves
+ */
+typedef struct
+{
+    lattice_t *lat;
+    int n_class, n_sites;
+    int *occupied_nbrs, *site_atom;
+    int *group, *where, *members;
+    int population[2 * KMC_MAX_NCLASS];
+    double rate[KMC_MAX_NCLASS][KMC_MAX_NCLASS];
+    double time_elapsed;
+} kmc_t;
+
+kmc_t *kmc_init(lattice_t *lat);
+double kmc_step(kmc_t *kmc);
+double kmc_time(kmc_t *kmc);
+void kmc_free(kmc_t *kmc);
+
+#endif /*KMC_H*/
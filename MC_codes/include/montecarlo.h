@@ -1,24 +1,96 @@
 #ifndef MONTECARLO_H
 #define MONTECARLO_H
 
-double powerd(double x, int y);
-void init_configuration();
-void eval_list_nbrs();
-void print_configuration(char file_name[]);
-double eval_E();
-double mean_number_of_nbrs();
-void sweep();
-void thermalization(char file_name[]);
+#include "random.h"
+
+#define MOVE_TELEPORT 0
+#define MOVE_HOP 1
+#define N_MOVE_TYPES 2
 
-#ifdef DIM2
-int number_of_nbrs(int i, int j);
-#endif /*DIM2*/
+/*
+ * Parameters of a run, see global.h for the default values
+ */
+typedef struct
+{
+    int dim, lx, ly, lz, n_atoms, n_sweep, n_term, seed;
+    int n_replicas, raw_output, output, stride, schedule, swap_interval;
+    int sample_interval;
+    double j0, j1, temperature, log_f_final, flatness, hop_fraction, t_min, t_max;
+} parameters_t;
 
-#ifdef DIM3
-int number_of_nbrs(int i, int j, int k);
-int count_first_layer();
-void init_configuration_first_layer();
-void thermalization_first_layer(char file_name[]);
-#endif /*DIM3*/
+/*
+ * Lattice gas on a lx*ly*lz grid (lz=1 in two dimensions). The site
+ * (x,y,z) has index s=(x*ly+y)*lz+z, and the site n_sites is a site that is
+ * always empty, used as the missing neighbour of the sites at the walls.
+ *
+ * occupation[s]: 1 if the site s is occupied, 0 otherwise
+ * nbrs[n_nbrs*s+k]: the n_nbrs neighbours of the site s (left, right, up,
+ *  down, top, bottom)
+ * substrate[s]: 1 if the site s is in contact with the substrate (3D only)
+ * atom_site[i]: site of the atom i
+ * acceptance[db+6][ds+1]: Metropolis acceptance probability of a move that
+ *  changes the number of bonds by db and the atoms on the substrate by ds
+ * threshold[db+6][ds+1]: the same as an integer, the move is accepted if a
+ *  48-bit random integer is smaller
+ * output, stride: format and stride of the time series (see obstream.h)
+ * hop_fraction: probability of a local hop in sweep(), hop_threshold the
+ *  same times 2^48
+ * n_proposed[k], n_accepted[k]: moves of type k (MOVE_TELEPORT, MOVE_HOP)
+ *  proposed and accepted by sweep() since the last initialization
+ * rng: generator of the lattice, used by sweep() and init_configuration()
+ * step: number of calls of parallel_sweep() since the last initialization,
+ *  the step of the counter-based random numbers of the hops
+ * atom_strip[i], strip_atoms[strip_start[k]...strip_start[k+1]-1]: strip of
+ *  the atom i and atoms of the strip k in increasing order in parallel_sweep()
+ * number_strips, strip_width, strip_offset: domain decomposition of
+ *  parallel_sweep(), the strip k covers the columns strip_offset +
+ *  k*strip_width... (mod lx), the last one takes the remainder. The number
+ *  of strips is even and depends only on lx.
+ */
+typedef struct
+{
+    int dim, lx, ly, lz, n_sites, n_atoms, n_nbrs, seed;
+    int output, stride;
+    double j0, j1, temperature;
+    short *occupation;
+    int *nbrs;
+    char *substrate;
+    int *atom_site;
+    int *atom_strip, *strip_atoms, *strip_start;
+    int number_strips, strip_width, strip_offset;
+    ranbuf_t *rng;
+    int step;
+    double hop_fraction;
+    long long hop_threshold;
+    double n_proposed[N_MOVE_TYPES], n_accepted[N_MOVE_TYPES];
+    double acceptance[13][3];
+    long long threshold[13][3];
+} lattice_t;
+
+void default_parameters(parameters_t *par);
+void read_parameters(int argc, char *argv[], parameters_t *par);
+lattice_t *new_lattice(parameters_t *par);
+void free_lattice(lattice_t *lat);
+double powerd(double x, int y);
+void eval_list_nbrs(lattice_t *lat);
+void init_configuration(lattice_t *lat);
+void init_configuration_first_layer(lattice_t *lat);
+void print_configuration(lattice_t *lat, char file_name[]);
+int number_of_nbrs(lattice_t *lat, int s);
+double eval_E(lattice_t *lat);
+double mean_number_of_nbrs(lattice_t *lat);
+int count_first_layer(lattice_t *lat);
+void set_temperature(lattice_t *lat, double t);
+double acceptance_probability(lattice_t *lat, int delta_bonds, int delta_substrate);
+int random_move(lattice_t *lat, int *s_old, int *delta_bonds, int *delta_substrate);
+void undo_move(lattice_t *lat, int atom, int s_old);
+int teleport(lattice_t *lat);
+int local_hop(lattice_t *lat);
+void sweep(lattice_t *lat);
+void set_hop_fraction(lattice_t *lat, double hop_fraction);
+double acceptance_rate(lattice_t *lat, int move_type);
+void parallel_sweep(lattice_t *lat);
+void thermalization(lattice_t *lat, int n_term, char file_name[]);
+void thermalization_first_layer(lattice_t *lat, int n_term, char file_name[]);
 
 #endif /*MONTECARLO_H*/
@@ -0,0 +1,52 @@
+#ifndef OBSTREAM_H
+#define OBSTREAM_H
+
+#include <stdio.h>
+
+#define OBS_DOUBLE 0
+#define OBS_INT 1
+
+#define OBS_TEXT 0
+#define OBS_BINARY 1
+#define OBS_DELTA 2
+#define OBS_RLE 4
+
+#define OBS_MAX_COLUMNS 16
+#define OBS_NAME_LENGTH 16
+
+/*
+ * Extension of the files written with the given format
+ */
+#define obs_suffix(format) (((format) & OBS_BINARY) ? "obs" : "dat")
+
+/*
+ * Time series of observables (see obstream.c), opened for writing by
+ * obs_open() or for reading by obs_open_read()
+ *
+ * n_columns, name[c], type[c]: columns of the stream (OBS_DOUBLE or OBS_INT)
+ * stride: one row every stride calls of obs_write() is kept
+ * format: OBS_TEXT or OBS_BINARY, plus OBS_DELTA and OBS_RLE
+ * n_calls, n_rows: calls of obs_write() and rows written or read so far
+ * row_size: bytes of a row in a binary file
+ * prev, last: previous row, row of the pending run (encoded as in the file)
+ * run: number of repetitions of the pending run (OBS_RLE only)
+ */
+typedef struct
+{
+    FILE *fd;
+    int n_columns, stride, format, writing, row_size;
+    long n_calls, n_rows, run;
+    int type[OBS_MAX_COLUMNS];
+    char name[OBS_MAX_COLUMNS][OBS_NAME_LENGTH];
+    unsigned char prev[8 * OBS_MAX_COLUMNS], last[8 * OBS_MAX_COLUMNS];
+} obs_stream_t;
+
+obs_stream_t *obs_open(char file_name[], int n_columns, char *names[], int types[], int stride,
+                       int format);
+void obs_write(obs_stream_t *s, double x[]);
+obs_stream_t *obs_open_read(char file_name[]);
+int obs_read(obs_stream_t *s, double x[]);
+int obs_column(obs_stream_t *s, char name[]);
+void obs_close(obs_stream_t *s);
+
+#endif /*OBSTREAM_H*/
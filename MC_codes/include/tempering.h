@@ -0,0 +1,9 @@
+#ifndef TEMPERING_H
+#define TEMPERING_H
+
+#include "montecarlo.h"
+
+void parallel_tempering(parameters_t *par, int n_replicas, double temperatures[],
+                        int swap_interval, char file_name[]);
+
+#endif /*TEMPERING_H*/
@@ -0,0 +1,49 @@
+#ifndef WANGLANDAU_H
+#define WANGLANDAU_H
+
+#include "montecarlo.h"
+#include "histogram.h"
+
+#define WL_HALVING 0
+#define WL_INVERSE_TIME 1
+
+/*
+ * Wang-Landau estimate of the density of states g(b,c) of the lattice gas
+ * (see wanglandau.c), on the bins of a histogram_t.
+ *
+ * lat: lattice, whose configuration and generator are used by the walk
+ * visits: histogram of the visits since the last change of log_f
+ * log_g[bin]: current estimate of log g(b,c), -HUGE_VAL on the bins never
+ *  visited
+ * log_f: current modification factor, converged when smaller than
+ *  log_f_final
+ * flatness: the histogram is flat when its minimum over the visited bins is
+ *  at least flatness times its mean
+ * schedule: WL_HALVING or WL_INVERSE_TIME (log_f is set to 1/t once it
+ *  falls below 1/t, t being the number of moves per visited bin)
+ * inverse_time: 1 once log_f follows 1/t
+ * check: number of moves between two checks of the flatness
+ * stage: number of reductions of log_f
+ * bonds, contacts: bin of the current configuration
+ * n_bins: number of visited bins
+ * n_moves: number of moves since the start of the walk
+ */
+typedef struct
+{
+    lattice_t *lat;
+    histogram_t *visits;
+    double *log_g;
+    double log_f, log_f_final, flatness, n_moves;
+    int schedule, inverse_time, check, stage, bonds, contacts, n_bins;
+} wang_landau_t;
+
+wang_landau_t *new_wang_landau(lattice_t *lat, double log_f_final, double flatness, int schedule);
+void free_wang_landau(wang_landau_t *w);
+int wl_flat(wang_landau_t *w);
+void wl_run(wang_landau_t *w, double n_moves);
+int wl_converged(wang_landau_t *w);
+double *wl_dos(wang_landau_t *w);
+void save_wang_landau(wang_landau_t *w, char file_name[]);
+int load_wang_landau(wang_landau_t *w, char file_name[]);
+
+#endif /*WANGLANDAU_H*/
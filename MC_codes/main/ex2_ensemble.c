@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *
+ * File ex2_ensemble.c
+ *
+ * N_REPLICAS independent replicas, one per thread, sampled every
+ * SAMPLE_INTERVAL sweeps and merged into a single output with error bars
+ * (e.g. ./ex2_ensemble N_REPLICAS=16 SAMPLE_INTERVAL=50 RAW_OUTPUT=1 to
+ * change the defaults of global.h and keep the samples of every replica).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "montecarlo.h"
+#include "ensemble.h"
+#include "obstream.h"
+#include "random.h"
+#include "start.h"
+#include <assert.h>
+#include <time.h>
+
+int main(int argc, char *argv[])
+{
+    double average[3], sigma[3];
+    char file_name[100], raw_file_name[100];
+    parameters_t par;
+    FILE *fd;
+
+    read_parameters(argc, argv, &par);
+
+    sprintf(file_name, "../data/ex2_ensemble/seedN%d.dat", par.n_atoms);
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "main [ex2_ensemble.c]", "Unable to open the output file");
+    fprintf(fd, "%d\n", par.seed);
+    fclose(fd);
+
+    sprintf(file_name, "../data/ex2_ensemble/energy_and_nbrsN%d.dat", par.n_atoms);
+    sprintf(raw_file_name, "../data/ex2_ensemble/energy_and_nbrsN%dR%%d.%s", par.n_atoms,
+            obs_suffix(par.output));
+
+    run_ensemble(&par, par.sample_interval, file_name, par.raw_output ? raw_file_name : NULL,
+                 average, sigma);
+
+    sprintf(file_name, "../data/ex2_ensemble/averagesN%d.dat", par.n_atoms);
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "main [ex2_ensemble.c]", "Unable to open the output file");
+    fprintf(fd, "%.15e %.15e %.15e %.15e %.15e %.15e\n", average[0], sigma[0], average[1],
+            sigma[1], average[2], sigma[2]);
+    fclose(fd);
+
+    printf("%d replicas, T = %.1f K\n", par.n_replicas, par.temperature);
+    printf("E = %.6f +- %.6f\n", average[0], sigma[0]);
+    printf("nbrs = %.6f +- %.6f\n", average[1], sigma[1]);
+    printf("first layer = %.6f +- %.6f\n", average[2], sigma[2]);
+
+    return 0;
+}
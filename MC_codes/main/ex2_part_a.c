@@ -22,38 +22,40 @@ int main(int argc, char *argv[])
 {
     int i;
     char file_name[100];
+    parameters_t par;
+    lattice_t *lat;
     FILE *fd;
 
-    if (argc == 2)
-        seed = atoi(argv[1]);
-    else
-        seed = time(NULL);
+    read_parameters(argc, argv, &par);
+    lat = new_lattice(&par);
 
-    sprintf(file_name, "../data/ex2_part_a/seedN%d.dat", N);
+    sprintf(file_name, "../data/ex2_part_a/seedN%d.dat", par.n_atoms);
     fd = fopen(file_name, "w");
-    fprintf(fd, "%d\n", seed);
+    fprintf(fd, "%d\n", par.seed);
     fclose(fd);
 
-    sprintf(file_name, "../data/ex2_part_a/thermalization_energyN%d.dat", N);
+    sprintf(file_name, "../data/ex2_part_a/thermalization_energyN%d.dat", par.n_atoms);
 
-    thermalization(file_name);
+    thermalization(lat, par.n_term, file_name);
 
-    sprintf(file_name, "../data/ex2_part_a/init_confN%d.dat", N);
-    print_configuration(file_name);
+    sprintf(file_name, "../data/ex2_part_a/init_confN%d.dat", par.n_atoms);
+    print_configuration(lat, file_name);
 
-    sprintf(file_name, "../data/ex2_part_a/energyN%d.dat", N);
+    sprintf(file_name, "../data/ex2_part_a/energyN%d.dat", par.n_atoms);
     fd = fopen(file_name, "w");
 
-    for (i = 0; i < N_SWEEP; i++)
+    for (i = 0; i < par.n_sweep; i++)
     {
-        fprintf(fd, "%.15e \n", eval_E());
-        sweep();
+        fprintf(fd, "%.15e \n", eval_E(lat));
+        sweep(lat);
     }
 
     fclose(fd);
 
-    sprintf(file_name, "../data/ex2_part_a/final_confN%d.dat", N);
-    print_configuration(file_name);
+    sprintf(file_name, "../data/ex2_part_a/final_confN%d.dat", par.n_atoms);
+    print_configuration(lat, file_name);
+
+    free_lattice(lat);
 
     return 0;
 }
@@ -14,43 +14,50 @@
 #include <math.h>
 #include "global.h"
 #include "montecarlo.h"
+#include "obstream.h"
 #include "random.h"
 #include <assert.h>
 #include <time.h>
 
 int main(int argc, char *argv[])
 {
-    int i;
-    char file_name[100];
+    int i, types[2] = {OBS_DOUBLE, OBS_DOUBLE};
+    char file_name[100], *names[2] = {"energy", "nbrs"};
+    double x[2];
+    obs_stream_t *s;
+    parameters_t par;
+    lattice_t *lat;
     FILE *fd;
 
-    if (argc == 2)
-        seed = atoi(argv[1]);
-    else
-        seed = time(NULL);
+    read_parameters(argc, argv, &par);
+    lat = new_lattice(&par);
 
-    sprintf(file_name, "../data/ex2_part_c/seedL%dT%d.dat", LX, T);
+    sprintf(file_name, "../data/ex2_part_c/seedL%dT%d.dat", par.lx, (int)par.temperature);
     fd = fopen(file_name, "w");
-    fprintf(fd, "%d\n", seed);
+    fprintf(fd, "%d\n", par.seed);
     fclose(fd);
 
-    sprintf(file_name, "../data/ex2_part_c/thermalization_energyL%dT%d.dat", LX, T);
+    sprintf(file_name, "../data/ex2_part_c/thermalization_energyL%dT%d.%s", par.lx, (int)par.temperature, obs_suffix(par.output));
 
-    thermalization(file_name);
+    thermalization(lat, par.n_term, file_name);
 
-    sprintf(file_name, "../data/ex2_part_c/energy_and_nbrsL%dT%d.dat", LX, T);
-    fd = fopen(file_name, "w");
+    sprintf(file_name, "../data/ex2_part_c/energy_and_nbrsL%dT%d.%s", par.lx, (int)par.temperature, obs_suffix(par.output));
+    s = obs_open(file_name, 2, names, types, par.stride, par.output);
 
-    for (i = 0; i < N_SWEEP; i++)
+    for (i = 0; i < par.n_sweep; i++)
     {
-        fprintf(fd, "%.15e %.15e \n", eval_E(), mean_number_of_nbrs());
-        sweep();
+        x[0] = eval_E(lat);
+        x[1] = mean_number_of_nbrs(lat);
+        obs_write(s, x);
+        sweep(lat);
     }
 
-    fclose(fd);
+    obs_close(s);
+
+    sprintf(file_name, "../data/ex2_part_c/final_conf%dT%d.dat", par.lx, (int)par.temperature);
+    print_configuration(lat, file_name);
 
-    sprintf(file_name, "../data/ex2_part_c/final_conf%dT%d.dat", LX, T);
-    print_configuration(file_name);
+    free_lattice(lat);
 
     return 0;
 }
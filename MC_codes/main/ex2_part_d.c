@@ -14,42 +14,58 @@
 #include <math.h>
 #include "global.h"
 #include "montecarlo.h"
+#include "obstream.h"
+#include "histogram.h"
 #include "random.h"
 #include <assert.h>
 #include <time.h>
 
 int main(int argc, char *argv[])
 {
-    int i;
-    char file_name[100];
+    int i, types[3] = {OBS_DOUBLE, OBS_DOUBLE, OBS_INT};
+    char file_name[100], *names[3] = {"energy", "nbrs", "first_layer"};
+    double x[3];
+    obs_stream_t *s;
+    histogram_t *h;
+    parameters_t par;
+    lattice_t *lat;
     FILE *fd;
 
-    if (argc == 2)
-        seed = atoi(argv[1]);
-    else
-        seed = time(NULL);
+    read_parameters(argc, argv, &par);
+    lat = new_lattice(&par);
 
-    sprintf(file_name, "../data/ex2_part_d/seedJ0%.1fT%d.dat", J0, T);
+    sprintf(file_name, "../data/ex2_part_d/seedJ0%.1fT%d.dat", par.j0, (int)par.temperature);
     fd = fopen(file_name, "w");
-    fprintf(fd, "%d\n", seed);
+    fprintf(fd, "%d\n", par.seed);
     fclose(fd);
 
-    sprintf(file_name, "../data/ex2_part_d/thermalization_energyJ0%.1fT%d.dat", J0, T);
-    thermalization(file_name);
+    sprintf(file_name, "../data/ex2_part_d/thermalization_energyJ0%.1fT%d.%s", par.j0, (int)par.temperature, obs_suffix(par.output));
+    thermalization(lat, par.n_term, file_name);
 
-    sprintf(file_name, "../data/ex2_part_d/energy_and_nbrsJ0%.1fT%d.dat", J0, T);
-    fd = fopen(file_name, "w");
+    sprintf(file_name, "../data/ex2_part_d/energy_and_nbrsJ0%.1fT%d.%s", par.j0, (int)par.temperature, obs_suffix(par.output));
+    s = obs_open(file_name, 3, names, types, par.stride, par.output);
+    h = new_histogram(lat);
 
-    for (i = 0; i < N_SWEEP; i++)
+    for (i = 0; i < par.n_sweep; i++)
     {
-        fprintf(fd, "%.15e %.15e %d\n", eval_E(), mean_number_of_nbrs(), count_first_layer());
-        sweep();
+        x[0] = eval_E(lat);
+        x[1] = mean_number_of_nbrs(lat);
+        x[2] = count_first_layer(lat);
+        obs_write(s, x);
+        histogram_sample(h, lat);
+        sweep(lat);
     }
 
-    fclose(fd);
+    obs_close(s);
+
+    sprintf(file_name, "../data/ex2_part_d/histogramJ0%.1fT%d.dat", par.j0, (int)par.temperature);
+    save_histogram(h, file_name);
+    free_histogram(h);
+
+    sprintf(file_name, "../data/ex2_part_d/final_configJ0%.1fT%d.dat", par.j0, (int)par.temperature);
+    print_configuration(lat, file_name);
 
-    sprintf(file_name, "../data/ex2_part_d/final_configJ0%.1fT%d.dat", J0, T);
-    print_configuration(file_name);
+    free_lattice(lat);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ *
+ * File ex2_reweight.c
+ *
+ * Multiple histogram reweighting of the histograms written by ex2_part_d
+ * and ex2_part_e. The histograms given on the command line are combined
+ * with WHAM and the energy, the mean number of neighbours, the atoms in the
+ * first layer and the specific heat are printed at N_T temperatures between
+ * T_MIN and T_MAX and at the couplings J0, J1 (by default the ones of the
+ * first histogram), e.g.
+ *
+ *  ./ex2_reweight T_MIN=300 T_MAX=600 N_T=31 J0=-0.35 \
+ *      ../data/ex2_part_d/histogramJ0-0.3T300.dat \
+ *      ../data/ex2_part_d/histogramJ0-0.4T600.dat
+ *
+ * The results are reliable only where the runs sample the relevant
+ * configurations, i.e. between and close to the parameters of the runs.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+
+#define WHAM_TOL 1e-10
+
+int main(int argc, char *argv[])
+{
+    int i, n, n_t, it, set_j0, set_j1, ok;
+    double t_min, t_max, t, j0, j1, average[4], *log_g;
+    histogram_t **h;
+    clock_t start;
+
+    h = (histogram_t **)malloc(argc * sizeof(histogram_t *));
+    error(h == NULL, 1, "main [ex2_reweight.c]", "Unable to allocate the histograms");
+
+    n = 0;
+    n_t = 1;
+    t_min = -1;
+    t_max = -1;
+    set_j0 = 0;
+    set_j1 = 0;
+    j0 = J0;
+    j1 = J1;
+
+    for (i = 1; i < argc; i++)
+    {
+        ok = 1;
+
+        if (strncmp(argv[i], "T_MIN=", 6) == 0)
+            ok = sscanf(argv[i] + 6, "%lf", &t_min);
+        else if (strncmp(argv[i], "T_MAX=", 6) == 0)
+            ok = sscanf(argv[i] + 6, "%lf", &t_max);
+        else if (strncmp(argv[i], "N_T=", 4) == 0)
+            ok = sscanf(argv[i] + 4, "%d", &n_t);
+        else if (strncmp(argv[i], "J0=", 3) == 0)
+            ok = set_j0 = sscanf(argv[i] + 3, "%lf", &j0);
+        else if (strncmp(argv[i], "J1=", 3) == 0)
+            ok = set_j1 = sscanf(argv[i] + 3, "%lf", &j1);
+        else if (strchr(argv[i], '=') == NULL)
+            h[n++] = load_histogram(argv[i]);
+        else
+            ok = 0;
+
+        error(ok != 1, 1, "main [ex2_reweight.c]", "Unknown or malformed parameter");
+    }
+
+    error(n == 0, 1, "main [ex2_reweight.c]", "No histogram files given");
+    error(n_t < 1, 1, "main [ex2_reweight.c]", "N_T must be positive");
+
+    if (!set_j0)
+        j0 = h[0]->j0;
+    if (!set_j1)
+        j1 = h[0]->j1;
+
+    if (t_min < 0)
+        t_min = h[0]->temperature;
+    if (t_max < 0)
+        t_max = t_min;
+
+    start = clock();
+    log_g = wham(h, n, WHAM_TOL, &it);
+
+    printf("# %d histograms, WHAM: %d iterations, %.3f s\n", n, it,
+           (double)(clock() - start) / CLOCKS_PER_SEC);
+    printf("# J0 = %.4f J1 = %.4f\n", j0, j1);
+    printf("# T E nbrs first_layer C\n");
+
+    for (i = 0; i < n_t; i++)
+    {
+        t = (n_t == 1) ? t_min : t_min + (t_max - t_min) * i / (n_t - 1);
+        reweight(h[0], log_g, t, j0, j1, average);
+        printf("%.4f %.15e %.15e %.15e %.15e\n", t, average[0], average[1], average[2],
+               average[3]);
+    }
+
+    for (i = 0; i < n; i++)
+        free_histogram(h[i]);
+
+    free(h);
+    free(log_g);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ *
+ * File ex2_tempering.c
+ *
+ * Parallel tempering over a geometric ladder of N_REPLICAS temperatures
+ * between T_MIN and T_MAX, one replica per thread, with a swap attempt
+ * every SWAP_INTERVAL sweeps (e.g. ./ex2_tempering N_REPLICAS=12 T_MIN=200
+ * T_MAX=1000 SWAP_INTERVAL=50 to change the defaults of global.h).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "montecarlo.h"
+#include "tempering.h"
+#include "random.h"
+#include "start.h"
+#include <assert.h>
+#include <time.h>
+
+int main(int argc, char *argv[])
+{
+    int m;
+    double *temperatures;
+    char file_name[100];
+    parameters_t par;
+    FILE *fd;
+
+    read_parameters(argc, argv, &par);
+    error(par.n_replicas < 2, 1, "main [ex2_tempering.c]",
+          "N_REPLICAS must be at least 2 to span the ladder");
+    error(par.t_min <= 0 || par.t_max <= par.t_min, 1, "main [ex2_tempering.c]",
+          "The ladder requires 0 < T_MIN < T_MAX");
+
+    temperatures = (double *)malloc(par.n_replicas * sizeof(double));
+    error(temperatures == NULL, 1, "main [ex2_tempering.c]", "Unable to allocate the ladder");
+
+    for (m = 0; m < par.n_replicas; m++)
+        temperatures[m] = par.t_min * pow(par.t_max / par.t_min, m / (double)(par.n_replicas - 1));
+
+    sprintf(file_name, "../data/ex2_tempering/seedN%d.dat", par.n_atoms);
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "main [ex2_tempering.c]", "Unable to open the output file");
+    fprintf(fd, "%d\n", par.seed);
+    fclose(fd);
+
+    sprintf(file_name, "../data/ex2_tempering/energy_and_nbrsN%d.dat", par.n_atoms);
+    parallel_tempering(&par, par.n_replicas, temperatures, par.swap_interval, file_name);
+
+    free(temperatures);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *
+ * File ex2_wang_landau.c
+ *
+ * Wang-Landau density of states of the lattice gas (see wanglandau.c). The
+ * walk is saved in a checkpoint every N_SWEEP moves and resumed from it if
+ * the program is started again with the same lattice, until log_f is
+ * smaller than LOG_F_FINAL. The density of states log g(b,c) is then
+ * written together with the energy, the mean number of neighbours, the
+ * atoms in the first layer and the specific heat between 10 and 1000 K at
+ * the couplings J0 and J1, e.g.
+ *
+ *  ./ex2_wang_landau N=27 J0=-0.35 N_SWEEP=10000000 LOG_F_FINAL=1e-7
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+#include "wanglandau.h"
+
+#define TABLE_T_MIN 10
+#define TABLE_T_MAX 1000
+#define N_T 100
+
+int main(int argc, char *argv[])
+{
+    int i, b, c;
+    char checkpoint[100], file_name[100];
+    double t, average[4], *log_g;
+    clock_t start;
+    parameters_t par;
+    lattice_t *lat;
+    wang_landau_t *w;
+    FILE *fd;
+
+    read_parameters(argc, argv, &par);
+    error(par.n_sweep < 1, 1, "main [ex2_wang_landau.c]", "N_SWEEP must be positive");
+
+    lat = new_lattice(&par);
+    init_configuration(lat);
+    w = new_wang_landau(lat, par.log_f_final, par.flatness, par.schedule);
+
+    sprintf(checkpoint, "../data/ex2_wang_landau/checkpointD%dL%dx%dx%dN%d.bin", lat->dim, lat->lx,
+            lat->ly, lat->lz, lat->n_atoms);
+
+    if (load_wang_landau(w, checkpoint))
+        printf("Resumed from %s after %.0f moves\n", checkpoint, w->n_moves);
+
+    start = clock();
+
+    while (!wl_converged(w))
+    {
+        wl_run(w, par.n_sweep);
+        save_wang_landau(w, checkpoint);
+        printf("%.0f moves: stage %d, log_f = %.3e, %d bins, %.1f s\n", w->n_moves, w->stage,
+               w->log_f, w->n_bins, (double)(clock() - start) / CLOCKS_PER_SEC);
+    }
+
+    log_g = wl_dos(w);
+
+    sprintf(file_name, "../data/ex2_wang_landau/dosD%dL%dx%dx%dN%d.dat", lat->dim, lat->lx, lat->ly,
+            lat->lz, lat->n_atoms);
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "main [ex2_wang_landau.c]", "Unable to open the output file");
+    fprintf(fd, "# bonds contacts log_g\n");
+
+    for (b = 0; b <= w->visits->max_bonds; b++)
+        for (c = 0; c <= w->visits->max_contacts; c++)
+            if (log_g[b * (w->visits->max_contacts + 1) + c] != -HUGE_VAL)
+                fprintf(fd, "%d %d %.15e\n", b, c, log_g[b * (w->visits->max_contacts + 1) + c]);
+
+    fclose(fd);
+
+    sprintf(file_name, "../data/ex2_wang_landau/thermodynamicsJ0%.2fN%d.dat", par.j0, lat->n_atoms);
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "main [ex2_wang_landau.c]", "Unable to open the output file");
+    fprintf(fd, "# T E nbrs first_layer C\n");
+
+    for (i = 0; i < N_T; i++)
+    {
+        t = TABLE_T_MIN + (TABLE_T_MAX - TABLE_T_MIN) * i / (N_T - 1.0);
+        reweight(w->visits, log_g, t, par.j0, par.j1, average);
+        fprintf(fd, "%.4f %.15e %.15e %.15e %.15e\n", t, average[0], average[1], average[2],
+                average[3]);
+    }
+
+    fclose(fd);
+
+    free(log_g);
+    free_wang_landau(w);
+    free_lattice(lat);
+
+    return 0;
+}
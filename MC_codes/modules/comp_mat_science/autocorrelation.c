@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *
+ * Library autocorrelation.c
+ *
+ * Integrated autocorrelation time of a time series x[0...n-1],
+ *
+ *  tau = 1/2 + sum_{t=1}^{W} rho(t),
+ *
+ * rho(t) being the normalized autocorrelation function. The window W is
+ * the smallest one with W >= AUTO_WINDOW*tau(W) (Sokal's automatic
+ * windowing), which balances the bias of a short window against the noise
+ * of a long one. The variance of the mean of the series is then
+ * 2*tau*var(x)/n, i.e. the series has n/(2*tau) independent samples.
+ *
+ * The externally accessible functions are:
+ *
+ * double autocorrelation(double x[], int n, int t)
+ *  Normalized autocorrelation function rho(t) of x[0...n-1] (0 for a
+ *  constant series).
+ *
+ * double autocorrelation_time(double x[], int n, int *window)
+ *  Integrated autocorrelation time of x[0...n-1] in units of the spacing
+ *  of the samples. The window is returned in *window, if it is reached
+ *  before n/2 the estimate is reliable (the error of tau is about
+ *  tau*sqrt(2*(2*window+1)/n)), otherwise the series is too short.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "start.h"
+#include "autocorrelation.h"
+
+#define AUTO_WINDOW 6
+
+static double mean_and_variance(double x[], int n, double *variance)
+{
+    int i;
+    double mean, v;
+
+    mean = 0;
+    for (i = 0; i < n; i++)
+        mean += x[i];
+    mean /= n;
+
+    v = 0;
+    for (i = 0; i < n; i++)
+        v += (x[i] - mean) * (x[i] - mean);
+    *variance = v / n;
+
+    return mean;
+}
+
+static double rho(double x[], int n, int t, double mean, double variance)
+{
+    int i;
+    double c;
+
+    if (variance == 0)
+        return 0;
+
+    c = 0;
+    for (i = 0; i < n - t; i++)
+        c += (x[i] - mean) * (x[i + t] - mean);
+
+    return c / ((n - t) * variance);
+}
+
+double autocorrelation(double x[], int n, int t)
+{
+    double mean, variance;
+
+    error(n < 1 || t < 0 || t >= n, 1, "autocorrelation [autocorrelation.c]", "Bad lag");
+
+    mean = mean_and_variance(x, n, &variance);
+
+    return rho(x, n, t, mean, variance);
+}
+
+double autocorrelation_time(double x[], int n, int *window)
+{
+    int t;
+    double mean, variance, tau;
+
+    error(n < 2, 1, "autocorrelation_time [autocorrelation.c]", "The series is too short");
+
+    mean = mean_and_variance(x, n, &variance);
+    tau = 0.5;
+
+    for (t = 1; t < n / 2; t++)
+    {
+        tau += rho(x, n, t, mean, variance);
+
+        if (t >= AUTO_WINDOW * tau)
+            break;
+    }
+
+    *window = t;
+
+    return tau;
+}
@@ -0,0 +1,210 @@
+/*******************************************************************************
+ *
+ * Library ensemble.c
+ *
+ * Independent replicas of the lattice gas, one per OpenMP thread, each with
+ * its own lattice and its own generator (seeded with the seed of the run
+ * plus the index of the replica). The observables of the replicas are
+ * merged while the run goes on, so that a single run gives averages with
+ * statistical errors that do not suffer from the autocorrelation of a
+ * single Markov chain.
+ *
+ * The observables are the energy, the mean number of neighbours and the
+ * number of atoms in the first layer (0 in two dimensions). They are
+ * sampled every sample_interval sweeps; every BLOCK samples the threads
+ * wait for each other and the master writes the merged block, hence the
+ * output depends only on the seed and on the number of replicas.
+ *
+ * The externally accessible functions are:
+ *
+ * void run_ensemble(parameters_t *par, int sample_interval, char file_name[],
+ *                   char raw_file_name[], double average[], double sigma[])
+ *  Runs par->n_replicas replicas for par->n_term sweeps of thermalization
+ *  followed by par->n_sweep sweeps of measurements. Writes in file_name one
+ *  line per sample with the number of sweeps and, for each observable, the
+ *  average over the replicas and its error. If raw_file_name is not NULL it
+ *  is a format with one %d, replaced by the index of the replica, and every
+ *  replica writes its own samples there, in the format par->output (see
+ *  obstream.c). On exit average[0...2] and
+ *  sigma[0...2] are the averages over the run and over the replicas of the
+ *  three observables and their errors, obtained from the spread of the
+ *  time averages of the replicas.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "global.h"
+#include "random.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "obstream.h"
+#include "ensemble.h"
+
+#define N_OBSERVABLES 3
+#define BLOCK 1000
+
+/*
+ * samples[(k*BLOCK+j)*N_OBSERVABLES+o] is the observable o of the replica k
+ * in the sample j of the current block
+ */
+static double *samples;
+
+/*
+ * Average over the replicas and error of the average (from the spread of
+ * the n values x[0], x[stride], ...)
+ */
+static void merge(double x[], int n, int stride, double *mean, double *err)
+{
+    int k;
+    double sum, var;
+
+    sum = 0;
+    for (k = 0; k < n; k++)
+        sum += x[k * stride];
+    *mean = sum / n;
+
+    var = 0;
+    for (k = 0; k < n; k++)
+        var += (x[k * stride] - *mean) * (x[k * stride] - *mean);
+
+    *err = (n > 1) ? sqrt(var / ((double)n * (n - 1))) : 0;
+}
+
+static void write_block(FILE *fd, int n_replicas, int first_sample, int n_samples,
+                        int sample_interval)
+{
+    int j, o;
+    double mean, err;
+
+    for (j = 0; j < n_samples; j++)
+    {
+        fprintf(fd, "%d", (first_sample + j + 1) * sample_interval);
+
+        for (o = 0; o < N_OBSERVABLES; o++)
+        {
+            merge(samples + j * N_OBSERVABLES + o, n_replicas, BLOCK * N_OBSERVABLES,
+                  &mean, &err);
+            fprintf(fd, " %.15e %.15e", mean, err);
+        }
+
+        fprintf(fd, "\n");
+    }
+}
+
+void run_ensemble(parameters_t *par, int sample_interval, char file_name[],
+                  char raw_file_name[], double average[], double sigma[])
+{
+    int n_replicas, n_samples, o;
+    double *time_average;
+    FILE *fd;
+
+    n_replicas = par->n_replicas;
+
+    error((n_replicas < 1) || (sample_interval < 1), 1, "run_ensemble [ensemble.c]",
+          "Bad number of replicas or sample interval");
+
+    n_samples = par->n_sweep / sample_interval;
+    error(n_samples < 1, 1, "run_ensemble [ensemble.c]", "No samples (N_SWEEP < sample interval)");
+
+#ifndef _OPENMP
+    error(n_replicas > 1, 1, "run_ensemble [ensemble.c]",
+          "More than one replica requires OpenMP");
+#endif
+
+    samples = (double *)malloc(n_replicas * BLOCK * N_OBSERVABLES * sizeof(double));
+    time_average = (double *)malloc(n_replicas * N_OBSERVABLES * sizeof(double));
+    error((samples == NULL) || (time_average == NULL), 1, "run_ensemble [ensemble.c]",
+          "Unable to allocate the samples");
+
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "run_ensemble [ensemble.c]", "Unable to open the output file");
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_replicas)
+#endif
+    {
+        int k, i, j, n, b, o, types[N_OBSERVABLES] = {OBS_DOUBLE, OBS_DOUBLE, OBS_INT};
+        double *x;
+        char raw_name[200], *names[N_OBSERVABLES] = {"energy", "nbrs", "first_layer"};
+        parameters_t replica;
+        lattice_t *lat;
+        obs_stream_t *raw;
+
+        k = 0;
+#ifdef _OPENMP
+        k = omp_get_thread_num();
+        error(omp_get_num_threads() != n_replicas, 1, "run_ensemble [ensemble.c]",
+              "Unable to start one thread per replica");
+#endif
+        replica = *par;
+        replica.seed = (int)(((long)par->seed - 1 + k) % 2147483647L + 1);
+        lat = new_lattice(&replica);
+
+        raw = NULL;
+        if (raw_file_name != NULL)
+        {
+            sprintf(raw_name, raw_file_name, k);
+            raw = obs_open(raw_name, N_OBSERVABLES, names, types, 1, par->output);
+        }
+
+        init_configuration(lat);
+
+        for (i = 0; i < par->n_term; i++)
+            sweep(lat);
+
+        for (o = 0; o < N_OBSERVABLES; o++)
+            time_average[k * N_OBSERVABLES + o] = 0;
+
+        for (n = 0; n < n_samples; n += BLOCK)
+        {
+            b = (n + BLOCK <= n_samples) ? BLOCK : n_samples - n;
+
+            for (j = 0; j < b; j++)
+            {
+                for (i = 0; i < sample_interval; i++)
+                    sweep(lat);
+
+                x = samples + (k * BLOCK + j) * N_OBSERVABLES;
+                x[0] = eval_E(lat);
+                x[1] = mean_number_of_nbrs(lat);
+                x[2] = count_first_layer(lat);
+
+                if (raw != NULL)
+                    obs_write(raw, x);
+
+                for (o = 0; o < N_OBSERVABLES; o++)
+                    time_average[k * N_OBSERVABLES + o] += x[o] / n_samples;
+            }
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp master
+#endif
+            write_block(fd, n_replicas, n, b, sample_interval);
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
+        }
+
+        if (raw != NULL)
+            obs_close(raw);
+
+        free_lattice(lat);
+    }
+
+    fclose(fd);
+
+    for (o = 0; o < N_OBSERVABLES; o++)
+        merge(time_average + o, n_replicas, N_OBSERVABLES, average + o, sigma + o);
+
+    free(samples);
+    free(time_average);
+}
@@ -0,0 +1,336 @@
+/*******************************************************************************
+ *
+ * Library histogram.c
+ *
+ * Histogram reweighting for the lattice gas. The energy of a configuration
+ * is E = J1*b + J0*c, where b is the number of bonds and c the number of
+ * atoms in contact with the substrate, and the mean number of neighbours is
+ * 2b/N and the atoms in the first layer are c. A joint histogram of (b,c)
+ * sampled at (T,J0,J1) hence contains all the information needed to obtain
+ * these observables at any other (T,J0,J1) close enough to be sampled by
+ * the same configurations.
+ *
+ * Histograms of several runs are combined with the multiple histogram
+ * method (Ferrenberg-Swendsen, WHAM), which gives the density of states
+ *
+ *  g(b,c) = sum_k H_k(b,c) / sum_k N_k exp(f_k - E_k(b,c)/(KB*T_k))
+ *
+ * with the free energies f_k of the runs fixed by the self-consistency
+ * condition exp(-f_k) = sum_{b,c} g(b,c) exp(-E_k(b,c)/(KB*T_k)). All
+ * quantities are kept as logarithms. The samples are given the same weight,
+ * i.e. the runs are assumed to have similar autocorrelation times.
+ *
+ * The externally accessible functions are:
+ *
+ * histogram_t *new_histogram(lattice_t *lat)
+ *  Allocates an empty histogram for the lattice and its current
+ *  temperature and couplings.
+ *
+ * void free_histogram(histogram_t *h)
+ *  Frees the histogram.
+ *
+ * void count_bonds_contacts(lattice_t *lat, int *bonds, int *contacts)
+ *  Counts the bonds and the atoms in contact with the substrate.
+ *
+ * void histogram_sample(histogram_t *h, lattice_t *lat)
+ *  Adds the current configuration of lat to the histogram.
+ *
+ * void save_histogram(histogram_t *h, char file_name[])
+ *  Writes the histogram in file_name: a line with N, the maximal b and c,
+ *  T, J0, J1 and the number of samples, then one line "b c count" for every
+ *  non-empty bin.
+ *
+ * histogram_t *load_histogram(char file_name[])
+ *  Reads a histogram written by save_histogram().
+ *
+ * double *wham(histogram_t *h[], int n, double tol, int *iterations)
+ *  Combines the histograms h[0...n-1] (of the same lattice, at T>0) and
+ *  returns log g(b,c) in an array indexed as the counts of a histogram,
+ *  with -HUGE_VAL on the bins never visited. The free energies are
+ *  iterated until they change by less than tol, the number of iterations
+ *  is returned in *iterations.
+ *
+ * void reweight(histogram_t *h, double log_g[], double t, double j0,
+ *               double j1, double average[])
+ *  Averages at temperature t and couplings j0, j1 given the density of
+ *  states log_g on the bins of h: average[0] energy, average[1] mean number
+ *  of neighbours, average[2] atoms in the first layer and average[3]
+ *  specific heat (<E^2>-<E>^2)/(KB*T^2).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "histogram.h"
+
+#define MAX_BINS (1 << 26)
+#define MAX_ITERATIONS 100000
+
+static histogram_t *alloc_histogram(int n_atoms, int max_bonds, int max_contacts)
+{
+    histogram_t *h;
+
+    error(n_atoms < 1 || max_bonds < 0 || max_contacts < 0 ||
+              (double)(max_bonds + 1) * (max_contacts + 1) > MAX_BINS,
+          1, "alloc_histogram [histogram.c]", "Bad or too large histogram");
+
+    h = (histogram_t *)malloc(sizeof(histogram_t));
+    error(h == NULL, 1, "alloc_histogram [histogram.c]", "Unable to allocate the histogram");
+
+    h->n_atoms = n_atoms;
+    h->max_bonds = max_bonds;
+    h->max_contacts = max_contacts;
+    h->n_samples = 0;
+    h->count = (double *)calloc((max_bonds + 1) * (max_contacts + 1), sizeof(double));
+    error(h->count == NULL, 1, "alloc_histogram [histogram.c]",
+          "Unable to allocate the histogram");
+
+    return h;
+}
+
+histogram_t *new_histogram(lattice_t *lat)
+{
+    int max_contacts;
+    histogram_t *h;
+
+    max_contacts = 0;
+    if (lat->dim == 3)
+        max_contacts = (lat->n_atoms < lat->lx * lat->ly) ? lat->n_atoms : lat->lx * lat->ly;
+
+    h = alloc_histogram(lat->n_atoms, lat->n_atoms * lat->n_nbrs / 2, max_contacts);
+    h->temperature = lat->temperature;
+    h->j0 = lat->j0;
+    h->j1 = lat->j1;
+
+    return h;
+}
+
+void free_histogram(histogram_t *h)
+{
+    free(h->count);
+    free(h);
+}
+
+void count_bonds_contacts(lattice_t *lat, int *bonds, int *contacts)
+{
+    int i, s, b, c;
+
+    b = 0;
+    c = 0;
+
+    for (i = 0; i < lat->n_atoms; i++)
+    {
+        s = lat->atom_site[i];
+        b += number_of_nbrs(lat, s);
+        c += lat->substrate[s];
+    }
+
+    *bonds = b / 2;
+    *contacts = c;
+}
+
+void histogram_sample(histogram_t *h, lattice_t *lat)
+{
+    int b, c;
+
+    count_bonds_contacts(lat, &b, &c);
+    h->count[b * (h->max_contacts + 1) + c] += 1;
+    h->n_samples += 1;
+}
+
+void save_histogram(histogram_t *h, char file_name[])
+{
+    int b, c;
+    double count;
+    FILE *fd;
+
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "save_histogram [histogram.c]", "Unable to open the output file");
+
+    fprintf(fd, "%d %d %d %.15e %.15e %.15e %.0f\n", h->n_atoms, h->max_bonds, h->max_contacts,
+            h->temperature, h->j0, h->j1, h->n_samples);
+
+    for (b = 0; b <= h->max_bonds; b++)
+    {
+        for (c = 0; c <= h->max_contacts; c++)
+        {
+            count = h->count[b * (h->max_contacts + 1) + c];
+
+            if (count > 0)
+                fprintf(fd, "%d %d %.0f\n", b, c, count);
+        }
+    }
+
+    fclose(fd);
+}
+
+histogram_t *load_histogram(char file_name[])
+{
+    int n_atoms, max_bonds, max_contacts, b, c;
+    double t, j0, j1, n_samples, count;
+    histogram_t *h;
+    FILE *fd;
+
+    fd = fopen(file_name, "r");
+    error(fd == NULL, 1, "load_histogram [histogram.c]", "Unable to open the input file");
+
+    error(fscanf(fd, "%d %d %d %lf %lf %lf %lf", &n_atoms, &max_bonds, &max_contacts, &t, &j0, &j1,
+                 &n_samples) != 7,
+          1, "load_histogram [histogram.c]", "Bad header");
+
+    h = alloc_histogram(n_atoms, max_bonds, max_contacts);
+    h->temperature = t;
+    h->j0 = j0;
+    h->j1 = j1;
+
+    while (fscanf(fd, "%d %d %lf", &b, &c, &count) == 3)
+    {
+        error(b < 0 || b > max_bonds || c < 0 || c > max_contacts, 1,
+              "load_histogram [histogram.c]", "Bin out of range");
+        h->count[b * (max_contacts + 1) + c] = count;
+        h->n_samples += count;
+    }
+
+    fclose(fd);
+
+    error(h->n_samples != n_samples, 1, "load_histogram [histogram.c]", "Truncated file");
+
+    return h;
+}
+
+/*
+ * log(exp(a)+exp(b)), with -HUGE_VAL standing for log(0)
+ */
+static double log_add(double a, double b)
+{
+    if (a == -HUGE_VAL)
+        return b;
+    if (b == -HUGE_VAL)
+        return a;
+
+    return (a > b) ? a + log(1 + exp(b - a)) : b + log(1 + exp(a - b));
+}
+
+static double energy(histogram_t *h, int bin, double j0, double j1)
+{
+    return j1 * (bin / (h->max_contacts + 1)) + j0 * (bin % (h->max_contacts + 1));
+}
+
+double *wham(histogram_t *h[], int n, double tol, int *iterations)
+{
+    int k, x, n_bins, it;
+    double *log_g, *f, *f_new, *beta, total, denominator, change;
+
+    error(n < 1, 1, "wham [histogram.c]", "No histograms");
+
+    n_bins = (h[0]->max_bonds + 1) * (h[0]->max_contacts + 1);
+
+    for (k = 0; k < n; k++)
+    {
+        error(h[k]->n_atoms != h[0]->n_atoms || h[k]->max_bonds != h[0]->max_bonds ||
+                  h[k]->max_contacts != h[0]->max_contacts,
+              1, "wham [histogram.c]", "Histograms of different lattices");
+        error(h[k]->temperature <= 0 || h[k]->n_samples <= 0, 1, "wham [histogram.c]",
+              "Histograms must be sampled at T > 0");
+    }
+
+    log_g = (double *)malloc(n_bins * sizeof(double));
+    f = (double *)calloc(3 * n, sizeof(double));
+    error(log_g == NULL || f == NULL, 1, "wham [histogram.c]", "Unable to allocate the arrays");
+    f_new = f + n;
+    beta = f + 2 * n;
+
+    for (k = 0; k < n; k++)
+        beta[k] = 1 / (KB * h[k]->temperature);
+
+    for (it = 1; it <= MAX_ITERATIONS; it++)
+    {
+        for (k = 0; k < n; k++)
+            f_new[k] = -HUGE_VAL;
+
+        for (x = 0; x < n_bins; x++)
+        {
+            total = 0;
+            denominator = -HUGE_VAL;
+
+            for (k = 0; k < n; k++)
+            {
+                total += h[k]->count[x];
+                denominator = log_add(denominator, log(h[k]->n_samples) + f[k] -
+                                                       beta[k] * energy(h[k], x, h[k]->j0, h[k]->j1));
+            }
+
+            log_g[x] = (total > 0) ? log(total) - denominator : -HUGE_VAL;
+
+            if (total > 0)
+                for (k = 0; k < n; k++)
+                    f_new[k] = log_add(f_new[k], log_g[x] - beta[k] * energy(h[k], x, h[k]->j0, h[k]->j1));
+        }
+
+        /*f_k = -log(sum_x g(x) exp(-beta_k E_k(x))), normalized to f_0 = 0*/
+        change = 0;
+
+        for (k = n - 1; k >= 0; k--)
+        {
+            f_new[k] = -(f_new[k] - f_new[0]);
+
+            if (fabs(f_new[k] - f[k]) > change)
+                change = fabs(f_new[k] - f[k]);
+
+            f[k] = f_new[k];
+        }
+
+        if (change < tol)
+            break;
+    }
+
+    *iterations = it;
+    free(f);
+
+    return log_g;
+}
+
+void reweight(histogram_t *h, double log_g[], double t, double j0, double j1, double average[])
+{
+    int x, n_bins;
+    double beta, w, E, log_z, e1, e2, nbrs, layer;
+
+    error(t <= 0, 1, "reweight [histogram.c]", "Reweighting requires T > 0");
+
+    n_bins = (h->max_bonds + 1) * (h->max_contacts + 1);
+    beta = 1 / (KB * t);
+    log_z = -HUGE_VAL;
+
+    for (x = 0; x < n_bins; x++)
+        if (log_g[x] != -HUGE_VAL)
+            log_z = log_add(log_z, log_g[x] - beta * energy(h, x, j0, j1));
+
+    e1 = 0;
+    e2 = 0;
+    nbrs = 0;
+    layer = 0;
+
+    for (x = 0; x < n_bins; x++)
+    {
+        if (log_g[x] == -HUGE_VAL)
+            continue;
+
+        E = energy(h, x, j0, j1);
+        w = exp(log_g[x] - beta * E - log_z);
+        e1 += w * E;
+        e2 += w * E * E;
+        nbrs += w * 2.0 * (x / (h->max_contacts + 1)) / h->n_atoms;
+        layer += w * (x % (h->max_contacts + 1));
+    }
+
+    average[0] = e1;
+    average[1] = nbrs;
+    average[2] = layer;
+    average[3] = (e2 - e1 * e1) * beta / t;
+}
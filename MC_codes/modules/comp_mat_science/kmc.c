@@ -0,0 +1,283 @@
+/*******************************************************************************
+ *
+ * Library kmc.c
+ *
+ * Rejection-free kinetic Monte Carlo (n-fold way, Bortz-Kalos-Lebowitz) for
+ * the lattice gas. The candidate moves are the ones of sweep(): any atom to
+ * any empty site. Atoms and empty sites are grouped in classes labelled by
+ * the number of occupied neighbours and by the contact with the substrate,
+ * so that the rate of a move only depends on the classes of its source and
+ * of its target. An event is selected class by class, hence the cost of a
+ * step does not depend on the size of the lattice.
+ *
+ * The random numbers are drawn from the generator of the lattice.
+ *
+ * Time is measured in Metropolis moves (the unit of sweep()): each event
+ * advances the clock by an exponentially distributed residence time, and
+ * averages over the trajectory must be weighted with these times.
+ *
+ * A move to a neighbouring empty site breaks one bond more than the class
+ * labels say. Such a move is selected with the rate of its classes and then
+ * accepted with the ratio of the two rates, which keeps the dynamics exact
+ * at the price of rare null events (the clock advances, nothing moves).
+ *
+ * The externally accessible functions are:
+ *
+ * kmc_t *kmc_init(lattice_t *lat)
+ *  Builds the classes from the current configuration of lat, which is then
+ *  evolved by kmc_step(). To be called after init_configuration(), and
+ *  again (after kmc_free()) whenever the configuration is changed by
+ *  something else than kmc_step(). Several lattices can be evolved at the
+ *  same time, each by its own kmc_t.
+ *
+ * double kmc_step(kmc_t *kmc)
+ *  Performs one event and returns the time spent in the configuration
+ *  preceding it. If no move is possible (a local minimum at T=0) the
+ *  configuration is left unchanged and -1 is returned.
+ *
+ * double kmc_time(kmc_t *kmc)
+ *  Time elapsed since kmc_init().
+ *
+ * void kmc_free(kmc_t *kmc)
+ *  Frees the dynamics (not the lattice).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#include "global.h"
+#include "random.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "kmc.h"
+
+static void insert_site(kmc_t *kmc, int s, int g)
+{
+    kmc->group[s] = g;
+    kmc->where[s] = kmc->population[g];
+    kmc->members[g * kmc->n_sites + kmc->population[g]] = s;
+    kmc->population[g]++;
+}
+
+static void remove_site(kmc_t *kmc, int s)
+{
+    int g, last;
+
+    g = kmc->group[s];
+    kmc->population[g]--;
+    last = kmc->members[g * kmc->n_sites + kmc->population[g]];
+    kmc->members[g * kmc->n_sites + kmc->where[s]] = last;
+    kmc->where[last] = kmc->where[s];
+}
+
+static int group_of(kmc_t *kmc, int s)
+{
+    return (1 - kmc->lat->occupation[s]) * kmc->n_class + 2 * kmc->occupied_nbrs[s] +
+           kmc->lat->substrate[s];
+}
+
+static void update_group(kmc_t *kmc, int s)
+{
+    int g;
+
+    if (s == kmc->n_sites) /*missing neighbour along z*/
+        return;
+
+    g = group_of(kmc, s);
+
+    if (g != kmc->group[s])
+    {
+        remove_site(kmc, s);
+        insert_site(kmc, s, g);
+    }
+}
+
+/*
+ * Picks the index of the interval of weight[0...n-1] that contains u, with
+ * 0<=u<sum of the weights. Round-off is absorbed by the last non-empty one.
+ */
+static int select_interval(double weight[], int n, double u)
+{
+    int k, last;
+
+    last = -1;
+
+    for (k = 0; k < n; k++)
+    {
+        if (weight[k] > 0)
+        {
+            if (u < weight[k])
+                return k;
+            u -= weight[k];
+            last = k;
+        }
+    }
+
+    assert(last >= 0);
+
+    return last;
+}
+
+kmc_t *kmc_init(lattice_t *lat)
+{
+    int s, i, a, b, n_sites;
+    kmc_t *kmc;
+
+    error(lat->j1 > 0, 1, "kmc_init [kmc.c]",
+          "Rejection-free dynamics requires attractive bonds (J1<=0)");
+
+    kmc = (kmc_t *)malloc(sizeof(kmc_t));
+    error(kmc == NULL, 1, "kmc_init [kmc.c]", "Unable to allocate the dynamics");
+
+    n_sites = lat->n_sites;
+    kmc->lat = lat;
+    kmc->n_sites = n_sites;
+    kmc->n_class = 2 * (lat->n_nbrs + 1);
+
+    /*the missing neighbours along z point to the empty site n_sites*/
+    kmc->occupied_nbrs = (int *)malloc((n_sites + 1) * sizeof(int));
+    kmc->site_atom = (int *)malloc(n_sites * sizeof(int));
+    kmc->group = (int *)malloc(n_sites * sizeof(int));
+    kmc->where = (int *)malloc(n_sites * sizeof(int));
+    kmc->members = (int *)malloc(2 * kmc->n_class * n_sites * sizeof(int));
+
+    error(kmc->occupied_nbrs == NULL || kmc->site_atom == NULL || kmc->group == NULL ||
+              kmc->where == NULL || kmc->members == NULL,
+          1, "kmc_init [kmc.c]", "Unable to allocate the classes");
+
+    for (s = 0; s < n_sites; s++)
+        kmc->site_atom[s] = -1;
+
+    for (i = 0; i < lat->n_atoms; i++)
+        kmc->site_atom[lat->atom_site[i]] = i;
+
+    for (s = 0; s < n_sites; s++)
+        kmc->occupied_nbrs[s] = number_of_nbrs(lat, s);
+    kmc->occupied_nbrs[n_sites] = 0;
+
+    for (a = 0; a < 2 * kmc->n_class; a++)
+        kmc->population[a] = 0;
+
+    for (s = 0; s < n_sites; s++)
+        insert_site(kmc, s, group_of(kmc, s));
+
+    for (a = 0; a < kmc->n_class; a++)
+        for (b = 0; b < kmc->n_class; b++)
+            kmc->rate[a][b] = acceptance_probability(lat, b / 2 - a / 2, b % 2 - a % 2);
+
+    kmc->time_elapsed = 0;
+
+    return kmc;
+}
+
+double kmc_step(kmc_t *kmc)
+{
+    int a, b, s, t, k, atom, adjacent, n_class, n_sites, n_nbrs, *nbr_s, *nbr_t;
+    int *population;
+    double r[6], weight[KMC_MAX_NCLASS], total, dt;
+    lattice_t *lat;
+
+    lat = kmc->lat;
+    n_class = kmc->n_class;
+    n_sites = kmc->n_sites;
+    population = kmc->population;
+
+    /*Total rate of the moves leaving each class of atoms*/
+    total = 0;
+
+    for (a = 0; a < n_class; a++)
+    {
+        weight[a] = 0;
+
+        if (population[a] != 0)
+        {
+            for (b = 0; b < n_class; b++)
+                weight[a] += population[n_class + b] * kmc->rate[a][b];
+            weight[a] *= population[a];
+        }
+
+        total += weight[a];
+    }
+
+    if (total == 0)
+        return -1;
+
+    for (k = 0; k < 6; k++)
+        r[k] = ranbuf_double(lat->rng);
+
+    /*Residence time in units of Metropolis moves*/
+    dt = -log(1 - r[0]) * ((double)lat->n_atoms * (n_sites - lat->n_atoms)) / total;
+    kmc->time_elapsed += dt;
+
+    /*Select the class of the atom, then the class of the empty site*/
+    a = select_interval(weight, n_class, r[1] * total);
+
+    total = 0;
+    for (b = 0; b < n_class; b++)
+    {
+        weight[b] = population[n_class + b] * kmc->rate[a][b];
+        total += weight[b];
+    }
+
+    b = select_interval(weight, n_class, r[2] * total);
+
+    /*Select the atom and the empty site within their classes*/
+    s = kmc->members[a * n_sites + (int)(r[3] * population[a])];
+    t = kmc->members[(n_class + b) * n_sites + (int)(r[4] * population[n_class + b])];
+
+    n_nbrs = lat->n_nbrs;
+    nbr_s = lat->nbrs + n_nbrs * s;
+    nbr_t = lat->nbrs + n_nbrs * t;
+
+    adjacent = 0;
+    for (k = 0; k < n_nbrs; k++)
+        if (nbr_s[k] == t)
+            adjacent = 1;
+
+    /*The atom itself is one of the neighbours of t: one bond less*/
+    if (adjacent)
+        if (r[5] * kmc->rate[a][b] >=
+            acceptance_probability(lat, b / 2 - a / 2 - 1, b % 2 - a % 2))
+            return dt;
+
+    /*Move the atom from s to t*/
+    atom = kmc->site_atom[s];
+    lat->occupation[s] = 0;
+    lat->occupation[t] = 1;
+    kmc->site_atom[s] = -1;
+    kmc->site_atom[t] = atom;
+    lat->atom_site[atom] = t;
+
+    for (k = 0; k < n_nbrs; k++)
+        kmc->occupied_nbrs[nbr_s[k]]--;
+    for (k = 0; k < n_nbrs; k++)
+        kmc->occupied_nbrs[nbr_t[k]]++;
+
+    update_group(kmc, s);
+    update_group(kmc, t);
+    for (k = 0; k < n_nbrs; k++)
+        update_group(kmc, nbr_s[k]);
+    for (k = 0; k < n_nbrs; k++)
+        update_group(kmc, nbr_t[k]);
+
+    return dt;
+}
+
+double kmc_time(kmc_t *kmc)
+{
+    return kmc->time_elapsed;
+}
+
+void kmc_free(kmc_t *kmc)
+{
+    free(kmc->occupied_nbrs);
+    free(kmc->site_atom);
+    free(kmc->group);
+    free(kmc->where);
+    free(kmc->members);
+    free(kmc);
+}
@@ -1,39 +1,128 @@
-
 /*******************************************************************************
  *
  * Library montecarlo.c
  *
+ * Lattice gas in two or three dimensions. The size of the lattice, the
+ * number of atoms, the couplings and the temperature are chosen at run time
+ * and stored in a lattice_t (see montecarlo.h), which is passed to all the
+ * functions below. The sites are stored in a flat array with a table of
+ * neighbours, so that the same code serves both dimensions. Every lattice
+ * has its own buffered generator (ranbuf.c), hence independent lattices can
+ * be evolved at the same time.
+ *
  * The externally accessible functions are:
  *
+ * void default_parameters(parameters_t *par)
+ *  Sets the parameters to the defaults of global.h, with the seed taken
+ *  from the clock.
+ *
+ * void read_parameters(int argc, char *argv[], parameters_t *par)
+ *  Sets the parameters to the defaults and overrides them with the command
+ *  line arguments NAME=value, where NAME is one of DIM, LX, LY, LZ, N, J0,
+ *  J1, T, N_SWEEP, N_TERM, N_REPLICAS, T_MIN, T_MAX, SWAP_INTERVAL,
+ *  SAMPLE_INTERVAL, RAW_OUTPUT, OUTPUT, STRIDE, LOG_F_FINAL, FLATNESS,
+ *  SCHEDULE, HOP_FRACTION and SEED. A bare integer is taken as the seed.
+ *  A value with trailing characters (e.g. LX=12abc) is an error.
+ *
+ * lattice_t *new_lattice(parameters_t *par)
+ *  Allocates a lattice with the given parameters, evaluates the list of
+ *  neighbours and the acceptance table. The lattice is empty until
+ *  init_configuration() is called.
+ *
+ * void free_lattice(lattice_t *lat)
+ *  Frees the lattice.
+ *
  * double powerd(double x, int y)
  *  Calculates x^y, faster then matt.h pow.
  *
- * void init_configuration()
- *  Initialized thee configuration with random initial positions.
+ * void eval_list_nbrs(lattice_t *lat)
+ *  Calculates the neighbours of each site (called by new_lattice()).
  *
- * void eval_list_nbrs()
- *  Calculates the coordinate of neighbours of each cell.
+ * void init_configuration(lattice_t *lat)
+ *  Initializes the generator of the lattice with its seed and the
+ *  configuration with random initial positions.
  *
- * void print_configuration(char file_name[])
+ * void init_configuration_first_layer(lattice_t *lat)
+ *  As init_configuration(), with all the atoms in the first layer.
+ *
+ * void print_configuration(lattice_t *lat, char file_name[])
  *  Print the coordinates of all atom in file_name.
  *
- * double eval_E()
+ * int number_of_nbrs(lattice_t *lat, int s)
+ *  Number of occupied neighbours of the site s.
+ *
+ * double eval_E(lattice_t *lat)
  *  Evaluates the energy of the system.
  *
- * double mean_number_of_nbrs()
+ * double mean_number_of_nbrs(lattice_t *lat)
  *  Evaluates the mean number of neighbours over all the atoms.
  *
- * void sweep()
- *  Perform a sweep (a Metropolis-Montecarlo move).
+ * int count_first_layer(lattice_t *lat)
+ *  Counts the number of atom in the lowest layer (0 in two dimensions).
+ *
+ * void set_temperature(lattice_t *lat, double t)
+ *  Sets the temperature and evaluates the acceptance table.
+ *
+ * double acceptance_probability(lattice_t *lat, int delta_bonds,
+ *                               int delta_substrate)
+ *  Metropolis acceptance probability of a move that changes the number of
+ *  bonds by delta_bonds and the atoms on the substrate by delta_substrate.
+ *
+ * int random_move(lattice_t *lat, int *s_old, int *delta_bonds,
+ *                 int *delta_substrate)
+ *  Moves a random atom to a random empty site and returns its index. On
+ *  exit *s_old is the previous site of the atom and *delta_bonds,
+ *  *delta_substrate the changes of the number of bonds and of the atoms on
+ *  the substrate.
+ *
+ * void undo_move(lattice_t *lat, int atom, int s_old)
+ *  Moves the atom back to the site s_old (rejection of random_move()).
+ *
+ * int teleport(lattice_t *lat)
+ *  Metropolis move of a random atom to a random empty site (random_move()).
+ *  Returns 1 if the move is accepted, 0 otherwise.
+ *
+ * int local_hop(lattice_t *lat)
+ *  Metropolis move of a random atom to a random neighbouring site (a
+ *  Kawasaki hop). Hops to occupied sites or through the walls are rejected.
+ *  Returns 1 if the move is accepted, 0 otherwise.
+ *
+ * void sweep(lattice_t *lat)
+ *  Perform a sweep (a Metropolis-Montecarlo move): a local_hop() with
+ *  probability hop_fraction, a teleport() otherwise, and updates the
+ *  counts of proposed and accepted moves of the lattice. The energy
+ *  difference is obtained locally from the change in the number of bonds
+ *  and of substrate contacts, and the acceptance probability is read from
+ *  the table. With hop_fraction = 0 no random number is spent on the choice.
+ *
+ * void set_hop_fraction(lattice_t *lat, double hop_fraction)
+ *  Sets the probability of a local hop in sweep().
  *
- * void thermalization(char file_name[]);
- *  Thermalizes the system and saves the energy in file_name.
+ * double acceptance_rate(lattice_t *lat, int move_type)
+ *  Fraction of the moves of type MOVE_TELEPORT or MOVE_HOP accepted since
+ *  the last initialization of the configuration.
  *
- * number_of_nbrs(int i, int j, int k)
- *  Number of neighbours of the cell (i,j,k).
+ * void parallel_sweep(lattice_t *lat)
+ *  Performs a hop attempt to a random neighbouring site for every atom. The
+ *  lattice is split along x in strips at least MIN_STRIP_WIDTH wide, shifted
+ *  by a random offset; even and odd strips are updated in turn, the strips
+ *  of a phase are shared among the threads and hops that leave a strip are
+ *  rejected. The random numbers of a hop are drawn from the counter-based
+ *  generator with key (seed,0) and counter (atom,step), so results depend
+ *  only on the seed and are the same for any number of threads. Cannot be
+ *  called from within a parallel region.
  *
- * count_first_layer()
- *  Counts the number of atom in the lowest layer.
+ * void thermalization(lattice_t *lat, int n_term, char file_name[])
+ *  Initializes the configuration, performs n_term sweeps and saves the
+ *  energy in file_name, in the format and with the stride of the lattice.
+ *
+ * void thermalization_first_layer(lattice_t *lat, int n_term,
+ *                                 char file_name[])
+ *  As thermalization(), starting from init_configuration_first_layer().
+ *
+ * When compiled with -DPERFCOUNT the hardware counters of the sweeps of
+ * the thermalization are read through the macros of perfcount.h, hence it
+ * must then be called outside parallel regions.
  *
  * Author: Lorenzo Tasca
  *
@@ -41,12 +130,207 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 #include <assert.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "global.h"
 #include "random.h"
+#include "start.h"
+#include "obstream.h"
 #include "montecarlo.h"
+#include "perfcount.h"
+
+#define MAX_NBRS 6
+#define MIN_STRIP_WIDTH 8
+
+void default_parameters(parameters_t *par)
+{
+    par->dim = DIM;
+    par->lx = LX;
+    par->ly = LY;
+    par->lz = LZ;
+    par->n_atoms = N;
+    par->n_sweep = N_SWEEP;
+    par->n_term = N_TERM;
+    par->seed = time(NULL);
+    par->n_replicas = N_REPLICAS;
+    par->t_min = T_MIN;
+    par->t_max = T_MAX;
+    par->swap_interval = SWAP_INTERVAL;
+    par->sample_interval = SAMPLE_INTERVAL;
+    par->raw_output = RAW_OUTPUT;
+    par->output = OUTPUT;
+    par->stride = STRIDE;
+    par->hop_fraction = HOP_FRACTION;
+    par->schedule = SCHEDULE;
+    par->log_f_final = LOG_F_FINAL;
+    par->flatness = FLATNESS;
+    par->j0 = J0;
+    par->j1 = J1;
+    par->temperature = T;
+}
+
+/*
+ * Reads an integer (a double) from the whole string value, returns 1 on
+ * success and 0 if the string is malformed or has trailing characters
+ */
+static int read_int(char value[], int *x)
+{
+    int n;
+
+    return sscanf(value, "%d%n", x, &n) == 1 && value[n] == '\0';
+}
+
+static int read_double(char value[], double *x)
+{
+    int n;
+
+    return sscanf(value, "%lf%n", x, &n) == 1 && value[n] == '\0';
+}
+
+void read_parameters(int argc, char *argv[], parameters_t *par)
+{
+    int i, n;
+    char *value;
+
+    default_parameters(par);
+
+    for (i = 1; i < argc; i++)
+    {
+        value = strchr(argv[i], '=');
+
+        if (value == NULL)
+        {
+            error(!read_int(argv[i], &par->seed), 1, "read_parameters [montecarlo.c]",
+                  "Arguments are a seed or NAME=value");
+            continue;
+        }
+
+        value++;
+
+        if (strncmp(argv[i], "DIM=", 4) == 0)
+            n = read_int(value, &par->dim);
+        else if (strncmp(argv[i], "LX=", 3) == 0)
+            n = read_int(value, &par->lx);
+        else if (strncmp(argv[i], "LY=", 3) == 0)
+            n = read_int(value, &par->ly);
+        else if (strncmp(argv[i], "LZ=", 3) == 0)
+            n = read_int(value, &par->lz);
+        else if (strncmp(argv[i], "N=", 2) == 0)
+            n = read_int(value, &par->n_atoms);
+        else if (strncmp(argv[i], "N_SWEEP=", 8) == 0)
+            n = read_int(value, &par->n_sweep);
+        else if (strncmp(argv[i], "N_TERM=", 7) == 0)
+            n = read_int(value, &par->n_term);
+        else if (strncmp(argv[i], "N_REPLICAS=", 11) == 0)
+            n = read_int(value, &par->n_replicas);
+        else if (strncmp(argv[i], "T_MIN=", 6) == 0)
+            n = read_double(value, &par->t_min);
+        else if (strncmp(argv[i], "T_MAX=", 6) == 0)
+            n = read_double(value, &par->t_max);
+        else if (strncmp(argv[i], "SWAP_INTERVAL=", 14) == 0)
+            n = read_int(value, &par->swap_interval);
+        else if (strncmp(argv[i], "SAMPLE_INTERVAL=", 16) == 0)
+            n = read_int(value, &par->sample_interval);
+        else if (strncmp(argv[i], "RAW_OUTPUT=", 11) == 0)
+            n = read_int(value, &par->raw_output);
+        else if (strncmp(argv[i], "OUTPUT=", 7) == 0)
+            n = read_int(value, &par->output);
+        else if (strncmp(argv[i], "STRIDE=", 7) == 0)
+            n = read_int(value, &par->stride);
+        else if (strncmp(argv[i], "SCHEDULE=", 9) == 0)
+            n = read_int(value, &par->schedule);
+        else if (strncmp(argv[i], "LOG_F_FINAL=", 12) == 0)
+            n = read_double(value, &par->log_f_final);
+        else if (strncmp(argv[i], "FLATNESS=", 9) == 0)
+            n = read_double(value, &par->flatness);
+        else if (strncmp(argv[i], "HOP_FRACTION=", 13) == 0)
+            n = read_double(value, &par->hop_fraction);
+        else if (strncmp(argv[i], "SEED=", 5) == 0)
+            n = read_int(value, &par->seed);
+        else if (strncmp(argv[i], "J0=", 3) == 0)
+            n = read_double(value, &par->j0);
+        else if (strncmp(argv[i], "J1=", 3) == 0)
+            n = read_double(value, &par->j1);
+        else if (strncmp(argv[i], "T=", 2) == 0)
+            n = read_double(value, &par->temperature);
+        else
+            n = 0;
+
+        error(n != 1, 1, "read_parameters [montecarlo.c]", "Unknown or malformed parameter");
+    }
+}
+
+lattice_t *new_lattice(parameters_t *par)
+{
+    lattice_t *lat;
+
+    error(par->dim != 2 && par->dim != 3, 1, "new_lattice [montecarlo.c]",
+          "The dimension must be 2 or 3");
+    error(par->lx < 1 || par->ly < 1 || (par->dim == 3 && par->lz < 1), 1,
+          "new_lattice [montecarlo.c]", "Bad lattice size");
+
+    lat = (lattice_t *)malloc(sizeof(lattice_t));
+    error(lat == NULL, 1, "new_lattice [montecarlo.c]", "Unable to allocate the lattice");
+
+    lat->dim = par->dim;
+    lat->lx = par->lx;
+    lat->ly = par->ly;
+    lat->lz = (par->dim == 3) ? par->lz : 1;
+    lat->n_sites = lat->lx * lat->ly * lat->lz;
+    lat->n_atoms = par->n_atoms;
+    lat->n_nbrs = 2 * par->dim;
+    lat->seed = par->seed;
+    lat->output = par->output;
+    lat->stride = par->stride;
+    lat->j0 = par->j0;
+    lat->j1 = par->j1;
+    lat->step = 0;
+
+    error(lat->n_atoms < 1 || lat->n_atoms >= lat->n_sites, 1, "new_lattice [montecarlo.c]",
+          "The number of atoms must be positive and smaller than the number of sites");
+
+    lat->occupation = (short *)calloc(lat->n_sites + 1, sizeof(short));
+    lat->nbrs = (int *)malloc(lat->n_nbrs * lat->n_sites * sizeof(int));
+    lat->substrate = (char *)calloc(lat->n_sites + 1, sizeof(char));
+    lat->atom_site = (int *)malloc(lat->n_atoms * sizeof(int));
+    lat->atom_strip = (int *)malloc(lat->n_atoms * sizeof(int));
+    lat->strip_atoms = (int *)malloc(lat->n_atoms * sizeof(int));
+    lat->strip_start = (int *)malloc((lat->lx + 1) * sizeof(int));
+    lat->rng = (ranbuf_t *)malloc(sizeof(ranbuf_t));
+
+    error(lat->occupation == NULL || lat->nbrs == NULL || lat->substrate == NULL ||
+              lat->atom_site == NULL || lat->atom_strip == NULL || lat->strip_atoms == NULL ||
+              lat->strip_start == NULL || lat->rng == NULL,
+          1, "new_lattice [montecarlo.c]", "Unable to allocate the lattice");
+
+    eval_list_nbrs(lat);
+    set_temperature(lat, par->temperature);
+    set_hop_fraction(lat, par->hop_fraction);
+    ranbuf_init(lat->rng, 1, lat->seed);
+    lat->number_strips = 0;
+    lat->strip_width = 0;
+    lat->strip_offset = 0;
+
+    return lat;
+}
+
+void free_lattice(lattice_t *lat)
+{
+    free(lat->occupation);
+    free(lat->nbrs);
+    free(lat->substrate);
+    free(lat->atom_site);
+    free(lat->atom_strip);
+    free(lat->strip_atoms);
+    free(lat->strip_start);
+    free(lat->rng);
+    free(lat);
+}
 
 double powerd(double x, int y)
 {
@@ -67,516 +351,491 @@ double powerd(double x, int y)
     }
 }
 
-#ifdef DIM2
-
-void init_configuration()
+void eval_list_nbrs(lattice_t *lat)
 {
-    int i, j, x, y;
-    double r;
-
-    eval_list_nbrs();
+    int s, x, y, z, lx, ly, lz, *nbr;
 
-    rlxd_init(1, seed);
+    lx = lat->lx;
+    ly = lat->ly;
+    lz = lat->lz;
 
-    for (i = 0; i < LX; i++)
-        for (j = 0; j < LY; j++)
-            occupation_matrix[i][j] = 0;
-
-    i = 0;
-
-    while (i < N)
+    for (x = 0; x < lx; x++)
     {
-        ranlxd(&r, 1);
-        x = (int)(r * LX);
-        ranlxd(&r, 1);
-        y = (int)(r * LY);
-
-        assert(x < LX);
-        assert(y < LY);
-
-        if (occupation_matrix[x][y] == 0)
+        for (y = 0; y < ly; y++)
         {
-            occupation_matrix[x][y] = 1;
-            atom_position[i][0] = x;
-            atom_position[i][1] = y;
-            i++;
+            for (z = 0; z < lz; z++)
+            {
+                s = (x * ly + y) * lz + z;
+                nbr = lat->nbrs + lat->n_nbrs * s;
+
+                nbr[0] = (((x - 1 + lx) % lx) * ly + y) * lz + z; /*left*/
+                nbr[1] = (((x + 1) % lx) * ly + y) * lz + z;      /*right*/
+                nbr[2] = (x * ly + (y + 1) % ly) * lz + z;        /*up*/
+                nbr[3] = (x * ly + (y - 1 + ly) % ly) * lz + z;   /*down*/
+
+                if (lat->dim == 3)
+                {
+                    /*no PBC along z, the missing neighbours are the empty site*/
+                    nbr[4] = (z < lz - 1) ? s + 1 : lat->n_sites; /*top*/
+                    nbr[5] = (z > 0) ? s - 1 : lat->n_sites;      /*bottom*/
+                    lat->substrate[s] = (z == 0);
+                }
+            }
         }
     }
 }
 
-void eval_list_nbrs()
+static void eval_acceptance(lattice_t *lat)
 {
-    int i, j;
+    int db, ds;
+    double dE;
 
-    for (i = 0; i < LX; i++)
+    for (db = -MAX_NBRS; db <= MAX_NBRS; db++)
     {
-        for (j = 0; j < LY; j++)
+        for (ds = -1; ds <= 1; ds++)
         {
-            left_nbrs[i][j][0] = (i - 1 + LX) % LX;
-            left_nbrs[i][j][1] = j;
-            right_nbrs[i][j][0] = (i + 1 + LX) % LX;
-            right_nbrs[i][j][1] = j;
-            up_nbrs[i][j][0] = i;
-            up_nbrs[i][j][1] = (j + 1 + LY) % LY;
-            down_nbrs[i][j][0] = i;
-            down_nbrs[i][j][1] = (j - 1 + LY) % LY;
+            dE = lat->j1 * db + lat->j0 * ds;
+
+            if (dE < 1e-8) /*E_new <= E_old*/
+                lat->acceptance[db + MAX_NBRS][ds + 1] = 1;
+            else if (lat->temperature == 0)
+                lat->acceptance[db + MAX_NBRS][ds + 1] = 0;
+            else
+                lat->acceptance[db + MAX_NBRS][ds + 1] = exp(-dE / (KB * lat->temperature));
+
+            /*r < p if and only if 2^48*r < ceil(2^48*p)*/
+            lat->threshold[db + MAX_NBRS][ds + 1] =
+                (long long)ceil(lat->acceptance[db + MAX_NBRS][ds + 1] / RANBUF_ONE_BIT);
         }
     }
 }
 
-void print_configuration(char file_name[])
+void set_temperature(lattice_t *lat, double t)
 {
-    int i;
-    FILE *fd;
-
-    fd = fopen(file_name, "w");
+    error(t < 0, 1, "set_temperature [montecarlo.c]", "Negative temperature");
 
-    for (i = 0; i < N; i++)
-        fprintf(fd, "%d %d\n", atom_position[i][0], atom_position[i][1]);
-
-    fclose(fd);
+    lat->temperature = t;
+    eval_acceptance(lat);
 }
 
-int number_of_nbrs(int i, int j)
+double acceptance_probability(lattice_t *lat, int delta_bonds, int delta_substrate)
 {
-    return occupation_matrix[left_nbrs[i][j][0]][left_nbrs[i][j][1]] +
-           occupation_matrix[right_nbrs[i][j][0]][right_nbrs[i][j][1]] +
-           occupation_matrix[up_nbrs[i][j][0]][up_nbrs[i][j][1]] +
-           occupation_matrix[down_nbrs[i][j][0]][down_nbrs[i][j][1]];
+    assert(abs(delta_bonds) <= lat->n_nbrs && abs(delta_substrate) <= 1);
+
+    return lat->acceptance[delta_bonds + MAX_NBRS][delta_substrate + 1];
 }
 
-double eval_E()
+static int count_nbrs(const short *occupation, const int *nbr, int n_nbrs)
 {
-    int i;
-    double E;
+    int count;
 
-    E = 0;
+    count = occupation[nbr[0]] + occupation[nbr[1]] + occupation[nbr[2]] + occupation[nbr[3]];
 
-    for (i = 0; i < N; i++)
-        E += 0.5 * J1 * number_of_nbrs(atom_position[i][0], atom_position[i][1]);
+    if (n_nbrs == 6)
+        count += occupation[nbr[4]] + occupation[nbr[5]];
 
-    return E;
+    return count;
 }
 
-double mean_number_of_nbrs()
+int number_of_nbrs(lattice_t *lat, int s)
 {
-    int i;
-    double mean;
-
-    mean = 0;
-
-    for (i = 0; i < N; i++)
-        mean += number_of_nbrs(atom_position[i][0], atom_position[i][1]);
-
-    mean /= (double)N;
-
-    return mean;
+    return count_nbrs(lat->occupation, lat->nbrs + lat->n_nbrs * s, lat->n_nbrs);
 }
 
-void sweep()
+static void place_atoms(lattice_t *lat, int first_layer)
 {
-    int x, y, atom, x_old, y_old;
-    double r, E_old;
+    int i, s, x, y, z;
 
-    /*Select a random atom*/
-    ranlxd(&r, 1);
-    atom = (int)(r * N);
-    assert(atom < N);
-
-    x_old = atom_position[atom][0];
-    y_old = atom_position[atom][1];
-    E_old = eval_E();
+    ranbuf_init(lat->rng, 1, lat->seed);
+    lat->step = 0;
 
-    /*Move the atom to a new random empty slot*/
-    while (1) /*repeat until it finds an empty slot*/
+    for (i = 0; i < N_MOVE_TYPES; i++)
     {
-        ranlxd(&r, 1);
-        x = (int)(r * LX);
-        ranlxd(&r, 1);
-        y = (int)(r * LY);
-
-        if (occupation_matrix[x][y] == 0)
-        {
-            occupation_matrix[x][y] = 1;
-            occupation_matrix[x_old][y_old] = 0;
-            atom_position[atom][0] = x;
-            atom_position[atom][1] = y;
-            break;
-        }
+        lat->n_proposed[i] = 0;
+        lat->n_accepted[i] = 0;
     }
 
-    if (eval_E() - E_old < 1e-8) /*E_new <= E_old*/
-    {
-        /*accepts the new configuration*/
-        return;
-    }
-    else /*E_new > E_old*/
+    for (s = 0; s <= lat->n_sites; s++)
+        lat->occupation[s] = 0;
+
+    i = 0;
+
+    while (i < lat->n_atoms)
     {
-        if (T == 0)
-        {
-            /*rejects the new configuration*/
-            occupation_matrix[x][y] = 0;
-            occupation_matrix[x_old][y_old] = 1;
-            atom_position[atom][0] = x_old;
-            atom_position[atom][1] = y_old;
-            return;
-        }
-        else /*T not 0*/
+        x = ranbuf_index(lat->rng, lat->lx);
+        y = ranbuf_index(lat->rng, lat->ly);
+        z = 0;
+        if (lat->dim == 3 && !first_layer)
+            z = ranbuf_index(lat->rng, lat->lz);
+
+        s = (x * lat->ly + y) * lat->lz + z;
+
+        if (lat->occupation[s] == 0)
         {
-            ranlxd(&r, 1);
-            if (r < exp((E_old - eval_E()) / (KB * T)))
-            {
-                /*accepts the new configuration*/
-                return;
-            }
-            else
-            {
-                /*rejects the new configuration*/
-                occupation_matrix[x][y] = 0;
-                occupation_matrix[x_old][y_old] = 1;
-                atom_position[atom][0] = x_old;
-                atom_position[atom][1] = y_old;
-                return;
-            }
+            lat->occupation[s] = 1;
+            lat->atom_site[i] = s;
+            i++;
         }
     }
 }
 
-void thermalization(char file_name[])
+void init_configuration(lattice_t *lat)
 {
-    int i;
+    place_atoms(lat, 0);
+}
+
+void init_configuration_first_layer(lattice_t *lat)
+{
+    error(lat->dim != 3, 1, "init_configuration_first_layer [montecarlo.c]",
+          "Only defined in three dimensions");
+
+    place_atoms(lat, 1); /*forcing the atoms to be in the first layer*/
+}
+
+void print_configuration(lattice_t *lat, char file_name[])
+{
+    int i, s;
     FILE *fd;
 
     fd = fopen(file_name, "w");
 
-    eval_list_nbrs();
-    init_configuration();
-
-    for (i = 0; i < N_TERM; i++)
+    for (i = 0; i < lat->n_atoms; i++)
     {
-        fprintf(fd, "%.15e\n", eval_E());
-        sweep();
+        s = lat->atom_site[i];
+
+        if (lat->dim == 2)
+            fprintf(fd, "%d %d\n", s / lat->ly, s % lat->ly);
+        else
+            fprintf(fd, "%d %d %d\n", s / (lat->ly * lat->lz), (s / lat->lz) % lat->ly,
+                    s % lat->lz);
     }
 
     fclose(fd);
 }
 
-#endif /*DIM2*/
+double eval_E(lattice_t *lat)
+{
+    int i, s;
+    double E;
+
+    E = 0;
+
+    for (i = 0; i < lat->n_atoms; i++)
+    {
+        s = lat->atom_site[i];
+        E += 0.5 * lat->j1 * number_of_nbrs(lat, s);
 
-/*=============================================================================*/
+        if (lat->substrate[s]) /*J0 energy for bottom layer*/
+            E += lat->j0;
+    }
 
-#ifdef DIM3
+    return E;
+}
 
-void init_configuration()
+double mean_number_of_nbrs(lattice_t *lat)
 {
-    int i, j, k, x, y, z;
-    double r;
+    int i;
+    double mean;
 
-    eval_list_nbrs();
+    mean = 0;
 
-    rlxd_init(1, seed);
+    for (i = 0; i < lat->n_atoms; i++)
+        mean += number_of_nbrs(lat, lat->atom_site[i]);
 
-    for (i = 0; i < LX; i++)
-        for (j = 0; j < LY; j++)
-            for (k = 0; k < LZ; k++)
-                occupation_matrix[i][j][k] = 0;
+    mean /= (double)lat->n_atoms;
 
-    i = 0;
+    return mean;
+}
 
-    while (i < N)
-    {
-        ranlxd(&r, 1);
-        x = (int)(r * LX);
-        ranlxd(&r, 1);
-        y = (int)(r * LY);
-        ranlxd(&r, 1);
-        z = (int)(r * LZ);
+int count_first_layer(lattice_t *lat)
+{
+    int count, i;
 
-        assert(x < LX);
-        assert(y < LY);
+    count = 0;
 
-        if (occupation_matrix[x][y][z] == 0)
-        {
-            occupation_matrix[x][y][z] = 1;
-            atom_position[i][0] = x;
-            atom_position[i][1] = y;
-            atom_position[i][2] = z;
-            i++;
-        }
-    }
+    for (i = 0; i < lat->n_atoms; i++)
+        if (lat->substrate[lat->atom_site[i]])
+            count++;
+
+    return count;
 }
 
-void init_configuration_first_layer()
+int random_move(lattice_t *lat, int *s_old, int *delta_bonds, int *delta_substrate)
 {
-    int i, j, k, x, y, z;
-    double r;
+    int s, atom, x, y, z;
+    short *occupation;
+    ranbuf_t *rng;
 
-    eval_list_nbrs();
+    occupation = lat->occupation;
+    rng = lat->rng;
 
-    rlxd_init(1, seed);
-
-    for (i = 0; i < LX; i++)
-        for (j = 0; j < LY; j++)
-            for (k = 0; k < LZ; k++)
-                occupation_matrix[i][j][k] = 0;
+    /*Select a random atom*/
+    atom = ranbuf_index(rng, lat->n_atoms);
 
-    i = 0;
+    *s_old = lat->atom_site[atom];
+    *delta_bonds = -number_of_nbrs(lat, *s_old);
 
-    while (i < N)
+    /*Move the atom to a new random empty slot*/
+    while (1) /*repeat until it finds an empty slot*/
     {
-        ranlxd(&r, 1);
-        x = (int)(r * LX);
-        ranlxd(&r, 1);
-        y = (int)(r * LY);
-        z = 0; /*forcing the atoms to be in the first layer*/
-        assert(x < LX);
-        assert(y < LY);
-
-        if (occupation_matrix[x][y][z] == 0)
+        x = ranbuf_index(rng, lat->lx);
+        y = ranbuf_index(rng, lat->ly);
+        z = 0;
+        if (lat->dim == 3)
+            z = ranbuf_index(rng, lat->lz);
+
+        s = (x * lat->ly + y) * lat->lz + z;
+
+        if (occupation[s] == 0)
         {
-            occupation_matrix[x][y][z] = 1;
-            atom_position[i][0] = x;
-            atom_position[i][1] = y;
-            atom_position[i][2] = z;
-            i++;
+            occupation[s] = 1;
+            occupation[*s_old] = 0;
+            lat->atom_site[atom] = s;
+            break;
         }
     }
+
+    *delta_bonds += number_of_nbrs(lat, s);
+    *delta_substrate = lat->substrate[s] - lat->substrate[*s_old];
+
+    return atom;
 }
 
-void eval_list_nbrs()
+void undo_move(lattice_t *lat, int atom, int s_old)
 {
-    int i, j, k;
+    lat->occupation[lat->atom_site[atom]] = 0;
+    lat->occupation[s_old] = 1;
+    lat->atom_site[atom] = s_old;
+}
+
+/*
+ * Metropolis test of a move, without random numbers if it lowers the energy
+ * or at T = 0
+ */
+static int accept(lattice_t *lat, int delta_bonds, int delta_substrate)
+{
+    if (lat->acceptance[delta_bonds + MAX_NBRS][delta_substrate + 1] == 1) /*E_new <= E_old*/
+        return 1;
+
+    if (lat->temperature != 0)
+        return ranbuf_raw(lat->rng) < lat->threshold[delta_bonds + MAX_NBRS][delta_substrate + 1];
+
+    return 0;
+}
+
+int teleport(lattice_t *lat)
+{
+    int s_old, atom, delta_bonds, delta_substrate;
+
+    atom = random_move(lat, &s_old, &delta_bonds, &delta_substrate);
 
-    for (i = 0; i < LX; i++)
+    if (accept(lat, delta_bonds, delta_substrate))
     {
-        for (j = 0; j < LY; j++)
-        {
-            for (k = 0; k < LZ; k++)
-            {
-                left_nbrs[i][j][k][0] = (i - 1 + LX) % LX;
-                left_nbrs[i][j][k][1] = j;
-                left_nbrs[i][j][k][2] = k;
-                right_nbrs[i][j][k][0] = (i + 1 + LX) % LX;
-                right_nbrs[i][j][k][1] = j;
-                right_nbrs[i][j][k][2] = k;
-                up_nbrs[i][j][k][0] = i;
-                up_nbrs[i][j][k][1] = (j + 1 + LY) % LY;
-                up_nbrs[i][j][k][2] = k;
-                down_nbrs[i][j][k][0] = i;
-                down_nbrs[i][j][k][1] = (j - 1 + LY) % LY;
-                down_nbrs[i][j][k][2] = k;
-                top_nbrs[i][j][k][0] = i;
-                top_nbrs[i][j][k][1] = j;
-                top_nbrs[i][j][k][2] = k + 1; /*no PBC along z*/
-                bottom_nbrs[i][j][k][0] = i;
-                bottom_nbrs[i][j][k][1] = j;
-                bottom_nbrs[i][j][k][2] = k - 1; /*no PBC along z*/
-            }
-        }
+        /*accepts the new configuration*/
+        return 1;
     }
+
+    /*rejects the new configuration*/
+    undo_move(lat, atom, s_old);
+
+    return 0;
 }
 
-void print_configuration(char file_name[])
+int local_hop(lattice_t *lat)
 {
-    int i;
-    FILE *fd;
+    int s, s_new, atom, delta_bonds, delta_substrate;
 
-    fd = fopen(file_name, "w");
+    atom = ranbuf_index(lat->rng, lat->n_atoms);
+    s = lat->atom_site[atom];
+    s_new = lat->nbrs[lat->n_nbrs * s + ranbuf_int(lat->rng, lat->n_nbrs)];
 
-    for (i = 0; i < N; i++)
-        fprintf(fd, "%d %d %d\n", atom_position[i][0], atom_position[i][1], atom_position[i][2]);
+    if (s_new == lat->n_sites || lat->occupation[s_new] == 1)
+        return 0;
 
-    fclose(fd);
+    /*the atom itself is one of the neighbours of the new site*/
+    delta_bonds = number_of_nbrs(lat, s_new) - 1 - number_of_nbrs(lat, s);
+    delta_substrate = lat->substrate[s_new] - lat->substrate[s];
+
+    if (!accept(lat, delta_bonds, delta_substrate))
+        return 0;
+
+    lat->occupation[s_new] = 1;
+    lat->occupation[s] = 0;
+    lat->atom_site[atom] = s_new;
+
+    return 1;
 }
 
-int number_of_nbrs(int i, int j, int k)
-{
-    switch (k)
-    {
-    case 0: /*it has no bottom neighbour*/
-        return occupation_matrix[left_nbrs[i][j][k][0]][left_nbrs[i][j][k][1]][left_nbrs[i][j][k][2]] +
-               occupation_matrix[right_nbrs[i][j][k][0]][right_nbrs[i][j][k][1]][right_nbrs[i][j][k][2]] +
-               occupation_matrix[up_nbrs[i][j][k][0]][up_nbrs[i][j][k][1]][up_nbrs[i][j][k][2]] +
-               occupation_matrix[down_nbrs[i][j][k][0]][down_nbrs[i][j][k][1]][down_nbrs[i][j][k][2]] +
-               occupation_matrix[top_nbrs[i][j][k][0]][top_nbrs[i][j][k][1]][top_nbrs[i][j][k][2]];
-
-    case LZ - 1: /*it has no top neighbours*/
-        return occupation_matrix[left_nbrs[i][j][k][0]][left_nbrs[i][j][k][1]][left_nbrs[i][j][k][2]] +
-               occupation_matrix[right_nbrs[i][j][k][0]][right_nbrs[i][j][k][1]][right_nbrs[i][j][k][2]] +
-               occupation_matrix[up_nbrs[i][j][k][0]][up_nbrs[i][j][k][1]][up_nbrs[i][j][k][2]] +
-               occupation_matrix[down_nbrs[i][j][k][0]][down_nbrs[i][j][k][1]][down_nbrs[i][j][k][2]] +
-               occupation_matrix[bottom_nbrs[i][j][k][0]][bottom_nbrs[i][j][k][1]][bottom_nbrs[i][j][k][2]];
-
-    default: /*is has both bottom and top neighbour*/
-        return occupation_matrix[left_nbrs[i][j][k][0]][left_nbrs[i][j][k][1]][left_nbrs[i][j][k][2]] +
-               occupation_matrix[right_nbrs[i][j][k][0]][right_nbrs[i][j][k][1]][right_nbrs[i][j][k][2]] +
-               occupation_matrix[up_nbrs[i][j][k][0]][up_nbrs[i][j][k][1]][up_nbrs[i][j][k][2]] +
-               occupation_matrix[down_nbrs[i][j][k][0]][down_nbrs[i][j][k][1]][down_nbrs[i][j][k][2]] +
-               occupation_matrix[top_nbrs[i][j][k][0]][top_nbrs[i][j][k][1]][top_nbrs[i][j][k][2]] +
-               occupation_matrix[bottom_nbrs[i][j][k][0]][bottom_nbrs[i][j][k][1]][bottom_nbrs[i][j][k][2]];
-    };
-}
-
-double eval_E()
+void sweep(lattice_t *lat)
 {
-    int i;
-    double E;
+    int type;
 
-    E = 0;
+    type = MOVE_TELEPORT;
+    if (lat->hop_threshold > 0 && ranbuf_raw(lat->rng) < lat->hop_threshold)
+        type = MOVE_HOP;
 
-    for (i = 0; i < N; i++)
-    {
-        E += 0.5 * J1 * number_of_nbrs(atom_position[i][0], atom_position[i][1], atom_position[i][2]);
+    lat->n_proposed[type] += 1;
+    lat->n_accepted[type] += (type == MOVE_HOP) ? local_hop(lat) : teleport(lat);
+}
 
-        if (atom_position[i][2] == 0) /*J0 energy for bottom layer*/
-            E += J0;
-    }
+void set_hop_fraction(lattice_t *lat, double hop_fraction)
+{
+    error(hop_fraction < 0 || hop_fraction > 1, 1, "set_hop_fraction [montecarlo.c]",
+          "The hop fraction must be in [0,1]");
 
-    return E;
+    lat->hop_fraction = hop_fraction;
+    lat->hop_threshold = (long long)ceil(hop_fraction / RANBUF_ONE_BIT);
 }
 
-double mean_number_of_nbrs()
+double acceptance_rate(lattice_t *lat, int move_type)
 {
-    int i;
-    double mean;
+    assert(move_type >= 0 && move_type < N_MOVE_TYPES);
 
-    mean = 0;
+    return (lat->n_proposed[move_type] > 0)
+               ? lat->n_accepted[move_type] / lat->n_proposed[move_type]
+               : 0;
+}
 
-    for (i = 0; i < N; i++)
-        mean += number_of_nbrs(atom_position[i][0], atom_position[i][1], atom_position[i][2]);
+static int strip_of(lattice_t *lat, int s)
+{
+    int k;
 
-    mean /= (double)N;
+    k = ((s / (lat->ly * lat->lz) - lat->strip_offset + lat->lx) % lat->lx) / lat->strip_width;
 
-    return mean;
+    return (k < lat->number_strips) ? k : lat->number_strips - 1;
 }
 
-void sweep()
+static void hop_move(lattice_t *lat, int atom)
 {
-    int x, y, z, atom, x_old, y_old, z_old;
-    double r, E_old;
+    int s, s_new, delta_bonds, delta_substrate;
+    long long r[2];
+    phx_state_t st;
 
-    /*Select a random atom*/
-    ranlxd(&r, 1);
-    atom = (int)(r * N);
-    assert(atom < N);
+    phx_init_r(&st, lat->seed, 0, atom, lat->step);
+    ranphx_raw_r(&st, r, 2);
+
+    s = lat->atom_site[atom];
+    s_new = lat->nbrs[lat->n_nbrs * s + (int)((r[0] * lat->n_nbrs) >> 48)];
 
-    x_old = atom_position[atom][0];
-    y_old = atom_position[atom][1];
-    z_old = atom_position[atom][2];
+    if (s_new == lat->n_sites) /*no PBC along z*/
+        return;
 
-    E_old = eval_E();
+    if (lat->occupation[s_new] == 1 || strip_of(lat, s_new) != lat->atom_strip[atom])
+        return;
 
-    /*Move the atom to a new random empty slot*/
-    while (1) /*repeat until it finds an empty slot*/
+    /*the atom itself is one of the neighbours of the new site*/
+    delta_bonds = number_of_nbrs(lat, s_new) - 1 - number_of_nbrs(lat, s);
+    delta_substrate = lat->substrate[s_new] - lat->substrate[s];
+
+    if (r[1] < lat->threshold[delta_bonds + MAX_NBRS][delta_substrate + 1])
     {
-        ranlxd(&r, 1);
-        x = (int)(r * LX);
-        ranlxd(&r, 1);
-        y = (int)(r * LY);
-        ranlxd(&r, 1);
-        z = (int)(r * LZ);
-
-        if (occupation_matrix[x][y][z] == 0)
-        {
-            occupation_matrix[x][y][z] = 1;
-            occupation_matrix[x_old][y_old][z_old] = 0;
-            atom_position[atom][0] = x;
-            atom_position[atom][1] = y;
-            atom_position[atom][2] = z;
-            break;
-        }
+        lat->occupation[s_new] = 1;
+        lat->occupation[s] = 0;
+        lat->atom_site[atom] = s_new;
     }
+}
 
-    if (eval_E() - E_old < 1e-8) /*E_new <= E_old*/
+void parallel_sweep(lattice_t *lat)
+{
+    int i, k;
+    long long r;
+    phx_state_t st;
+
+#ifdef _OPENMP
+    error(omp_in_parallel(), 1, "parallel_sweep [montecarlo.c]",
+          "Called from within a parallel region");
+#endif
+
+    lat->number_strips = 2 * (lat->lx / (2 * MIN_STRIP_WIDTH));
+    if (lat->number_strips < 2)
+        lat->number_strips = 2;
+    lat->strip_width = lat->lx / lat->number_strips;
+    error(lat->strip_width < 2, 1, "parallel_sweep [montecarlo.c]",
+          "The lattice is too small (LX must be at least 4)");
+
+    /*the index -1 is not an atom*/
+    phx_init_r(&st, lat->seed, 0, -1, lat->step);
+    ranphx_raw_r(&st, &r, 1);
+    lat->strip_offset = (int)((r * lat->lx) >> 48);
+
+    /*atoms sorted by strip, in increasing order within a strip*/
+    for (k = 0; k <= lat->number_strips; k++)
+        lat->strip_start[k] = 0;
+
+    for (i = 0; i < lat->n_atoms; i++)
     {
-        /*accepts the new configuration*/
-        return;
+        lat->atom_strip[i] = strip_of(lat, lat->atom_site[i]);
+        lat->strip_start[lat->atom_strip[i] + 1] += 1;
     }
-    else /*E_new > E_old*/
+
+    for (k = 0; k < lat->number_strips; k++)
+        lat->strip_start[k + 1] += lat->strip_start[k];
+
+    for (i = 0; i < lat->n_atoms; i++)
     {
-        if (T == 0)
-        {
-            /*rejects the new configuration*/
-            occupation_matrix[x][y][z] = 0;
-            occupation_matrix[x_old][y_old][z_old] = 1;
-            atom_position[atom][0] = x_old;
-            atom_position[atom][1] = y_old;
-            atom_position[atom][2] = z_old;
-
-            return;
-        }
-        else /*T not 0*/
-        {
-            ranlxd(&r, 1);
-            if (r < exp((E_old - eval_E()) / (KB * T)))
-            {
-                /*accepts the new configuration*/
-                return;
-            }
-            else
-            {
-                /*rejects the new configuration*/
-                occupation_matrix[x][y][z] = 0;
-                occupation_matrix[x_old][y_old][z_old] = 1;
-                atom_position[atom][0] = x_old;
-                atom_position[atom][1] = y_old;
-                atom_position[atom][2] = z_old;
-
-                return;
-            }
-        }
+        k = lat->atom_strip[i];
+        lat->strip_atoms[lat->strip_start[k]] = i;
+        lat->strip_start[k] += 1;
     }
-}
 
-void thermalization(char file_name[])
-{
-    int i;
-    FILE *fd;
+    for (k = lat->number_strips; k > 0; k--)
+        lat->strip_start[k] = lat->strip_start[k - 1];
+    lat->strip_start[0] = 0;
 
-    fd = fopen(file_name, "w");
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int j, p, phase, strip;
 
-    eval_list_nbrs();
-    init_configuration();
+        for (phase = 0; phase < 2; phase++)
+        {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (p = 0; p < lat->number_strips / 2; p++)
+            {
+                strip = 2 * p + phase;
 
-    for (i = 0; i < N_TERM; i++)
-    {
-        fprintf(fd, "%.15e\n", eval_E());
-        sweep();
+                for (j = lat->strip_start[strip]; j < lat->strip_start[strip + 1]; j++)
+                    hop_move(lat, lat->strip_atoms[j]);
+            }
+        }
     }
 
-    fclose(fd);
+    lat->step += 1;
 }
 
-void thermalization_first_layer(char file_name[])
+static void thermalize(lattice_t *lat, int n_term, char file_name[])
 {
-    int i;
-    FILE *fd;
-
-    fd = fopen(file_name, "w");
+    int i, types[1] = {OBS_DOUBLE};
+    char *names[1] = {"energy"};
+    double x[1];
+    obs_stream_t *s;
 
-    eval_list_nbrs();
-    init_configuration_first_layer();
+    s = obs_open(file_name, 1, names, types, lat->stride, lat->output);
+    PERF_START("thermalization");
 
-    for (i = 0; i < N_TERM; i++)
+    for (i = 0; i < n_term; i++)
     {
-        fprintf(fd, "%.15e\n", eval_E());
-        sweep();
+        x[0] = eval_E(lat);
+        obs_write(s, x);
+        sweep(lat);
     }
 
-    fclose(fd);
+    PERF_STOP("thermalization");
+
+    obs_close(s);
 }
 
-int count_first_layer()
+void thermalization(lattice_t *lat, int n_term, char file_name[])
 {
-    int count, i;
-
-    count = 0;
-
-    for (i = 0; i < N; i++)
-        if (atom_position[i][2] == 0)
-            count++;
-
-    return count;
+    init_configuration(lat);
+    thermalize(lat, n_term, file_name);
 }
 
-#endif /*DIM3*/
\ No newline at end of file
+void thermalization_first_layer(lattice_t *lat, int n_term, char file_name[])
+{
+    init_configuration_first_layer(lat);
+    thermalize(lat, n_term, file_name);
+}
@@ -0,0 +1,367 @@
+/*******************************************************************************
+ *
+ * Library obstream.c
+ *
+ * Time series of observables written one row per sample, either as text
+ * (one line per row, as np.loadtxt() expects) or in a typed binary format
+ * that costs no formatting and can be loaded without parsing (see
+ * data/obstream.py). Only one row every stride calls of obs_write() is kept.
+ *
+ * A binary file starts with the header
+ *
+ *  char magic[8]            "OBSTREAM"
+ *  int byte_order           0x01020304 in the byte order of the writer
+ *  int version              1
+ *  int n_columns, stride, format
+ *  n_columns times          char name[OBS_NAME_LENGTH], int type
+ *
+ * followed by the rows, with the columns packed in order (8 bytes for an
+ * OBS_DOUBLE, 4 bytes for an OBS_INT). With OBS_DELTA every row is stored
+ * as its difference from the previous one: the bitwise xor for doubles and
+ * the (wrapping) difference for integers, so that columns that do not
+ * change give zero. With OBS_RLE equal consecutive (encoded) rows are
+ * stored once, preceded by an int with the number of repetitions. Energy
+ * and numbers of neighbours change only on accepted moves, hence at low
+ * temperature most rows are repetitions of the previous one.
+ *
+ * The externally accessible functions are:
+ *
+ * obs_stream_t *obs_open(char file_name[], int n_columns, char *names[],
+ *                        int types[], int stride, int format)
+ *  Opens file_name for writing the columns names[0...n_columns-1] of types
+ *  types[0...n_columns-1] (OBS_DOUBLE or OBS_INT). format is OBS_TEXT or
+ *  OBS_BINARY, in the latter case possibly plus OBS_DELTA and OBS_RLE.
+ *
+ * void obs_write(obs_stream_t *s, double x[])
+ *  Counts a sample and, if the number of samples before it is a multiple
+ *  of the stride, writes the row x[0...n_columns-1] (integer columns are
+ *  converted with a cast).
+ *
+ * obs_stream_t *obs_open_read(char file_name[])
+ *  Opens a binary file for reading and reads its header.
+ *
+ * int obs_read(obs_stream_t *s, double x[])
+ *  Reads the next row in x[0...n_columns-1]. Returns 1 on success and 0 at
+ *  the end of the file.
+ *
+ * int obs_column(obs_stream_t *s, char name[])
+ *  Index of the column name (-1 if there is none).
+ *
+ * void obs_close(obs_stream_t *s)
+ *  Writes the pending run, if any, closes the file and frees the stream.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "start.h"
+#include "obstream.h"
+
+#define OBS_VERSION 1
+#define OBS_BYTE_ORDER 0x01020304
+
+static const char magic[8] = {'O', 'B', 'S', 'T', 'R', 'E', 'A', 'M'};
+
+static int column_size(int type)
+{
+    return (type == OBS_DOUBLE) ? 8 : 4;
+}
+
+static obs_stream_t *new_stream(void)
+{
+    obs_stream_t *s;
+
+    error(sizeof(int) != 4 || sizeof(double) != 8, 1, "new_stream [obstream.c]",
+          "The binary format requires 4-byte int and 8-byte double");
+
+    s = (obs_stream_t *)calloc(1, sizeof(obs_stream_t));
+    error(s == NULL, 1, "new_stream [obstream.c]", "Unable to allocate the stream");
+
+    return s;
+}
+
+static void set_row_size(obs_stream_t *s)
+{
+    int c;
+
+    s->row_size = 0;
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        error(s->type[c] != OBS_DOUBLE && s->type[c] != OBS_INT, 1, "set_row_size [obstream.c]",
+              "Unknown column type");
+        s->row_size += column_size(s->type[c]);
+    }
+}
+
+/*
+ * Applies (decode=0) or removes (decode=1) the delta coding of the row
+ * whose predecessor is s->prev, and updates s->prev
+ */
+static void delta(obs_stream_t *s, unsigned char row[], int decode)
+{
+    int c, k, offset;
+    unsigned int a, b;
+    unsigned char byte;
+
+    offset = 0;
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        if (s->type[c] == OBS_DOUBLE)
+        {
+            for (k = 0; k < 8; k++)
+            {
+                byte = row[offset + k];
+                row[offset + k] ^= s->prev[offset + k];
+                s->prev[offset + k] = decode ? row[offset + k] : byte;
+            }
+        }
+        else
+        {
+            memcpy(&a, row + offset, 4);
+            memcpy(&b, s->prev + offset, 4);
+
+            if (decode)
+            {
+                a += b;
+                memcpy(s->prev + offset, &a, 4);
+            }
+            else
+            {
+                memcpy(s->prev + offset, &a, 4);
+                a -= b;
+            }
+
+            memcpy(row + offset, &a, 4);
+        }
+
+        offset += column_size(s->type[c]);
+    }
+}
+
+static void flush_run(obs_stream_t *s)
+{
+    int run;
+
+    if (s->run == 0)
+        return;
+
+    run = (int)s->run;
+    fwrite(&run, sizeof(int), 1, s->fd);
+    fwrite(s->last, 1, s->row_size, s->fd);
+    s->run = 0;
+}
+
+obs_stream_t *obs_open(char file_name[], int n_columns, char *names[], int types[], int stride,
+                       int format)
+{
+    int c, header[5];
+    obs_stream_t *s;
+
+    error(n_columns < 1 || n_columns > OBS_MAX_COLUMNS || stride < 1, 1, "obs_open [obstream.c]",
+          "Bad number of columns or stride");
+    error((format & OBS_BINARY) == 0 && format != OBS_TEXT, 1, "obs_open [obstream.c]",
+          "Compression requires the binary format");
+
+    s = new_stream();
+    s->n_columns = n_columns;
+    s->stride = stride;
+    s->format = format;
+    s->writing = 1;
+
+    for (c = 0; c < n_columns; c++)
+    {
+        strncpy(s->name[c], names[c], OBS_NAME_LENGTH - 1);
+        s->type[c] = types[c];
+    }
+
+    set_row_size(s);
+
+    s->fd = fopen(file_name, (format & OBS_BINARY) ? "wb" : "w");
+    error(s->fd == NULL, 1, "obs_open [obstream.c]", "Unable to open the output file");
+
+    if (format & OBS_BINARY)
+    {
+        header[0] = OBS_BYTE_ORDER;
+        header[1] = OBS_VERSION;
+        header[2] = n_columns;
+        header[3] = stride;
+        header[4] = format;
+
+        fwrite(magic, 1, 8, s->fd);
+        fwrite(header, sizeof(int), 5, s->fd);
+
+        for (c = 0; c < n_columns; c++)
+        {
+            fwrite(s->name[c], 1, OBS_NAME_LENGTH, s->fd);
+            fwrite(s->type + c, sizeof(int), 1, s->fd);
+        }
+    }
+
+    return s;
+}
+
+void obs_write(obs_stream_t *s, double x[])
+{
+    int c, k, offset;
+    unsigned char row[8 * OBS_MAX_COLUMNS];
+
+    s->n_calls += 1;
+
+    if ((s->n_calls - 1) % s->stride != 0)
+        return;
+
+    s->n_rows += 1;
+
+    if (s->format == OBS_TEXT)
+    {
+        for (c = 0; c < s->n_columns; c++)
+        {
+            if (s->type[c] == OBS_DOUBLE)
+                fprintf(s->fd, (c == 0) ? "%.15e" : " %.15e", x[c]);
+            else
+                fprintf(s->fd, (c == 0) ? "%d" : " %d", (int)x[c]);
+        }
+
+        fprintf(s->fd, "\n");
+        return;
+    }
+
+    offset = 0;
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        if (s->type[c] == OBS_DOUBLE)
+            memcpy(row + offset, x + c, 8);
+        else
+        {
+            k = (int)x[c];
+            memcpy(row + offset, &k, 4);
+        }
+
+        offset += column_size(s->type[c]);
+    }
+
+    if (s->format & OBS_DELTA)
+        delta(s, row, 0);
+
+    if ((s->format & OBS_RLE) == 0)
+        fwrite(row, 1, s->row_size, s->fd);
+    else if (s->run > 0 && s->run < 2147483647L && memcmp(row, s->last, s->row_size) == 0)
+        s->run += 1;
+    else
+    {
+        flush_run(s);
+        memcpy(s->last, row, s->row_size);
+        s->run = 1;
+    }
+}
+
+obs_stream_t *obs_open_read(char file_name[])
+{
+    int c, header[5];
+    char m[8];
+    obs_stream_t *s;
+
+    s = new_stream();
+
+    s->fd = fopen(file_name, "rb");
+    error(s->fd == NULL, 1, "obs_open_read [obstream.c]", "Unable to open the input file");
+
+    error(fread(m, 1, 8, s->fd) != 8 || memcmp(m, magic, 8) != 0 ||
+              fread(header, sizeof(int), 5, s->fd) != 5,
+          1, "obs_open_read [obstream.c]", "Not an observable stream");
+    error(header[0] != OBS_BYTE_ORDER || header[1] != OBS_VERSION, 1,
+          "obs_open_read [obstream.c]", "Byte order or version of the file not supported");
+
+    s->n_columns = header[2];
+    s->stride = header[3];
+    s->format = header[4];
+
+    error(s->n_columns < 1 || s->n_columns > OBS_MAX_COLUMNS, 1, "obs_open_read [obstream.c]",
+          "Bad number of columns");
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        error(fread(s->name[c], 1, OBS_NAME_LENGTH, s->fd) != OBS_NAME_LENGTH ||
+                  fread(s->type + c, sizeof(int), 1, s->fd) != 1,
+              1, "obs_open_read [obstream.c]", "Truncated header");
+        s->name[c][OBS_NAME_LENGTH - 1] = '\0';
+    }
+
+    set_row_size(s);
+
+    return s;
+}
+
+int obs_read(obs_stream_t *s, double x[])
+{
+    int c, k, run, offset;
+    unsigned char row[8 * OBS_MAX_COLUMNS];
+
+    if (s->format & OBS_RLE)
+    {
+        if (s->run == 0)
+        {
+            if (fread(&run, sizeof(int), 1, s->fd) != 1)
+                return 0;
+
+            error(run < 1 || fread(s->last, 1, s->row_size, s->fd) != (size_t)s->row_size, 1,
+                  "obs_read [obstream.c]", "Truncated or corrupted file");
+            s->run = run;
+        }
+
+        memcpy(row, s->last, s->row_size);
+        s->run -= 1;
+    }
+    else if (fread(row, 1, s->row_size, s->fd) != (size_t)s->row_size)
+        return 0;
+
+    if (s->format & OBS_DELTA)
+        delta(s, row, 1);
+
+    offset = 0;
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        if (s->type[c] == OBS_DOUBLE)
+            memcpy(x + c, row + offset, 8);
+        else
+        {
+            memcpy(&k, row + offset, 4);
+            x[c] = k;
+        }
+
+        offset += column_size(s->type[c]);
+    }
+
+    s->n_rows += 1;
+
+    return 1;
+}
+
+int obs_column(obs_stream_t *s, char name[])
+{
+    int c;
+
+    for (c = 0; c < s->n_columns; c++)
+    {
+        if (strcmp(s->name[c], name) == 0)
+            return c;
+    }
+
+    return -1;
+}
+
+void obs_close(obs_stream_t *s)
+{
+    if (s->writing && (s->format & OBS_RLE))
+        flush_run(s);
+
+    fclose(s->fd);
+    free(s);
+}
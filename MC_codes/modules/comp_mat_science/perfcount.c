@@ -0,0 +1,284 @@
+/*******************************************************************************
+ *
+ * Library perfcount.c
+ *
+ * Hardware performance counters (Linux perf_event_open) around named
+ * regions of the code. In every region the cycles, instructions, L1 data
+ * cache read misses, last level cache misses, branches and branch misses
+ * of user space are counted, together with the task clock (CPU time), and
+ * perf_print() reports for each region the instructions per cycle, the
+ * cache misses per thousand instructions and the fraction of mispredicted
+ * branches. These tell whether a kernel is limited by the memory, by the
+ * branches or by the arithmetic.
+ *
+ * The counters are opened at the first perf_start(). An event that cannot
+ * be opened (no PMU, e.g. in a virtual machine, perf_event_paranoid too
+ * high, event not supported) is reported as n/a and the others are still
+ * counted; the task clock is a software event and is always available.
+ * When the hardware has fewer counters than events the kernel multiplexes
+ * them and the counts are scaled by the fraction of time each event was
+ * actually counted.
+ *
+ * The counters are inherited by the threads created after they are opened,
+ * and a read returns the sum over the calling thread and these threads.
+ * Hence the OpenMP parallel regions within a region (e.g. the EAM forces)
+ * are counted on all the threads, provided the first call to a function
+ * of this file precedes the first parallel region of the program, which
+ * creates the threads. Threads spinning while waiting for work are counted
+ * as well, OMP_WAIT_POLICY=passive avoids it. The task clock is then the
+ * CPU time of all the threads. The regions themselves must be entered and
+ * left by the same thread, outside OpenMP parallel regions.
+ *
+ * Entering and leaving a region reads every counter with a system call (a
+ * few microseconds in all), hence regions should contain much more work
+ * than that. Different regions may be nested, a region may not be nested
+ * within itself.
+ *
+ * The engines call these functions through the macros of perfcount.h,
+ * which are empty unless the programs are compiled with -DPERFCOUNT.
+ *
+ * The externally accessible functions are:
+ *
+ *  int perf_region(char name[])
+ *      Index of the region with the given name, which is created if it does
+ *      not exist.
+ *
+ *  void perf_start(char name[])
+ *      Starts counting the region.
+ *
+ *  void perf_stop(char name[])
+ *      Stops counting the region and counts a call.
+ *
+ *  int perf_available(void)
+ *      Number of hardware events that could be opened (0...6).
+ *
+ *  double perf_count(char name[], int event)
+ *      Count of the event (see perfcount.h) accumulated in the region, -1 if
+ *      the event is not available. The task clock is in ns.
+ *
+ *  void perf_reset(void)
+ *      Sets the counts of all the regions to zero.
+ *
+ *  void perf_print(FILE *fd)
+ *      Prints the counts and the derived rates of all the regions.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define _GNU_SOURCE
+#define PERFCOUNT_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "start.h"
+#include "perfcount.h"
+
+#define NAME_LENGTH 32
+
+static int event_type[N_PERF_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                        PERF_TYPE_SOFTWARE};
+static long event_config[N_PERF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_SW_TASK_CLOCK};
+
+static int opened = 0, open_errno = 0, fd_event[N_PERF_EVENTS];
+static int n_regions = 0, active[MAX_PERF_REGIONS];
+static char region_name[MAX_PERF_REGIONS][NAME_LENGTH];
+static long calls[MAX_PERF_REGIONS];
+static double count[MAX_PERF_REGIONS][N_PERF_EVENTS];
+
+/*
+ * value, time enabled and time running of every event at the start of
+ * every region
+ */
+static unsigned long long started[MAX_PERF_REGIONS][N_PERF_EVENTS][3];
+
+static void open_events(void)
+{
+    int k;
+    struct perf_event_attr attr;
+
+    for (k = 0; k < N_PERF_EVENTS; k++)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.type = event_type[k];
+        attr.size = sizeof(attr);
+        attr.config = event_config[k];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fd_event[k] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+        if (fd_event[k] < 0 && open_errno == 0)
+            open_errno = errno;
+    }
+
+    opened = 1;
+}
+
+static void read_events(unsigned long long value[][3])
+{
+    int k;
+
+    for (k = 0; k < N_PERF_EVENTS; k++)
+    {
+        if (fd_event[k] < 0)
+            continue;
+
+        if (read(fd_event[k], value[k], 3 * sizeof(unsigned long long)) !=
+            3 * sizeof(unsigned long long))
+        {
+            if (open_errno == 0)
+                open_errno = errno;
+            close(fd_event[k]);
+            fd_event[k] = -1;
+        }
+    }
+}
+
+int perf_region(char name[])
+{
+    int r;
+
+    for (r = 0; r < n_regions; r++)
+        if (strcmp(region_name[r], name) == 0)
+            return r;
+
+    error(n_regions == MAX_PERF_REGIONS || strlen(name) >= NAME_LENGTH, 1,
+          "perf_region [perfcount.c]", "Too many regions or name too long");
+
+    strcpy(region_name[r], name);
+    n_regions++;
+
+    return r;
+}
+
+void perf_start(char name[])
+{
+    int r;
+
+    if (!opened)
+        open_events();
+
+    r = perf_region(name);
+    error(active[r], 1, "perf_start [perfcount.c]", "Region already started");
+    active[r] = 1;
+
+    read_events(started[r]);
+}
+
+void perf_stop(char name[])
+{
+    int r, k;
+    unsigned long long now[N_PERF_EVENTS][3];
+    double value, enabled, running;
+
+    read_events(now);
+
+    r = perf_region(name);
+    error(!active[r], 1, "perf_stop [perfcount.c]", "Region not started");
+    active[r] = 0;
+    calls[r]++;
+
+    for (k = 0; k < N_PERF_EVENTS; k++)
+    {
+        if (fd_event[k] < 0)
+            continue;
+
+        value = (double)(now[k][0] - started[r][k][0]);
+        enabled = (double)(now[k][1] - started[r][k][1]);
+        running = (double)(now[k][2] - started[r][k][2]);
+
+        /*multiplexed event: extrapolate to the whole interval*/
+        if (running > 0 && running < enabled)
+            value *= enabled / running;
+
+        count[r][k] += value;
+    }
+}
+
+int perf_available(void)
+{
+    int k, n;
+
+    if (!opened)
+        open_events();
+
+    n = 0;
+    for (k = 0; k < N_PERF_EVENTS; k++)
+        if (event_type[k] != PERF_TYPE_SOFTWARE && fd_event[k] >= 0)
+            n++;
+
+    return n;
+}
+
+double perf_count(char name[], int event)
+{
+    if (!opened || fd_event[event] < 0)
+        return -1;
+
+    return count[perf_region(name)][event];
+}
+
+void perf_reset(void)
+{
+    int r, k;
+
+    for (r = 0; r < n_regions; r++)
+    {
+        calls[r] = 0;
+        for (k = 0; k < N_PERF_EVENTS; k++)
+            count[r][k] = 0;
+    }
+}
+
+/*
+ * Prints a/b*scale, or n/a if one of the events is missing
+ */
+static void print_ratio(FILE *fd, int r, int a, int b, double scale, char format[])
+{
+    if (fd_event[a] < 0 || fd_event[b] < 0 || count[r][b] <= 0)
+        fprintf(fd, "  %8s", "n/a");
+    else
+        fprintf(fd, format, scale * count[r][a] / count[r][b]);
+}
+
+void perf_print(FILE *fd)
+{
+    int r;
+
+    if (!opened)
+        return;
+
+    if (perf_available() < N_PERF_EVENTS - 1)
+        fprintf(fd, "# %d of %d hardware counters available (%s)\n", perf_available(),
+                N_PERF_EVENTS - 1, strerror(open_errno));
+
+    fprintf(fd, "# region            calls  cpu time (s)       IPC  L1D MPKI  LLC MPKI  "
+                "br. miss %%\n");
+
+    for (r = 0; r < n_regions; r++)
+    {
+        fprintf(fd, "# %-16s %6ld  %12.4f", region_name[r], calls[r],
+                (fd_event[PERF_TASK_CLOCK] < 0) ? 0 : 1e-9 * count[r][PERF_TASK_CLOCK]);
+        print_ratio(fd, r, PERF_INSTRUCTIONS, PERF_CYCLES, 1, "  %8.3f");
+        print_ratio(fd, r, PERF_L1D_MISSES, PERF_INSTRUCTIONS, 1000, "  %8.3f");
+        print_ratio(fd, r, PERF_LLC_MISSES, PERF_INSTRUCTIONS, 1000, "  %8.3f");
+        print_ratio(fd, r, PERF_BRANCH_MISSES, PERF_BRANCHES, 100, "  %9.3f");
+        fprintf(fd, "\n");
+    }
+}
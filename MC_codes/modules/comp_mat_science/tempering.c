@@ -0,0 +1,211 @@
+/*******************************************************************************
+ *
+ * Library tempering.c
+ *
+ * Parallel tempering (replica exchange) for the lattice gas. Every replica is
+ * evolved with sweep() by its own OpenMP thread, on its own lattice and with
+ * its own generator (seeded with the seed of the run plus the index of the
+ * replica). Every swap_interval sweeps the replicas at neighbouring
+ * temperatures T_m < T_m+1 exchange their temperatures with probability
+ *
+ *  min(1, exp[(1/(KB*T_m) - 1/(KB*T_m+1)) * (E_m - E_m+1)])
+ *
+ * alternating the even and the odd pairs of the ladder. The swaps are drawn
+ * by the master thread with the generator of the replica 0, so a run depends
+ * only on the seed.
+ *
+ * The externally accessible functions are:
+ *
+ * void parallel_tempering(parameters_t *par, int n_replicas,
+ *                         double temperatures[], int swap_interval,
+ *                         char file_name[])
+ *  Runs n_replicas replicas of the lattice described by par at the
+ *  increasing temperatures[] for par->n_term sweeps of thermalization
+ *  followed by par->n_sweep sweeps of measurements.
+ *  Writes in file_name one line per temperature with T, <E>, <E^2>, the
+ *  mean number of neighbours, the mean number of atoms in the first layer
+ *  (3D only) and the acceptance rate of the swaps with the next temperature.
+ *  The acceptance rates are also printed, to tune the ladder.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "global.h"
+#include "random.h"
+#include "start.h"
+#include "montecarlo.h"
+#include "tempering.h"
+
+static int n_temperatures, swap_round;
+static int *replica_at, *temperature_of, *attempts, *accepted;
+static double *beta, *energy;
+
+static void attempt_swaps(ranbuf_t *rng)
+{
+    int m, a, b;
+    double r, delta;
+
+    for (m = swap_round % 2; m + 1 < n_temperatures; m += 2)
+    {
+        a = replica_at[m];
+        b = replica_at[m + 1];
+        delta = (beta[m] - beta[m + 1]) * (energy[a] - energy[b]);
+
+        r = ranbuf_double(rng);
+        attempts[m]++;
+
+        if (delta >= 0 || r < exp(delta))
+        {
+            replica_at[m] = b;
+            replica_at[m + 1] = a;
+            temperature_of[a] = m + 1;
+            temperature_of[b] = m;
+            accepted[m]++;
+        }
+    }
+
+    swap_round++;
+}
+
+void parallel_tempering(parameters_t *par, int n_replicas, double temperatures[],
+                        int swap_interval, char file_name[])
+{
+    int m, n_term, n_sweep;
+    double *sum_E, *sum_E2, *sum_nbrs, *sum_layer;
+    FILE *fd;
+
+    error((n_replicas < 1) || (swap_interval < 1), 1, "parallel_tempering [tempering.c]",
+          "Bad number of replicas or swap interval");
+
+#ifndef _OPENMP
+    error(n_replicas > 1, 1, "parallel_tempering [tempering.c]",
+          "More than one replica requires OpenMP");
+#endif
+
+    for (m = 0; m < n_replicas; m++)
+        error((temperatures[m] <= 0) || ((m > 0) && (temperatures[m] <= temperatures[m - 1])), 1,
+              "parallel_tempering [tempering.c]", "Temperatures must be positive and increasing");
+
+    n_term = par->n_term;
+    n_sweep = par->n_sweep;
+    n_temperatures = n_replicas;
+    swap_round = 0;
+    replica_at = (int *)malloc(n_replicas * sizeof(int));
+    temperature_of = (int *)malloc(n_replicas * sizeof(int));
+    attempts = (int *)malloc(n_replicas * sizeof(int));
+    accepted = (int *)malloc(n_replicas * sizeof(int));
+    beta = (double *)malloc(n_replicas * sizeof(double));
+    energy = (double *)malloc(n_replicas * sizeof(double));
+    sum_E = (double *)malloc(n_replicas * sizeof(double));
+    sum_E2 = (double *)malloc(n_replicas * sizeof(double));
+    sum_nbrs = (double *)malloc(n_replicas * sizeof(double));
+    sum_layer = (double *)malloc(n_replicas * sizeof(double));
+
+    for (m = 0; m < n_replicas; m++)
+    {
+        replica_at[m] = m;
+        temperature_of[m] = m;
+        attempts[m] = 0;
+        accepted[m] = 0;
+        beta[m] = 1 / (KB * temperatures[m]);
+        sum_E[m] = 0;
+        sum_E2[m] = 0;
+        sum_nbrs[m] = 0;
+        sum_layer[m] = 0;
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_replicas)
+#endif
+    {
+        int k, i, n, t;
+        double E;
+        parameters_t replica;
+        lattice_t *lat;
+
+        k = 0;
+#ifdef _OPENMP
+        k = omp_get_thread_num();
+        error(omp_get_num_threads() != n_replicas, 1, "parallel_tempering [tempering.c]",
+              "Unable to start one thread per replica");
+#endif
+        replica = *par;
+        replica.seed = (int)(((long)par->seed - 1 + k) % 2147483647L + 1);
+        replica.temperature = temperatures[k];
+
+        lat = new_lattice(&replica);
+
+        init_configuration(lat);
+
+        for (n = 0; n < n_term + n_sweep; n += swap_interval)
+        {
+            for (i = n; (i < n + swap_interval) && (i < n_term + n_sweep); i++)
+            {
+                sweep(lat);
+
+                if (i >= n_term)
+                {
+                    t = temperature_of[k];
+                    E = eval_E(lat);
+                    sum_E[t] += E;
+                    sum_E2[t] += E * E;
+                    sum_nbrs[t] += mean_number_of_nbrs(lat);
+                    sum_layer[t] += count_first_layer(lat);
+                }
+            }
+
+            energy[k] = eval_E(lat);
+
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp master
+#endif
+            attempt_swaps(lat->rng);
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
+
+            if (lat->temperature != temperatures[temperature_of[k]])
+                set_temperature(lat, temperatures[temperature_of[k]]);
+        }
+
+        free_lattice(lat);
+    }
+
+    fd = fopen(file_name, "w");
+    error(fd == NULL, 1, "parallel_tempering [tempering.c]", "Unable to open the output file");
+
+    printf("Swap acceptance rates:\n");
+
+    for (m = 0; m < n_replicas; m++)
+    {
+        fprintf(fd, "%.15e %.15e %.15e %.15e %.15e %.15e\n", temperatures[m],
+                sum_E[m] / n_sweep, sum_E2[m] / n_sweep, sum_nbrs[m] / n_sweep,
+                sum_layer[m] / n_sweep, (attempts[m] > 0) ? (double)accepted[m] / attempts[m] : 0);
+
+        if (m + 1 < n_replicas)
+            printf("%8.2f K <-> %8.2f K: %.3f\n", temperatures[m], temperatures[m + 1],
+                   (attempts[m] > 0) ? (double)accepted[m] / attempts[m] : 0);
+    }
+
+    fclose(fd);
+
+    free(replica_at);
+    free(temperature_of);
+    free(attempts);
+    free(accepted);
+    free(beta);
+    free(energy);
+    free(sum_E);
+    free(sum_E2);
+    free(sum_nbrs);
+    free(sum_layer);
+}
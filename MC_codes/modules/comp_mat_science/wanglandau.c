@@ -0,0 +1,411 @@
+/*******************************************************************************
+ *
+ * Library wanglandau.c
+ *
+ * Wang-Landau sampling of the density of states g(b,c) of the lattice gas,
+ * b being the number of bonds and c the number of atoms in contact with the
+ * substrate (see histogram.c). The walk uses the moves of sweep() (a random
+ * atom to a random empty site, see random_move() in montecarlo.c), accepted
+ * with probability min(1, g(old)/g(new)), and after every move log g of the
+ * current bin is increased by log_f. Whenever the histogram of the visits
+ * is flat, log_f is halved and the histogram cleared, until log_f is
+ * smaller than log_f_final. With the WL_INVERSE_TIME schedule log_f is
+ * instead set to 1/t (t being the number of moves per visited bin) as soon
+ * as a halving brings it below 1/t, which removes the saturation of the
+ * error of the plain algorithm (Belardinelli and Pereyra 2007).
+ *
+ * The bins are discovered by the walk: a bin visited for the first time
+ * gets the smallest log g of the visited bins and the histogram of the
+ * visits is cleared, the flatness is checked on the visited bins only.
+ * Since g(b,c) does not depend on the temperature nor on the couplings, a
+ * single converged run gives the averages at any T, J0 and J1 by means of
+ * reweight() in histogram.c.
+ *
+ * The state of the walk, including the configuration and the generator of
+ * the lattice, can be saved in a binary checkpoint and restored, and the
+ * restored walk continues exactly as the original one would have.
+ *
+ * The externally accessible functions are:
+ *
+ * wang_landau_t *new_wang_landau(lattice_t *lat, double log_f_final,
+ *                                double flatness, int schedule)
+ *  Starts a walk from the current configuration of lat (initialized with
+ *  init_configuration()) with log_f = 1.
+ *
+ * void free_wang_landau(wang_landau_t *w)
+ *  Frees the walk (not the lattice).
+ *
+ * int wl_flat(wang_landau_t *w)
+ *  Returns 1 if the histogram of the visits is flat, 0 otherwise.
+ *
+ * void wl_run(wang_landau_t *w, double n_moves)
+ *  Makes n_moves moves, or less if the walk converges before.
+ *
+ * int wl_converged(wang_landau_t *w)
+ *  Returns 1 if log_f is smaller than log_f_final, 0 otherwise.
+ *
+ * double *wl_dos(wang_landau_t *w)
+ *  Returns log g(b,c) normalized to the number of configurations
+ *  binomial(n_sites, n_atoms), in an array indexed as the counts of
+ *  w->visits (-HUGE_VAL on the bins never visited).
+ *
+ * void save_wang_landau(wang_landau_t *w, char file_name[])
+ *  Writes the checkpoint of the walk in file_name. The file is written
+ *  under a temporary name and then renamed, so an interrupted write leaves
+ *  the previous checkpoint intact.
+ *
+ * int load_wang_landau(wang_landau_t *w, char file_name[])
+ *  Restores the walk (and the configuration and generator of its lattice)
+ *  from the checkpoint file_name. Returns 0 if the file does not exist, 1
+ *  otherwise, the checkpoint must be of a lattice of the same size. The
+ *  final modification factor of w is kept, so that a converged walk can be
+ *  refined further.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "global.h"
+#include "start.h"
+#include "random.h"
+#include "montecarlo.h"
+#include "histogram.h"
+#include "wanglandau.h"
+
+#define WL_CHECK 10000
+#define WL_VERSION 1
+#define BYTE_ORDER_MARK 0x01020304
+
+static int n_bins_of(wang_landau_t *w)
+{
+    return (w->visits->max_bonds + 1) * (w->visits->max_contacts + 1);
+}
+
+static void clear_visits(wang_landau_t *w)
+{
+    memset(w->visits->count, 0, n_bins_of(w) * sizeof(double));
+    w->visits->n_samples = 0;
+}
+
+wang_landau_t *new_wang_landau(lattice_t *lat, double log_f_final, double flatness, int schedule)
+{
+    int x, n_bins;
+    wang_landau_t *w;
+
+    error(log_f_final <= 0 || log_f_final >= 1 || flatness <= 0 || flatness >= 1, 1,
+          "new_wang_landau [wanglandau.c]", "Bad final modification factor or flatness");
+    error(schedule != WL_HALVING && schedule != WL_INVERSE_TIME, 1,
+          "new_wang_landau [wanglandau.c]", "Unknown schedule");
+
+    w = (wang_landau_t *)malloc(sizeof(wang_landau_t));
+    error(w == NULL, 1, "new_wang_landau [wanglandau.c]", "Unable to allocate the walk");
+
+    w->lat = lat;
+    w->visits = new_histogram(lat);
+    n_bins = n_bins_of(w);
+
+    w->log_g = (double *)malloc(n_bins * sizeof(double));
+    error(w->log_g == NULL, 1, "new_wang_landau [wanglandau.c]", "Unable to allocate the walk");
+
+    for (x = 0; x < n_bins; x++)
+        w->log_g[x] = -HUGE_VAL;
+
+    count_bonds_contacts(lat, &w->bonds, &w->contacts);
+    w->log_g[w->bonds * (w->visits->max_contacts + 1) + w->contacts] = 0;
+
+    w->log_f = 1;
+    w->log_f_final = log_f_final;
+    w->flatness = flatness;
+    w->schedule = schedule;
+    w->inverse_time = 0;
+    w->check = WL_CHECK;
+    w->stage = 0;
+    w->n_bins = 1;
+    w->n_moves = 0;
+
+    return w;
+}
+
+void free_wang_landau(wang_landau_t *w)
+{
+    free_histogram(w->visits);
+    free(w->log_g);
+    free(w);
+}
+
+int wl_flat(wang_landau_t *w)
+{
+    int x, n_bins;
+    double min;
+
+    if (w->visits->n_samples == 0)
+        return 0;
+
+    n_bins = n_bins_of(w);
+    min = w->visits->n_samples;
+
+    for (x = 0; x < n_bins; x++)
+        if (w->log_g[x] != -HUGE_VAL && w->visits->count[x] < min)
+            min = w->visits->count[x];
+
+    return min >= w->flatness * w->visits->n_samples / w->n_bins;
+}
+
+/*
+ * First visit of a bin: it starts from the smallest log g of the visited
+ * bins and the histogram of the visits is cleared
+ */
+static void discover(wang_landau_t *w, int bin)
+{
+    int x, n_bins;
+    double min;
+
+    n_bins = n_bins_of(w);
+    min = HUGE_VAL;
+
+    for (x = 0; x < n_bins; x++)
+        if (w->log_g[x] != -HUGE_VAL && w->log_g[x] < min)
+            min = w->log_g[x];
+
+    w->log_g[bin] = min;
+    w->n_bins++;
+    clear_visits(w);
+}
+
+static void reduce_log_f(wang_landau_t *w)
+{
+    w->log_f /= 2;
+    w->stage++;
+    clear_visits(w);
+
+    if (w->schedule == WL_INVERSE_TIME && w->log_f < w->n_bins / w->n_moves)
+    {
+        w->inverse_time = 1;
+        w->log_f = w->n_bins / w->n_moves;
+    }
+}
+
+void wl_run(wang_landau_t *w, double n_moves)
+{
+    int atom, s_old, delta_bonds, delta_substrate, stride, old_bin, new_bin;
+    double i;
+    lattice_t *lat;
+
+    lat = w->lat;
+    stride = w->visits->max_contacts + 1;
+
+    for (i = 0; i < n_moves && !wl_converged(w); i++)
+    {
+        old_bin = w->bonds * stride + w->contacts;
+        atom = random_move(lat, &s_old, &delta_bonds, &delta_substrate);
+        new_bin = old_bin + delta_bonds * stride + delta_substrate;
+
+        if (w->log_g[new_bin] == -HUGE_VAL)
+            discover(w, new_bin);
+        else if (w->log_g[new_bin] > w->log_g[old_bin] &&
+                 ranbuf_double(lat->rng) >= exp(w->log_g[old_bin] - w->log_g[new_bin]))
+            new_bin = old_bin;
+
+        if (new_bin == old_bin && (delta_bonds != 0 || delta_substrate != 0))
+        {
+            /*rejects the new configuration*/
+            undo_move(lat, atom, s_old);
+        }
+        else
+        {
+            w->bonds += delta_bonds;
+            w->contacts += delta_substrate;
+        }
+
+        w->log_g[new_bin] += w->log_f;
+        w->visits->count[new_bin] += 1;
+        w->visits->n_samples += 1;
+        w->n_moves += 1;
+
+        if (w->inverse_time)
+            w->log_f = w->n_bins / w->n_moves;
+        else if (fmod(w->n_moves, w->check) == 0 && wl_flat(w))
+            reduce_log_f(w);
+    }
+}
+
+int wl_converged(wang_landau_t *w)
+{
+    return w->log_f < w->log_f_final;
+}
+
+double *wl_dos(wang_landau_t *w)
+{
+    int x, n_bins;
+    double *log_g, log_total, log_sum, max;
+
+    n_bins = n_bins_of(w);
+    log_g = (double *)malloc(n_bins * sizeof(double));
+    error(log_g == NULL, 1, "wl_dos [wanglandau.c]", "Unable to allocate the density of states");
+
+    /*log binomial(n_sites, n_atoms)*/
+    log_total = 0;
+    for (x = 0; x < w->lat->n_atoms; x++)
+        log_total += log((double)(w->lat->n_sites - x) / (x + 1));
+
+    max = -HUGE_VAL;
+    for (x = 0; x < n_bins; x++)
+        if (w->log_g[x] > max)
+            max = w->log_g[x];
+
+    log_sum = 0;
+    for (x = 0; x < n_bins; x++)
+        if (w->log_g[x] != -HUGE_VAL)
+            log_sum += exp(w->log_g[x] - max);
+    log_sum = max + log(log_sum);
+
+    for (x = 0; x < n_bins; x++)
+        log_g[x] = (w->log_g[x] != -HUGE_VAL) ? w->log_g[x] - log_sum + log_total : -HUGE_VAL;
+
+    return log_g;
+}
+
+static void write_block(FILE *fd, void *data, size_t size, size_t n)
+{
+    error(fwrite(data, size, n, fd) != n, 1, "save_wang_landau [wanglandau.c]",
+          "Unable to write the checkpoint");
+}
+
+static void read_block(FILE *fd, void *data, size_t size, size_t n)
+{
+    error(fread(data, size, n, fd) != n, 1, "load_wang_landau [wanglandau.c]",
+          "Truncated checkpoint");
+}
+
+void save_wang_landau(wang_landau_t *w, char file_name[])
+{
+    int header[15], *state;
+    double values[5];
+    char tmp_name[FILENAME_MAX];
+    lattice_t *lat;
+    FILE *fd;
+
+    lat = w->lat;
+
+    error(strlen(file_name) + 5 > FILENAME_MAX, 1, "save_wang_landau [wanglandau.c]",
+          "File name too long");
+    sprintf(tmp_name, "%s.tmp", file_name);
+
+    fd = fopen(tmp_name, "wb");
+    error(fd == NULL, 1, "save_wang_landau [wanglandau.c]", "Unable to open the checkpoint");
+
+    header[0] = BYTE_ORDER_MARK;
+    header[1] = WL_VERSION;
+    header[2] = lat->dim;
+    header[3] = lat->lx;
+    header[4] = lat->ly;
+    header[5] = lat->lz;
+    header[6] = lat->n_atoms;
+    header[7] = w->visits->max_bonds;
+    header[8] = w->visits->max_contacts;
+    header[9] = w->schedule;
+    header[10] = w->inverse_time;
+    header[11] = w->check;
+    header[12] = w->stage;
+    header[13] = w->n_bins;
+    header[14] = lat->rng->next;
+
+    values[0] = w->log_f;
+    values[1] = w->log_f_final;
+    values[2] = w->flatness;
+    values[3] = w->n_moves;
+    values[4] = w->visits->n_samples;
+
+    state = (int *)malloc(rlxd_size() * sizeof(int));
+    error(state == NULL, 1, "save_wang_landau [wanglandau.c]", "Unable to allocate the state");
+    rlxd_get_r(&lat->rng->st, state);
+
+    write_block(fd, "WANGLAND", 1, 8);
+    write_block(fd, header, sizeof(int), 15);
+    write_block(fd, values, sizeof(double), 5);
+    write_block(fd, w->log_g, sizeof(double), n_bins_of(w));
+    write_block(fd, w->visits->count, sizeof(double), n_bins_of(w));
+    write_block(fd, lat->atom_site, sizeof(int), lat->n_atoms);
+    write_block(fd, state, sizeof(int), rlxd_size());
+    write_block(fd, lat->rng->raw, sizeof(long long), RANBUF_SIZE);
+
+    error(fclose(fd) != 0, 1, "save_wang_landau [wanglandau.c]", "Unable to write the checkpoint");
+    free(state);
+
+    remove(file_name);
+    error(rename(tmp_name, file_name) != 0, 1, "save_wang_landau [wanglandau.c]",
+          "Unable to rename the checkpoint");
+}
+
+int load_wang_landau(wang_landau_t *w, char file_name[])
+{
+    int i, header[15], *state;
+    double values[5];
+    char magic[8];
+    lattice_t *lat;
+    FILE *fd;
+
+    lat = w->lat;
+
+    fd = fopen(file_name, "rb");
+    if (fd == NULL)
+        return 0;
+
+    read_block(fd, magic, 1, 8);
+    read_block(fd, header, sizeof(int), 15);
+    error(memcmp(magic, "WANGLAND", 8) != 0 || header[0] != BYTE_ORDER_MARK ||
+              header[1] != WL_VERSION,
+          1, "load_wang_landau [wanglandau.c]", "Not a checkpoint of this version");
+    error(header[2] != lat->dim || header[3] != lat->lx || header[4] != lat->ly ||
+              header[5] != lat->lz || header[6] != lat->n_atoms ||
+              header[7] != w->visits->max_bonds || header[8] != w->visits->max_contacts,
+          1, "load_wang_landau [wanglandau.c]", "Checkpoint of a different lattice");
+    error(header[14] < 0 || header[14] > RANBUF_SIZE, 1, "load_wang_landau [wanglandau.c]",
+          "Bad generator state");
+
+    read_block(fd, values, sizeof(double), 5);
+    read_block(fd, w->log_g, sizeof(double), n_bins_of(w));
+    read_block(fd, w->visits->count, sizeof(double), n_bins_of(w));
+
+    for (i = 0; i < lat->n_atoms; i++)
+        lat->occupation[lat->atom_site[i]] = 0;
+
+    read_block(fd, lat->atom_site, sizeof(int), lat->n_atoms);
+
+    for (i = 0; i < lat->n_atoms; i++)
+    {
+        error(lat->atom_site[i] < 0 || lat->atom_site[i] >= lat->n_sites ||
+                  lat->occupation[lat->atom_site[i]] != 0,
+              1, "load_wang_landau [wanglandau.c]", "Bad configuration");
+        lat->occupation[lat->atom_site[i]] = 1;
+    }
+
+    state = (int *)malloc(rlxd_size() * sizeof(int));
+    error(state == NULL, 1, "load_wang_landau [wanglandau.c]", "Unable to allocate the state");
+    read_block(fd, state, sizeof(int), rlxd_size());
+    rlxd_reset_r(&lat->rng->st, state);
+    free(state);
+
+    read_block(fd, lat->rng->raw, sizeof(long long), RANBUF_SIZE);
+    lat->rng->next = header[14];
+
+    fclose(fd);
+
+    w->schedule = header[9];
+    w->inverse_time = header[10];
+    w->check = header[11];
+    w->stage = header[12];
+    w->n_bins = header[13];
+    w->log_f = values[0];
+    w->flatness = values[2];
+    w->n_moves = values[3];
+    w->visits->n_samples = values[4];
+
+    count_bonds_contacts(lat, &w->bonds, &w->contacts);
+
+    return 1;
+}
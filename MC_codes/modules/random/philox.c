@@ -0,0 +1,153 @@
+
+/*******************************************************************************
+*
+* File philox.c
+*
+* Counter-based random number generator Philox4x32-10 of J.K. Salmon,
+* M.A. Moraes, R.O. Dror and D.E. Shaw (SC11, 2011). The numbers are a
+* fixed function of a 64-bit key and of a 128-bit counter, there is no
+* state to advance: the key is (seed,replica) and the counter is
+* (index,step,block), where index labels an atom or a site, step a sweep
+* or a time step and block the position in the stream. A random number used
+* for a given atom at a given step is then the same whatever thread draws
+* it and in whatever order, and parallel programs give results that do not
+* depend on the number of threads or on the schedule.
+*
+* The externally accessible functions are
+*
+*   void philox4x32(unsigned int ctr[4],unsigned int key[2],unsigned int x[4])
+*     Assigns the 10-round Philox bijection of the counter ctr with the key
+*     key to x
+*
+*   void phx_init_r(phx_state_t *st,int seed,int replica,int index,int step)
+*     Sets the key and the counter of the stream *st. Any values of the
+*     arguments are allowed, negative ones included
+*
+*   void ranphx_raw_r(phx_state_t *st,long long r[],int n)
+*     Assigns the next n numbers of the stream *st to r[0],..,r[n-1] as
+*     48-bit integers, two per block of the counter
+*
+*   void ranphx_r(phx_state_t *st,double r[],int n)
+*     Assigns the next n numbers of the stream *st to r[0],..,r[n-1] as
+*     double-precision numbers k*2^-48 in [0,1)
+*
+* The 48-bit integers are formed from the 32 bits of the first and the 16
+* upper bits of the second word of each half of the output block, so that
+* the numbers have the same resolution as those of ranlxd and can be used
+* with the integer helpers and thresholds written for ranbuf.
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+#define PHILOX_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include "start.h"
+#include "random.h"
+
+#define PHX_M0 0xD2511F53UL
+#define PHX_M1 0xCD9E8D57UL
+#define PHX_W0 0x9E3779B9UL
+#define PHX_W1 0xBB67AE85UL
+#define PHX_ROUNDS 10
+#define PHX_ONE_BIT 3.552713678800500929355621337890625e-15
+
+#define MASK32 0xffffffffULL
+
+
+void philox4x32(unsigned int ctr[4],unsigned int key[2],unsigned int x[4])
+{
+   int k;
+   unsigned int k0,k1,y0,y1,y2,y3;
+   unsigned long long p0,p1;
+
+   y0=ctr[0];
+   y1=ctr[1];
+   y2=ctr[2];
+   y3=ctr[3];
+   k0=key[0];
+   k1=key[1];
+
+   for (k=0;k<PHX_ROUNDS;k++)
+   {
+      p0=(unsigned long long)PHX_M0*(unsigned long long)y0;
+      p1=(unsigned long long)PHX_M1*(unsigned long long)y2;
+
+      y0=(unsigned int)(p1>>32)^y1^k0;
+      y1=(unsigned int)(p1&MASK32);
+      y2=(unsigned int)(p0>>32)^y3^k1;
+      y3=(unsigned int)(p0&MASK32);
+
+      k0=(unsigned int)((k0+PHX_W0)&MASK32);
+      k1=(unsigned int)((k1+PHX_W1)&MASK32);
+   }
+
+   x[0]=y0;
+   x[1]=y1;
+   x[2]=y2;
+   x[3]=y3;
+}
+
+
+void phx_init_r(phx_state_t *st,int seed,int replica,int index,int step)
+{
+   error((UINT_MAX!=0xffffffffUL),1,"phx_init_r [philox.c]",
+         "Arithmetic on this machine is not suitable for philox");
+
+   st->key[0]=(unsigned int)seed;
+   st->key[1]=(unsigned int)replica;
+   st->ctr[0]=(unsigned int)index;
+   st->ctr[1]=(unsigned int)step;
+   st->ctr[2]=0;
+   st->ctr[3]=0;
+   st->next=2;
+}
+
+
+static void next_block(phx_state_t *st)
+{
+   unsigned int x[4];
+
+   philox4x32(st->ctr,st->key,x);
+
+   st->raw[0]=((long long)x[0]<<16)|(long long)(x[1]>>16);
+   st->raw[1]=((long long)x[2]<<16)|(long long)(x[3]>>16);
+   st->next=0;
+
+   st->ctr[2]+=1;
+   if (st->ctr[2]==0)
+      st->ctr[3]+=1;
+}
+
+
+void ranphx_raw_r(phx_state_t *st,long long r[],int n)
+{
+   int k;
+
+   for (k=0;k<n;k++)
+   {
+      if (st->next==2)
+         next_block(st);
+
+      r[k]=st->raw[st->next];
+      st->next+=1;
+   }
+}
+
+
+void ranphx_r(phx_state_t *st,double r[],int n)
+{
+   int k;
+
+   for (k=0;k<n;k++)
+   {
+      if (st->next==2)
+         next_block(st);
+
+      r[k]=PHX_ONE_BIT*(double)(st->raw[st->next]);
+      st->next+=1;
+   }
+}
+
@@ -0,0 +1,476 @@
+
+/*******************************************************************************
+*
+* File rlxvec.c
+*
+* Update of the state of ranlxs and ranlxd (integer representation) with
+* a choice of kernels selected at run time. The state consists of 4
+* independent 24-bit subtract-with-borrow sequences, advanced together by
+* the steps of the update; all kernels perform exactly the same integer
+* operations and yield bit-identical sequences
+*
+*   RLX_SCALAR   Plain C (the code of ranlux v3.0)
+*   RLX_SSE2     128-bit vectors, one for the 4 lower and one for the 4
+*                upper halves of a step
+*   RLX_AVX2     256-bit vectors holding a whole step, the borrow of the
+*                lower half is moved to the upper half by a lane permutation
+*   RLX_AVX512   Same as RLX_AVX2 with AVX-512VL mask registers for the
+*                borrows
+*
+* The steps are chained by the borrows, hence wider vectors do not give
+* more parallelism and may well be slower than RLX_SSE2. On first use the
+* available kernels are timed on a scratch state and the fastest one is
+* retained, unless a kernel was chosen by rlx_set_backend()
+*
+* The externally accessible functions are
+*
+*   void rlx_update(rlx_dble_vec_t x[],rlx_vec_t *carry,int ir,int jr,int n)
+*     Performs n steps of the update of the state x[0..11] with borrows
+*     *carry, starting at the positions ir and jr=(ir+7)%12
+*
+*   int rlx_backend(void)
+*     Returns the kernel in use (selecting it if need be)
+*
+*   int rlx_backend_available(int b)
+*     Returns 1 if the kernel b can be used on this machine, 0 otherwise
+*
+*   void rlx_set_backend(int b)
+*     Selects the kernel b (for tests and timing)
+*
+*   char *rlx_backend_name(int b)
+*     Returns the name of the kernel b
+*
+* When the programs are compiled with -DSSE or -DSSE2, ranlxs and ranlxd
+* use their own inline-assembly update and no kernel is available here
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+#define RLXVEC_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "start.h"
+#include "random.h"
+
+#if ((defined __GNUC__)&&((defined __x86_64__)||(defined __i386__)))
+#define X86
+#include <immintrin.h>
+#endif
+
+static char *names[RLX_NBACKENDS]={"scalar","sse2","avx2","avx512"};
+
+
+#if ((defined SSE)||(defined SSE2))
+
+int rlx_backend(void)
+{
+   return -1;
+}
+
+
+int rlx_backend_available(int b)
+{
+   return 0;
+}
+
+
+void rlx_set_backend(int b)
+{
+   error(1,1,"rlx_set_backend [rlxvec.c]",
+         "The update is in inline assembly (compiled with -DSSE)");
+}
+
+
+char *rlx_backend_name(int b)
+{
+   if ((b>=0)&&(b<RLX_NBACKENDS))
+      return names[b];
+   else
+      return "sse (inline assembly)";
+}
+
+#else
+
+#define BASE 0x1000000
+#define MASK 0xffffff
+#define NCALIB 64
+
+typedef void (*kernel_t)(rlx_dble_vec_t x[],rlx_vec_t *carry,int ir,int jr,int n);
+
+static int backend=-1,ready=0;
+static kernel_t kernel=NULL;
+
+
+static void update_scalar(rlx_dble_vec_t x[],rlx_vec_t *pc,int ir,int jr,int n)
+{
+   int k,d;
+   rlx_dble_vec_t *pmin,*pmax,*pi,*pj;
+   rlx_vec_t carry;
+
+   carry=(*pc);
+   pmin=x;
+   pmax=pmin+12;
+   pi=x+ir;
+   pj=x+jr;
+
+   for (k=0;k<n;k++)
+   {
+      d=(*pj).c1.c1-(*pi).c1.c1-carry.c1;
+      (*pi).c2.c1+=(d<0);
+      d+=BASE;
+      (*pi).c1.c1=d&MASK;
+      d=(*pj).c1.c2-(*pi).c1.c2-carry.c2;
+      (*pi).c2.c2+=(d<0);
+      d+=BASE;
+      (*pi).c1.c2=d&MASK;
+      d=(*pj).c1.c3-(*pi).c1.c3-carry.c3;
+      (*pi).c2.c3+=(d<0);
+      d+=BASE;
+      (*pi).c1.c3=d&MASK;
+      d=(*pj).c1.c4-(*pi).c1.c4-carry.c4;
+      (*pi).c2.c4+=(d<0);
+      d+=BASE;
+      (*pi).c1.c4=d&MASK;
+      d=(*pj).c2.c1-(*pi).c2.c1;
+      carry.c1=(d<0);
+      d+=BASE;
+      (*pi).c2.c1=d&MASK;
+      d=(*pj).c2.c2-(*pi).c2.c2;
+      carry.c2=(d<0);
+      d+=BASE;
+      (*pi).c2.c2=d&MASK;
+      d=(*pj).c2.c3-(*pi).c2.c3;
+      carry.c3=(d<0);
+      d+=BASE;
+      (*pi).c2.c3=d&MASK;
+      d=(*pj).c2.c4-(*pi).c2.c4;
+      carry.c4=(d<0);
+      d+=BASE;
+      (*pi).c2.c4=d&MASK;
+
+      pi+=1;
+      pj+=1;
+      if (pi==pmax)
+         pi=pmin;
+      if (pj==pmax)
+         pj=pmin;
+   }
+
+   (*pc)=carry;
+}
+
+#ifdef X86
+
+/*
+ * In the vector kernels the sign bit of a difference is its borrow: the
+ * arithmetic shift gives -1 (to be added), the logical shift +1 (to be
+ * subtracted). Masking with MASK is the same as adding BASE and masking.
+ * The 256-bit kernels clear the upper halves of the registers on exit,
+ * since the compiler does not always do it and the SSE code that follows
+ * would be slowed down
+ */
+
+__attribute__ ((target ("sse2")))
+static void update_sse2(rlx_dble_vec_t x[],rlx_vec_t *pc,int ir,int jr,int n)
+{
+   int k;
+   __m128i mask,carry,d1,d2;
+
+   mask=_mm_set1_epi32(MASK);
+   carry=_mm_loadu_si128((__m128i*)(pc));
+
+   for (k=0;k<n;k++)
+   {
+      d1=_mm_sub_epi32(_mm_loadu_si128((__m128i*)(&x[jr].c1)),
+                       _mm_loadu_si128((__m128i*)(&x[ir].c1)));
+      d1=_mm_sub_epi32(d1,carry);
+      d2=_mm_sub_epi32(_mm_loadu_si128((__m128i*)(&x[jr].c2)),
+                       _mm_loadu_si128((__m128i*)(&x[ir].c2)));
+      d2=_mm_add_epi32(d2,_mm_srai_epi32(d1,31));
+      carry=_mm_srli_epi32(d2,31);
+      _mm_storeu_si128((__m128i*)(&x[ir].c1),_mm_and_si128(d1,mask));
+      _mm_storeu_si128((__m128i*)(&x[ir].c2),_mm_and_si128(d2,mask));
+
+      ir+=1;
+      jr+=1;
+      if (ir==12)
+         ir=0;
+      if (jr==12)
+         jr=0;
+   }
+
+   _mm_storeu_si128((__m128i*)(pc),carry);
+}
+
+
+__attribute__ ((target ("avx2")))
+static void update_avx2(rlx_dble_vec_t x[],rlx_vec_t *pc,int ir,int jr,int n)
+{
+   int k;
+   __m256i mask,carry,d,s;
+
+   mask=_mm256_set1_epi32(MASK);
+   carry=_mm256_inserti128_si256(_mm256_setzero_si256(),
+                                 _mm_loadu_si128((__m128i*)(pc)),0);
+
+   for (k=0;k<n;k++)
+   {
+      d=_mm256_sub_epi32(_mm256_loadu_si256((__m256i*)(x+jr)),
+                         _mm256_loadu_si256((__m256i*)(x+ir)));
+      d=_mm256_sub_epi32(d,carry);
+      s=_mm256_srai_epi32(d,31);
+      d=_mm256_add_epi32(d,_mm256_permute2x128_si256(s,s,0x08));
+      s=_mm256_srli_epi32(d,31);
+      carry=_mm256_permute2x128_si256(s,s,0x81);
+      _mm256_storeu_si256((__m256i*)(x+ir),_mm256_and_si256(d,mask));
+
+      ir+=1;
+      jr+=1;
+      if (ir==12)
+         ir=0;
+      if (jr==12)
+         jr=0;
+   }
+
+   _mm_storeu_si128((__m128i*)(pc),_mm256_castsi256_si128(carry));
+   _mm256_zeroupper();
+}
+
+
+__attribute__ ((target ("avx512f,avx512vl")))
+static void update_avx512(rlx_dble_vec_t x[],rlx_vec_t *pc,int ir,int jr,int n)
+{
+   int k;
+   __m256i mask,one,zero,d;
+   __mmask8 carry,b;
+
+   mask=_mm256_set1_epi32(MASK);
+   one=_mm256_set1_epi32(1);
+   zero=_mm256_setzero_si256();
+   carry=(__mmask8)(((*pc).c1!=0)|(((*pc).c2!=0)<<1)|
+                    (((*pc).c3!=0)<<2)|(((*pc).c4!=0)<<3));
+
+   for (k=0;k<n;k++)
+   {
+      d=_mm256_sub_epi32(_mm256_loadu_si256((__m256i*)(x+jr)),
+                         _mm256_loadu_si256((__m256i*)(x+ir)));
+      d=_mm256_mask_sub_epi32(d,carry,d,one);
+      b=_mm256_cmplt_epi32_mask(d,zero);
+      d=_mm256_mask_sub_epi32(d,(__mmask8)(b<<4),d,one);
+      carry=(__mmask8)(_mm256_cmplt_epi32_mask(d,zero)>>4);
+      _mm256_storeu_si256((__m256i*)(x+ir),_mm256_and_si256(d,mask));
+
+      ir+=1;
+      jr+=1;
+      if (ir==12)
+         ir=0;
+      if (jr==12)
+         jr=0;
+   }
+
+   (*pc).c1=carry&0x1;
+   (*pc).c2=(carry>>1)&0x1;
+   (*pc).c3=(carry>>2)&0x1;
+   (*pc).c4=(carry>>3)&0x1;
+   _mm256_zeroupper();
+}
+
+#endif
+
+static kernel_t kernel_of(int b)
+{
+#ifdef X86
+   if (b==RLX_SSE2)
+      return update_sse2;
+   else if (b==RLX_AVX2)
+      return update_avx2;
+   else if (b==RLX_AVX512)
+      return update_avx512;
+#endif
+
+   return update_scalar;
+}
+
+
+int rlx_backend_available(int b)
+{
+   if (b==RLX_SCALAR)
+      return 1;
+
+#ifdef X86
+   __builtin_cpu_init();
+
+   if (b==RLX_SSE2)
+      return (__builtin_cpu_supports("sse2")!=0);
+   else if (b==RLX_AVX2)
+      return (__builtin_cpu_supports("avx2")!=0);
+   else if (b==RLX_AVX512)
+      return ((__builtin_cpu_supports("avx512f")!=0)&&
+              (__builtin_cpu_supports("avx512vl")!=0));
+#endif
+
+   return 0;
+}
+
+
+static double time_kernel(int b)
+{
+   int k,l,ir,jr;
+   clock_t t1,t2,dt;
+   rlx_dble_vec_t x[12];
+   rlx_vec_t carry;
+   kernel_t f;
+
+   for (k=0;k<12;k++)
+   {
+      x[k].c1.c1=(1234567*(8*k+1))&MASK;
+      x[k].c1.c2=(1234567*(8*k+2))&MASK;
+      x[k].c1.c3=(1234567*(8*k+3))&MASK;
+      x[k].c1.c4=(1234567*(8*k+4))&MASK;
+      x[k].c2.c1=(1234567*(8*k+5))&MASK;
+      x[k].c2.c2=(1234567*(8*k+6))&MASK;
+      x[k].c2.c3=(1234567*(8*k+7))&MASK;
+      x[k].c2.c4=(1234567*(8*k+8))&MASK;
+   }
+
+   carry.c1=0;
+   carry.c2=0;
+   carry.c3=0;
+   carry.c4=0;
+   f=kernel_of(b);
+   dt=0;
+
+   for (l=0;l<3;l++)
+   {
+      ir=0;
+      jr=7;
+
+      t1=clock();
+      for (k=0;k<NCALIB;k++)
+      {
+         f(x,&carry,ir,jr,397);
+         ir=(ir+1)%12;
+         jr=(jr+1)%12;
+      }
+      t2=clock();
+
+      if ((l==0)||((t2-t1)<dt))
+         dt=t2-t1;
+   }
+
+   return (double)(dt);
+}
+
+
+/*
+* backend and kernel are published by setting ready last, and are read only
+* after ready has been found set (double-checked initialization under OpenMP)
+*/
+
+static void set_kernel(int b)
+{
+   backend=b;
+   kernel=kernel_of(b);
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+   ready=1;
+}
+
+
+static int kernel_ready(void)
+{
+   int r;
+
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+   r=ready;
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+
+   return r;
+}
+
+
+static void select_backend(void)
+{
+   int b,best;
+   double t,tbest;
+
+   best=RLX_SCALAR;
+   tbest=time_kernel(RLX_SCALAR);
+
+   for (b=1;b<RLX_NBACKENDS;b++)
+   {
+      if (rlx_backend_available(b))
+      {
+         t=time_kernel(b);
+
+         if (t<tbest)
+         {
+            best=b;
+            tbest=t;
+         }
+      }
+   }
+
+   set_kernel(best);
+}
+
+
+static void init_kernel(void)
+{
+   if (kernel_ready()==0)
+   {
+#ifdef _OPENMP
+#pragma omp critical (rlxvec)
+#endif
+      {
+         if (ready==0)
+            select_backend();
+      }
+   }
+}
+
+
+void rlx_update(rlx_dble_vec_t x[],rlx_vec_t *carry,int ir,int jr,int n)
+{
+   init_kernel();
+   kernel(x,carry,ir,jr,n);
+}
+
+
+int rlx_backend(void)
+{
+   init_kernel();
+
+   return backend;
+}
+
+
+void rlx_set_backend(int b)
+{
+   error((b<0)||(b>=RLX_NBACKENDS)||(rlx_backend_available(b)==0),1,
+         "rlx_set_backend [rlxvec.c]","Kernel not available on this machine");
+
+#ifdef _OPENMP
+#pragma omp critical (rlxvec)
+#endif
+   set_kernel(b);
+}
+
+
+char *rlx_backend_name(int b)
+{
+   if ((b>=0)&&(b<RLX_NBACKENDS))
+      return names[b];
+   else
+      return "unknown";
+}
+
+#endif
@@ -1,9 +1,10 @@
 
 /*******************************************************************************
  *
- * File test4.c
+ * File coeff.c
  *
- * Print on file energy and temperature at each time step.
+ * Prints the coefficients of the polinomial junction of the pair potential
+ * for RC and RP of global.h.
  *
  * Author: Lorenzo Tasca
  *
@@ -19,7 +20,13 @@
 
 int main(int argc, char *argv[])
 {
-    eval_coefficients();
+    int k;
+    potential_t *p;
+
+    p = get_potential();
+
+    for (k = 0; k < 8; k++)
+        printf("poly[%d] = %.15e\n", k, p->poly[k]);
 
     return 0;
 }
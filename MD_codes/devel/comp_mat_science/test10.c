@@ -0,0 +1,214 @@
+/*******************************************************************************
+ *
+ * File test10.c
+ *
+ * Test of the EAM (eam.c) with the Sutton-Chen potential of silver:
+ *  - forces of eval_U_and_forces() against finite differences of eval_U();
+ *  - the same potential written in the funcfl format and read back with
+ *    load_eam() gives the same energy and forces;
+ *  - cost per atom and per step of the forces, against the pair potential
+ *    (also with the EAM cut at RC, i.e. on the same neighbour lists);
+ *  - energy after the relaxation with lbfgs() and drift of the energy in
+ *    N_STEPS steps of verlet_evolution().
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include "eam.h"
+#include <assert.h>
+
+#define H_DIFF 1e-5 /*A*/
+#define N_CHECK 16
+#define N_EVAL 2000
+#define N_STEPS 1000
+#define N_TABLE 3000
+
+/*
+ * Sutton-Chen pair potential and density shifted to zero, with their
+ * derivative, at SC_RC (as in set_eam_sutton_chen())
+ */
+static double shifted(double r, int n, double eps)
+{
+    double g_rc;
+
+    g_rc = eps * pow(SC_A / SC_RC, n);
+
+    return eps * pow(SC_A / r, n) - g_rc + (r - SC_RC) * n * g_rc / SC_RC;
+}
+
+static void write_funcfl(char file_name[])
+{
+    int k;
+    double dr, drho;
+    FILE *fd;
+
+    fd = fopen(file_name, "w");
+    assert(fd != NULL);
+
+    dr = SC_RC / (N_TABLE - 1);
+    drho = 300.0 / (N_TABLE - 1);
+
+    fprintf(fd, "Sutton-Chen Ag written by test10\n");
+    fprintf(fd, "47 107.87 %.4f fcc\n", SC_A);
+    fprintf(fd, "%d %.15e %d %.15e %.15e\n", N_TABLE, drho, N_TABLE, dr, SC_RC);
+
+    for (k = 0; k < N_TABLE; k++)
+        fprintf(fd, "%.15e\n", -SC_EPS * SC_C * sqrt(k * drho));
+    for (k = 0; k < N_TABLE; k++)
+        fprintf(fd, "%.15e\n", sqrt((k > 0 ? k : 1) * dr * shifted((k > 0 ? k : 1) * dr, SC_N, SC_EPS) / 14.388));
+    for (k = 0; k < N_TABLE; k++)
+        fprintf(fd, "%.15e\n", shifted((k > 0 ? k : 1) * dr, SC_M, 1));
+
+    fclose(fd);
+}
+
+/*
+ * Energy and forces with the current potential and neighbour lists
+ */
+static double energy_forces(double f[])
+{
+    int i;
+    double U;
+
+    U = eval_U_and_forces();
+    for (i = 0; i < N; i++)
+    {
+        f[3 * i] = Fxx[i];
+        f[3 * i + 1] = Fyy[i];
+        f[3 * i + 2] = Fzz[i];
+    }
+
+    return U;
+}
+
+/*
+ * Microseconds per atom and per force evaluation
+ */
+static double time_forces(void)
+{
+    int k;
+    clock_t start;
+
+    start = clock();
+    for (k = 0; k < N_EVAL; k++)
+        eval_U_and_forces();
+
+    return 1e6 * (clock() - start) / CLOCKS_PER_SEC / ((double)N_EVAL * N);
+}
+
+static double mean_nbrs(void)
+{
+    int i;
+    double n;
+
+    n = 0;
+    for (i = 0; i < N; i++)
+        n += (double)number_nbrs[i] / N;
+
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, k, n_forces;
+    char file_name[100], eam_file[] = "../../data/test_files/sutton_chen_ag.eam";
+    double *f, *g, U, U_file, u_plus, u_minus, *x, err, max_err, E0, E, drift, t_lj, t_eam, t_eam_rc;
+
+    f = (double *)malloc(6 * N * sizeof(double));
+    assert(f != NULL);
+    g = f + 3 * N;
+
+    sprintf(file_name, "../../data/input_files/fcc100a%d.dat", N);
+    load_data(file_name);
+
+    set_eam_sutton_chen(SC_EPS, SC_C, SC_A, SC_N, SC_M, SC_RC);
+    eval_nbrs();
+    U = energy_forces(f);
+    printf("Sutton-Chen Ag, rc = %.2f A: U = %.6f eV, eval_U() - U = %.1e eV\n", SC_RC, U,
+           eval_U() - U);
+
+    /*finite differences on the atoms 0, N/N_CHECK, ...*/
+    max_err = 0;
+    for (i = 0; i < N; i += N / N_CHECK)
+    {
+        for (k = 0; k < 3; k++)
+        {
+            x = (k == 0) ? xx + i : (k == 1) ? yy + i : zz + i;
+            *x += H_DIFF;
+            u_plus = eval_U();
+            *x -= 2 * H_DIFF;
+            u_minus = eval_U();
+            *x += H_DIFF;
+
+            err = fabs(-(u_plus - u_minus) / (2 * H_DIFF) - f[3 * i + k]);
+            if (err > max_err)
+                max_err = err;
+        }
+    }
+    printf("max |F - finite differences| = %.1e eV/A\n", max_err);
+
+    write_funcfl(eam_file);
+    load_eam(eam_file);
+    remove(eam_file);
+    eval_nbrs();
+    U_file = energy_forces(g);
+
+    max_err = 0;
+    for (i = 0; i < 3 * N; i++)
+        if (fabs(f[i] - g[i]) > max_err)
+            max_err = fabs(f[i] - g[i]);
+    printf("funcfl tables: U - U(funcfl) = %.1e eV, max force difference %.1e eV/A\n", U - U_file,
+           max_err);
+
+    use_eam(0);
+    eval_nbrs();
+    t_lj = time_forces();
+    printf("pair potential, rc = %.2f A: %5.2f neighbours, %.3f us per atom-step\n",
+           get_potential()->rc, mean_nbrs(), t_lj);
+
+    set_eam_sutton_chen(SC_EPS, SC_C, SC_A, SC_N, SC_M, RC);
+    eval_nbrs();
+    t_eam_rc = time_forces();
+    printf("EAM,            rc = %.2f A: %5.2f neighbours, %.3f us per atom-step (%.2f x)\n", RC,
+           mean_nbrs(), t_eam_rc, t_eam_rc / t_lj);
+
+    set_eam_sutton_chen(SC_EPS, SC_C, SC_A, SC_N, SC_M, SC_RC);
+    eval_nbrs();
+    t_eam = time_forces();
+    printf("EAM,            rc = %.2f A: %5.2f neighbours, %.3f us per atom-step (%.2f x)\n",
+           SC_RC, mean_nbrs(), t_eam, t_eam / t_lj);
+
+    n_forces = lbfgs("");
+    assert(n_forces > 0);
+    printf("L-BFGS: %d force evaluations, U/N = %.6f eV, max force %.1e eV/A\n", n_forces,
+           eval_U() / N, eval_max_force());
+
+    generate_inital_v();
+    eval_nbrs();
+    eval_forces();
+    E0 = eval_U() + eval_K();
+    drift = 0;
+    for (k = 0; k < N_STEPS; k++)
+    {
+        verlet_evolution();
+        E = eval_U() + eval_K();
+        if (fabs(E - E0) > drift)
+            drift = fabs(E - E0);
+    }
+    printf("Verlet, %d steps at T_INIT = %d K: T = %.2f K, max |E - E0| = %.1e eV\n", N_STEPS,
+           T_INIT, eval_temperature(), drift);
+
+    free_eam();
+    free_all();
+    free(f);
+
+    return 0;
+}
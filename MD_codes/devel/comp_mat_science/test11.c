@@ -0,0 +1,236 @@
+/*******************************************************************************
+ *
+ * File test11.c
+ *
+ * Test of the reordering of the atoms along a Morton curve (reorder_atoms()
+ * in lattice.c) on a cube of L^3 fcc cells, N = 4*L^3, whose atoms are
+ * stored in random order, as after a long diffusion:
+ *  - energy and forces, in the original order of the atoms, are the same
+ *    before and after the reordering;
+ *  - CPU time per atom of the forces and L1 and last level cache misses
+ *    per atom (n/a where the counters are not available, see perfcount.c)
+ *    with the random and with the Morton order;
+ *  - N_STEPS steps of verlet_evolution() with the atoms reordered every
+ *    REORDER_EVERY builds of the lists give the same trajectory, written
+ *    in the original order, as without reordering.
+ * Larger systems are obtained compiling with -DN=4*L^3, e.g. -DN=32000.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include "perfcount.h"
+#include <assert.h>
+
+#define FCC_A 4.1604 /*A*/
+#define DISPLACEMENT 0.05 /*A*/
+#define N_EVAL (1 + 2000000 / N)
+#define N_STEPS (1 + 51200 / N)
+#define REORDER_EVERY 10
+
+/*
+ * Fcc cube with the atoms in random order (Fisher-Yates shuffle), slightly
+ * displaced from the sites, written on file_name
+ */
+static void write_shuffled_fcc(char file_name[])
+{
+    int i, j, l, cells, *site;
+    double basis[4][3] = {{0, 0, 0}, {0.5, 0.5, 0}, {0.5, 0, 0.5}, {0, 0.5, 0.5}}, r[4];
+    phx_state_t st;
+    FILE *fd;
+
+    cells = (int)(pow(N / 4.0, 1.0 / 3) + 0.5);
+    assert(4 * cells * cells * cells == N);
+
+    site = (int *)malloc(N * sizeof(int));
+    assert(site != NULL);
+    for (i = 0; i < N; i++)
+        site[i] = i;
+
+    fd = fopen(file_name, "w");
+    assert(fd != NULL);
+
+    for (i = N - 1; i >= 0; i--)
+    {
+        phx_init_r(&st, 1911, 0, i, 0);
+        ranphx_r(&st, r, 4);
+        j = (int)(r[0] * (i + 1));
+        l = site[j];
+        site[j] = site[i];
+        site[i] = l;
+
+        /*site l: cell l/4, basis atom l%4*/
+        fprintf(fd, "%.15e %.15e %.15e\n",
+                FCC_A * ((l / 4) % cells + basis[l % 4][0]) + DISPLACEMENT * (r[1] - 0.5),
+                FCC_A * ((l / 4 / cells) % cells + basis[l % 4][1]) + DISPLACEMENT * (r[2] - 0.5),
+                FCC_A * (l / 4 / cells / cells + basis[l % 4][2]) + DISPLACEMENT * (r[3] - 0.5));
+    }
+
+    fclose(fd);
+    free(site);
+}
+
+/*
+ * Energy and forces in the original order of the atoms
+ */
+static double energy_forces(double f[])
+{
+    int i;
+    double U;
+
+    U = eval_U_and_forces();
+    for (i = 0; i < N; i++)
+    {
+        f[3 * atom_id[i]] = Fxx[i];
+        f[3 * atom_id[i] + 1] = Fyy[i];
+        f[3 * atom_id[i] + 2] = Fzz[i];
+    }
+
+    return U;
+}
+
+/*
+ * Microseconds per atom and per force evaluation, counters in the region
+ */
+static double time_forces(char region[])
+{
+    int k;
+    clock_t start;
+
+    start = clock();
+    perf_start(region);
+    for (k = 0; k < N_EVAL; k++)
+        eval_U_and_forces();
+    perf_stop(region);
+
+    return 1e6 * (clock() - start) / CLOCKS_PER_SEC / ((double)N_EVAL * N);
+}
+
+static void print_misses(char region[], char label[], int event)
+{
+    double count;
+
+    count = perf_count(region, event);
+    if (count < 0)
+        printf(", %s n/a", label);
+    else
+        printf(", %s %.3f", label, count / ((double)N_EVAL * N));
+}
+
+/*
+ * Mean distance in memory between an atom and its neighbours
+ */
+static double mean_stride(void)
+{
+    int i, j;
+    double stride, n;
+
+    stride = 0;
+    n = 0;
+    for (i = 0; i < N; i++)
+        for (j = 0; j < number_nbrs[i]; j++)
+        {
+            stride += abs(which_nbrs[i][j] - i);
+            n++;
+        }
+
+    return stride / n;
+}
+
+/*
+ * Evolves N_STEPS steps from the shuffled lattice, reordering the atoms
+ * every "every" builds, and writes the final positions in the original
+ * order in x
+ */
+static double evolve(char file_name[], int every, double x[])
+{
+    int i, k;
+    clock_t start;
+
+    load_data(file_name);
+    set_reordering(every);
+    eval_nbrs();
+    eval_forces();
+    generate_inital_v();
+
+    start = clock();
+    for (k = 0; k < N_STEPS; k++)
+        verlet_evolution();
+
+    for (i = 0; i < N; i++)
+    {
+        x[3 * i] = xx[atom_slot[i]];
+        x[3 * i + 1] = yy[atom_slot[i]];
+        x[3 * i + 2] = zz[atom_slot[i]];
+    }
+
+    return 1e3 * (clock() - start) / CLOCKS_PER_SEC / N_STEPS;
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+    char file_name[100];
+    double *f, *g, U, U_morton, max_diff, t_shuffled, t_morton;
+
+    f = (double *)malloc(6 * N * sizeof(double));
+    assert(f != NULL);
+    g = f + 3 * N;
+
+    sprintf(file_name, "../../data/test_files/shuffled_fcc%d.dat", N);
+    write_shuffled_fcc(file_name);
+    load_data(file_name);
+
+    printf("N = %d, %d force evaluations, %d hardware counters available\n", N, N_EVAL,
+           perf_available());
+
+    eval_nbrs();
+    U = energy_forces(f);
+    printf("random order: mean |i - k| of the neighbours %8.1f", mean_stride());
+    t_shuffled = time_forces("random");
+    printf(", %.4f us per atom-step", t_shuffled);
+    print_misses("random", "L1 misses", PERF_L1D_MISSES);
+    print_misses("random", "LLC misses", PERF_LLC_MISSES);
+    printf("\n");
+
+    reorder_atoms();
+    eval_nbrs();
+    U_morton = energy_forces(g);
+    printf("Morton order: mean |i - k| of the neighbours %8.1f", mean_stride());
+    t_morton = time_forces("morton");
+    printf(", %.4f us per atom-step", t_morton);
+    print_misses("morton", "L1 misses", PERF_L1D_MISSES);
+    print_misses("morton", "LLC misses", PERF_LLC_MISSES);
+    printf("\n");
+
+    max_diff = 0;
+    for (i = 0; i < 3 * N; i++)
+        if (fabs(f[i] - g[i]) > max_diff)
+            max_diff = fabs(f[i] - g[i]);
+    printf("speedup %.2f, U - U(Morton) = %.1e eV, max force difference %.1e eV/A\n",
+           t_shuffled / t_morton, U - U_morton, max_diff);
+
+    t_shuffled = evolve(file_name, 0, f);
+    t_morton = evolve(file_name, REORDER_EVERY, g);
+    remove(file_name);
+
+    max_diff = 0;
+    for (i = 0; i < 3 * N; i++)
+        if (fabs(f[i] - g[i]) > max_diff)
+            max_diff = fabs(f[i] - g[i]);
+    printf("Verlet, %d steps: %.3f ms per step, %.3f ms reordering every %d builds, "
+           "max position difference %.1e A\n",
+           N_STEPS, t_shuffled, t_morton, REORDER_EVERY, max_diff);
+
+    free_all();
+    free(f);
+
+    return 0;
+}
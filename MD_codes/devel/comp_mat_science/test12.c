@@ -0,0 +1,222 @@
+/*******************************************************************************
+ *
+ * File test12.c
+ *
+ * Periodic boundary conditions with ghost atoms (use_ghosts() in lattice.c)
+ * against the minimum image convention, on bulk fcc: a cube of L^3 cells,
+ * N = 4*L^3, periodic along the three directions. For the pair potential
+ * and for the Sutton-Chen EAM prints
+ *  - the number of ghosts and the differences of energy and forces between
+ *    the two methods;
+ *  - CPU time per atom of the forces with both;
+ *  - the time per step and the largest difference of the positions after
+ *    N_STEPS steps of verlet_evolution().
+ * The energy is also compared in an orthorhombic box, longer by VACUUM
+ * along z (a slab with two free surfaces). Larger systems are obtained
+ * compiling with -DN=4*L^3, e.g. -DN=4000.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include "eam.h"
+#include <assert.h>
+
+#define FCC_A 4.1604      /*A*/
+#define SC_FCC_A 4.09     /*A*/
+#define DISPLACEMENT 0.05 /*A*/
+#define VACUUM 10.0       /*A*/
+#define N_EVAL (1 + 1000000 / N)
+#define N_STEPS (1 + 25600 / N)
+
+/*
+ * Fcc cube of cells of side a, slightly displaced from the sites, written on
+ * file_name, returns the side of the cube
+ */
+static double write_fcc(char file_name[], double a)
+{
+    int l, cells;
+    double basis[4][3] = {{0, 0, 0}, {0.5, 0.5, 0}, {0.5, 0, 0.5}, {0, 0.5, 0.5}}, r[3];
+    phx_state_t st;
+    FILE *fd;
+
+    cells = (int)(pow(N / 4.0, 1.0 / 3) + 0.5);
+    assert(4 * cells * cells * cells == N);
+
+    fd = fopen(file_name, "w");
+    assert(fd != NULL);
+
+    for (l = 0; l < N; l++)
+    {
+        phx_init_r(&st, 1912, 0, l, 0);
+        ranphx_r(&st, r, 3);
+        fprintf(fd, "%.15e %.15e %.15e\n",
+                a * ((l / 4) % cells + basis[l % 4][0]) + DISPLACEMENT * (r[0] - 0.5),
+                a * ((l / 4 / cells) % cells + basis[l % 4][1]) + DISPLACEMENT * (r[1] - 0.5),
+                a * (l / 4 / cells / cells + basis[l % 4][2]) + DISPLACEMENT * (r[2] - 0.5));
+    }
+
+    fclose(fd);
+
+    return a * cells;
+}
+
+static double energy_forces(double f[])
+{
+    int i;
+    double U;
+
+    U = eval_U_and_forces();
+    for (i = 0; i < N; i++)
+    {
+        f[3 * i] = Fxx[i];
+        f[3 * i + 1] = Fyy[i];
+        f[3 * i + 2] = Fzz[i];
+    }
+
+    return U;
+}
+
+/*
+ * Microseconds per atom and per force evaluation
+ */
+static double time_forces(void)
+{
+    int k;
+    clock_t start;
+
+    start = clock();
+    for (k = 0; k < N_EVAL; k++)
+        eval_U_and_forces();
+
+    return 1e6 * (clock() - start) / CLOCKS_PER_SEC / ((double)N_EVAL * N);
+}
+
+static double max_difference(double a[], double b[], int n)
+{
+    int i;
+    double max;
+
+    max = 0;
+    for (i = 0; i < n; i++)
+        if (fabs(a[i] - b[i]) > max)
+            max = fabs(a[i] - b[i]);
+
+    return max;
+}
+
+/*
+ * Milliseconds per step of N_STEPS steps of Verlet from the positions of
+ * file_name, final positions in x
+ */
+static double evolve(char file_name[], double x[])
+{
+    int i, k;
+    clock_t start;
+
+    load_data(file_name);
+    eval_nbrs();
+    eval_forces();
+    generate_inital_v();
+
+    start = clock();
+    for (k = 0; k < N_STEPS; k++)
+        verlet_evolution();
+
+    for (i = 0; i < N; i++)
+    {
+        x[3 * i] = xx[i];
+        x[3 * i + 1] = yy[i];
+        x[3 * i + 2] = zz[i];
+    }
+
+    return 1e3 * (clock() - start) / CLOCKS_PER_SEC / N_STEPS;
+}
+
+/*
+ * Compares minimum image and ghosts with the current potential on the
+ * lattice of file_name in a periodic cube of side l
+ */
+static void compare(char name[], char file_name[], double l, double *f, double *g)
+{
+    double U, U_ghosts, t, t_ghosts, step, step_ghosts;
+    halo_t *h;
+
+    load_data(file_name);
+    set_box(l, l, l, 1, 1, 1);
+
+    use_ghosts(0);
+    eval_nbrs();
+    U = energy_forces(f);
+    t = time_forces();
+
+    use_ghosts(1);
+    eval_nbrs();
+    h = get_halo();
+    assert(h != NULL);
+    U_ghosts = energy_forces(g);
+    t_ghosts = time_forces();
+
+    printf("%s: %d ghosts, U/N = %.6f eV, U - U(ghosts) = %.1e eV, max force difference "
+           "%.1e eV/A\n",
+           name, h->n - N, U / N, U - U_ghosts, max_difference(f, g, 3 * N));
+    printf("%s: forces %.3f us per atom-step with the minimum image, %.3f with the ghosts "
+           "(%.2f x)\n",
+           name, t, t_ghosts, t / t_ghosts);
+
+    use_ghosts(0);
+    step = evolve(file_name, f);
+    use_ghosts(1);
+    step_ghosts = evolve(file_name, g);
+    printf("%s: Verlet, %d steps, %.3f ms per step with the minimum image, %.3f with the "
+           "ghosts, max position difference %.1e A\n",
+           name, N_STEPS, step, step_ghosts, max_difference(f, g, 3 * N));
+
+    /*slab: vacuum along z*/
+    set_box(l, l, l + VACUUM, 1, 1, 1);
+    load_data(file_name);
+    use_ghosts(0);
+    eval_nbrs();
+    U = eval_U();
+    use_ghosts(1);
+    eval_nbrs();
+    U_ghosts = eval_U();
+    printf("%s: slab in a %.2f x %.2f x %.2f A box, U/N = %.6f eV, U - U(ghosts) = %.1e eV\n",
+           name, l, l, l + VACUUM, U / N, U - U_ghosts);
+
+    use_ghosts(0);
+}
+
+int main(int argc, char *argv[])
+{
+    char file_name[100];
+    double *f, *g, l;
+
+    f = (double *)malloc(6 * N * sizeof(double));
+    assert(f != NULL);
+    g = f + 3 * N;
+
+    printf("N = %d, %d force evaluations\n", N, N_EVAL);
+    sprintf(file_name, "../../data/test_files/bulk_fcc%d.dat", N);
+
+    l = write_fcc(file_name, FCC_A);
+    compare("pair", file_name, l, f, g);
+
+    l = write_fcc(file_name, SC_FCC_A);
+    set_eam_sutton_chen(SC_EPS, SC_C, SC_A, SC_N, SC_M, SC_RC);
+    compare("EAM ", file_name, l, f, g);
+    remove(file_name);
+
+    free_eam();
+    free_all();
+    free(f);
+
+    return 0;
+}
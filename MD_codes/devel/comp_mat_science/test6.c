@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *
+ * File test6.c
+ *
+ * Test of the thermostats: for the Langevin and the Nose-Hoover chain
+ * thermostats, thermalizes at T_TARGET with thermalization_nvt() and
+ * prints the mean and the standard deviation of the temperature over
+ * TOT_TIME, to be compared with the canonical T*sqrt(2/(3N)), and the
+ * largest change of the energy conserved by the chain. The time spent in
+ * the phases of the evolution and the hardware counters of the neighbour
+ * lists and of the forces are printed at the end (see timers.c and
+ * perfcount.c).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include "timers.h"
+#include "perfcount.h"
+#include <assert.h>
+
+int main(int argc, char *argv[])
+{
+    int k, n;
+    char file_name[100];
+    double coupling[2] = {GAMMA, TAU_NH}, temp, mean, var, e0, drift;
+
+    sprintf(file_name, "../../data/input_files/fcc100a%d.dat", N);
+
+    printf("Canonical standard deviation of T: %f K\n", T_TARGET * sqrt(2.0 / (3 * N)));
+
+    for (k = LANGEVIN; k <= NOSE_HOOVER; k++)
+    {
+        load_data(file_name);
+        thermalization_nvt("", k, T_TARGET, coupling[k]);
+
+        mean = 0;
+        var = 0;
+        drift = 0;
+        e0 = eval_nose_hoover_energy(T_TARGET, coupling[k]);
+
+        for (n = 0; n * DT < TOT_TIME; n++)
+        {
+            nvt_evolution(k, T_TARGET, coupling[k]);
+            temp = eval_temperature();
+            mean += temp;
+            var += temp * temp;
+
+            if (k == NOSE_HOOVER)
+            {
+                temp = fabs(eval_nose_hoover_energy(T_TARGET, coupling[k]) - e0);
+                if (temp > drift)
+                    drift = temp;
+            }
+        }
+
+        mean /= n;
+        var = var / n - mean * mean;
+
+        printf("%s (coupling %.1e): T = %f K, standard deviation %f K",
+               (k == LANGEVIN) ? "Langevin" : "Nose-Hoover", coupling[k], mean, sqrt(var));
+        if (k == NOSE_HOOVER)
+            printf(", max change of the conserved energy %.2e eV", drift);
+        printf("\n");
+    }
+
+    TIMERS_PRINT(stdout);
+    PERF_PRINT(stdout);
+    free_all();
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *
+ * File test7.c
+ *
+ * Comparison of the minimizers: relaxes the fcc100a input with
+ * steepest_descent() and with fire() until the largest force is smaller
+ * than MAX_FORCE and prints the force evaluations, the wall time and the
+ * final energy of both.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include <assert.h>
+
+int main(int argc, char *argv[])
+{
+    int n_forces;
+    char file_name[100];
+    double seconds, U0;
+    clock_t start;
+
+    sprintf(file_name, "../../data/input_files/fcc100a%d.dat", N);
+    load_data(file_name);
+    eval_nbrs();
+    U0 = eval_U();
+
+    printf("N = %d, U = %f eV, MAX_FORCE = %.1e eV/A\n", N, U0, MAX_FORCE);
+
+    start = clock();
+    n_forces = steepest_descent("");
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("steepest descent: %6d force evaluations, %8.3f s, U = %.6f eV, max force %.2e eV/A\n",
+           n_forces, seconds, eval_U(), eval_max_force());
+
+    load_data(file_name);
+
+    start = clock();
+    n_forces = fire("");
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("FIRE:             %6d force evaluations, %8.3f s, U = %.6f eV, max force %.2e eV/A\n",
+           n_forces, seconds, eval_U(), eval_max_force());
+
+    free_all();
+
+    return 0;
+}
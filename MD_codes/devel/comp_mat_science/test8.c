@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ * File test8.c
+ *
+ * Comparison of the minimizers on the fcc100a input, as it is and with
+ * every atom displaced at random by up to 0.3 A: force evaluations, wall
+ * time and final energy of steepest_descent(), fire() and lbfgs() with the
+ * criterion MAX_FORCE. Also checks that eval_U_and_forces() gives the
+ * energy of eval_U() and the forces of eval_forces().
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include <assert.h>
+
+#define DISPLACEMENT 0.3 /*A*/
+
+static void load_input(int displace)
+{
+    int i;
+    char file_name[100];
+    double r[3];
+    phx_state_t st;
+
+    sprintf(file_name, "../../data/input_files/fcc100a%d.dat", N);
+    load_data(file_name);
+
+    if (displace)
+    {
+        for (i = 0; i < N; i++)
+        {
+            phx_init_r(&st, 3122000, 2, i, 0);
+            ranphx_r(&st, r, 3);
+            xx[i] += DISPLACEMENT * (2 * r[0] - 1) / sqrt(3);
+            yy[i] += DISPLACEMENT * (2 * r[1] - 1) / sqrt(3);
+            zz[i] += DISPLACEMENT * (2 * r[2] - 1) / sqrt(3);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, k, n_forces;
+    char *names[3] = {"steepest descent", "FIRE", "L-BFGS"};
+    double seconds, U, diff, Fx[N];
+    clock_t start;
+
+    load_input(1);
+    eval_nbrs();
+    eval_forces();
+    U = eval_U();
+
+    for (i = 0; i < N; i++)
+        Fx[i] = Fxx[i];
+
+    diff = fabs(eval_U_and_forces() - U);
+    for (i = 0; i < N; i++)
+        if (fabs(Fxx[i] - Fx[i]) > diff)
+            diff = fabs(Fxx[i] - Fx[i]);
+
+    printf("max |eval_U_and_forces() - (eval_U(), eval_forces())| = %.2e\n", diff);
+    printf("N = %d, MAX_FORCE = %.1e eV/A\n", N, MAX_FORCE);
+
+    for (i = 0; i < 2; i++)
+    {
+        load_input(i);
+        eval_nbrs();
+        printf("%s input, U = %f eV\n", (i == 0) ? "fcc100a" : "Displaced", eval_U());
+
+        for (k = 0; k < 3; k++)
+        {
+            load_input(i);
+
+            start = clock();
+            if (k == 0)
+                n_forces = steepest_descent("");
+            else if (k == 1)
+                n_forces = fire("");
+            else
+                n_forces = lbfgs("");
+            seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+            assert(n_forces > 0);
+
+            printf("  %-16s %6d force evaluations, %8.3f s, U = %.6f eV, max force %.2e eV/A\n",
+                   names[k], n_forces, seconds, eval_U(), eval_max_force());
+        }
+    }
+
+    free_all();
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *
+ * File test9.c
+ *
+ * Cutoff convergence of the relaxed fcc lattice with set_potential(). For
+ * cutoffs rc from RC_MIN to RC_MAX with the junction starting JUNCTION
+ * before rc, prints the largest mismatch at rp of the potential and of its
+ * first derivative between Lennard Jones and the polinomial, their values
+ * at rc (all should vanish), the mean number of neighbours and the energy
+ * per atom after the relaxation with lbfgs().
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include <assert.h>
+
+#define RC_MIN 4.0   /*A*/
+#define RC_MAX 6.0   /*A*/
+#define RC_STEP 0.5  /*A*/
+#define JUNCTION 0.5 /*A*/
+
+/*
+ * Lennard Jones (lj != 0) or polinomial part of the potential at r, with
+ * the derivative in *du
+ */
+static double branch(potential_t *p, double r, int lj, double *du)
+{
+    int k;
+    double u, inv2, inv6;
+
+    if (lj)
+    {
+        inv2 = 1 / (r * r);
+        inv6 = inv2 * inv2 * inv2;
+        *du = -r * inv6 * inv2 * (p->f12 * inv6 - p->f6);
+
+        return inv6 * (p->c12 * inv6 - p->c6);
+    }
+
+    /*U'(r) = -r*(dpoly[0]/r + dpoly[1] + ...)*/
+    u = 0;
+    *du = 0;
+    for (k = 7; k >= 0; k--)
+        u = u * r + p->poly[k];
+    for (k = 6; k >= 0; k--)
+        *du = *du * r - p->dpoly[k];
+
+    return u;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, n_forces;
+    char file_name[100];
+    double rc, u_lj, u_poly, du_lj, du_poly, u_rc, du_rc, nbrs, U;
+    potential_t *p;
+
+    sprintf(file_name, "../../data/input_files/fcc100a%d.dat", N);
+
+    printf("rc     rp     dU(rp)    dU'(rp)   U(rc)     U'(rc)    nbrs   forces  U/N (eV)\n");
+
+    for (rc = RC_MIN; rc < RC_MAX + RC_STEP / 2; rc += RC_STEP)
+    {
+        set_potential(EPS, SIGMA, rc, rc - JUNCTION);
+        p = get_potential();
+
+        u_lj = branch(p, p->rp, 1, &du_lj);
+        u_poly = branch(p, p->rp, 0, &du_poly);
+        u_rc = branch(p, p->rc, 0, &du_rc);
+
+        load_data(file_name);
+        n_forces = lbfgs("");
+        assert(n_forces > 0);
+        U = eval_U();
+
+        nbrs = 0;
+        for (i = 0; i < N; i++)
+            nbrs += (double)number_nbrs[i] / N;
+
+        printf("%.2f   %.2f   %.1e   %.1e   %.1e   %.1e   %5.2f  %6d  %.6f\n", p->rc, p->rp,
+               fabs(u_lj - u_poly), fabs(du_lj - du_poly), fabs(u_rc), fabs(du_rc), nbrs,
+               n_forces, U / N);
+    }
+
+    free_all();
+
+    return 0;
+}
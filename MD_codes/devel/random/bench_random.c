@@ -0,0 +1,323 @@
+
+/*******************************************************************************
+*
+* File bench_random.c
+*
+* Cost and statistical smoke test of all random number generators, written
+* to stdout in JSON format (e.g. ./bench_random > bench.json).
+*
+* The timing section lists, for every kernel of the ranlux update available
+* on this machine, ranlxs at the levels 0,1,2, ranlxd and the buffered
+* generator at the levels 1,2 and the Gaussian generators gauss, gauss_dble,
+* gauss_dble_block and gauss_dble_zig, plus the counter-based generator
+* (which does not depend on the kernel). Each entry is produced in calls of
+* a given batch size, from 1 to 10^6 numbers, and gives the processor time
+* per number in ns and the rate at which the output is written in GB/s.
+*
+* The quality section applies to NQUAL numbers of every generator a smoke
+* test: mean, variance, chi^2 in NBINS bins (uniform numbers only), fourth
+* moment (Gaussian numbers only) and correlation of consecutive numbers.
+* Every test is given as a deviation z in units of its expected standard
+* deviation, and a generator passes if |z|<5 for all of them. The Gaussian
+* numbers have the distribution exp(-x^2) of gauss.c (variance 1/2).
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "random.h"
+
+#define NTOT 2000000
+#define NQUAL 1000000
+#define MAXBATCH 1000000
+#define NBINS 100
+#define ZMAX 5.0
+
+#define RANLXS 0
+#define RANLXD 1
+#define RANBUF 2
+#define RANPHX 3
+#define GAUSS 4
+#define GAUSS_DBLE 5
+#define GAUSS_BLOCK 6
+#define GAUSS_ZIG 7
+#define NGEN 8
+
+static char *gen_name[NGEN]={"ranlxs","ranlxd","ranbuf","ranphx","gauss",
+                             "gauss_dble","gauss_dble_block","gauss_dble_zig"};
+static int gen_bytes[NGEN]={4,8,8,8,4,8,8,8};
+static int gen_gauss[NGEN]={0,0,0,0,1,1,1,1};
+
+static int first=1;
+static float *rs;
+static double *rd;
+static ranbuf_t *rb;
+static phx_state_t st;
+
+
+static void init_gen(int g,int level)
+{
+   if (g==RANLXS)
+      rlxs_init(level,1);
+   else if (g==RANBUF)
+      ranbuf_init(rb,level,1);
+   else if (g==RANPHX)
+      phx_init_r(&st,1,0,0,0);
+   else if (g==GAUSS)
+      rlxs_init(level,1);
+   else
+      rlxd_init(level,1);
+}
+
+
+static void generate(int g,int n)
+{
+   int k;
+
+   if (g==RANLXS)
+      ranlxs(rs,n);
+   else if (g==RANLXD)
+      ranlxd(rd,n);
+   else if (g==RANBUF)
+   {
+      for (k=0;k<n;k++)
+         rd[k]=ranbuf_double(rb);
+   }
+   else if (g==RANPHX)
+      ranphx_r(&st,rd,n);
+   else if (g==GAUSS)
+      gauss(rs,n);
+   else if (g==GAUSS_DBLE)
+      gauss_dble(rd,n);
+   else if (g==GAUSS_BLOCK)
+      gauss_dble_block(rd,n);
+   else
+      gauss_dble_zig(rd,n);
+}
+
+
+static void time_gen(int g,char *kernel,int level)
+{
+   int k,n,nloops;
+   double t1,t2,dt,ns,gbs;
+
+   for (n=1;n<=MAXBATCH;n*=10)
+   {
+      init_gen(g,level);
+      nloops=NTOT/n;
+
+      t1=(double)clock();
+      for (k=0;k<nloops;k++)
+         generate(g,n);
+      t2=(double)clock();
+
+      dt=(t2-t1)/(double)(CLOCKS_PER_SEC);
+      ns=1.0e9*dt/((double)(n)*(double)(nloops));
+      gbs=0.0;
+      if (dt>0.0)
+         gbs=(double)(gen_bytes[g])*(double)(n)*(double)(nloops)/dt*1.0e-9;
+
+      printf("%s\n    {\"generator\": \"%s\", \"kernel\": \"%s\", ",
+             first?"":",",gen_name[g],kernel);
+      printf("\"level\": %d, \"batch\": %d, \"ns_per_number\": %.3f, ",
+             level,n,ns);
+      printf("\"gb_per_s\": %.4f}",gbs);
+      first=0;
+   }
+}
+
+
+static void time_kernel(char *kernel)
+{
+   int level;
+
+   for (level=0;level<=2;level++)
+      time_gen(RANLXS,kernel,level);
+
+   for (level=1;level<=2;level++)
+      time_gen(RANLXD,kernel,level);
+
+   for (level=1;level<=2;level++)
+      time_gen(RANBUF,kernel,level);
+
+   time_gen(GAUSS,kernel,1);
+   time_gen(GAUSS_DBLE,kernel,1);
+   time_gen(GAUSS_BLOCK,kernel,1);
+   time_gen(GAUSS_ZIG,kernel,1);
+}
+
+
+static double zscore(double x,double mu,double var,int n)
+{
+   return (x-mu)/sqrt(var/(double)(n));
+}
+
+
+static int quality(int g,int level)
+{
+   int k,n,bin,hist[NBINS],pass;
+   double x,xp,m1,m2,m4,c1,var,chi2,e;
+   double z[4];
+
+   init_gen(g,level);
+   generate(g,NQUAL);
+   n=NQUAL;
+
+   for (k=0;k<NBINS;k++)
+      hist[k]=0;
+
+   m1=0.0;
+   m2=0.0;
+   m4=0.0;
+   c1=0.0;
+   xp=0.0;
+
+   for (k=0;k<n;k++)
+   {
+      if (gen_bytes[g]==4)
+         x=(double)(rs[k]);
+      else
+         x=rd[k];
+
+      if (gen_gauss[g]==0)
+      {
+         bin=(int)(x*(double)(NBINS));
+         if ((bin<0)||(bin>=NBINS))
+            bin=0;
+         hist[bin]+=1;
+         x-=0.5;
+      }
+
+      m1+=x;
+      m2+=x*x;
+      m4+=x*x*x*x;
+      if (k>0)
+         c1+=x*xp;
+      xp=x;
+   }
+
+   m1/=(double)(n);
+   m2/=(double)(n);
+   m4/=(double)(n);
+   c1/=(double)(n-1);
+
+   if (gen_gauss[g]==0)
+   {
+      /* u-1/2: <x^2>=1/12, <x^4>=1/80 */
+      var=1.0/12.0;
+      z[0]=zscore(m1,0.0,var,n);
+      z[1]=zscore(m2,var,1.0/80.0-var*var,n);
+
+      e=(double)(n)/(double)(NBINS);
+      chi2=0.0;
+      for (k=0;k<NBINS;k++)
+         chi2+=((double)(hist[k])-e)*((double)(hist[k])-e)/e;
+      z[2]=(chi2-(double)(NBINS-1))/sqrt(2.0*(double)(NBINS-1));
+   }
+   else
+   {
+      /* exp(-x^2): <x^2>=1/2, <x^4>=3/4, <x^8>=105/16 */
+      var=0.5;
+      z[0]=zscore(m1,0.0,var,n);
+      z[1]=zscore(m2,var,0.75-0.25,n);
+      z[2]=zscore(m4,0.75,105.0/16.0-9.0/16.0,n);
+   }
+
+   z[3]=zscore(c1,0.0,var*var,n);
+
+   pass=1;
+   for (k=0;k<4;k++)
+   {
+      if (fabs(z[k])>=ZMAX)
+         pass=0;
+   }
+
+   printf("%s\n    {\"generator\": \"%s\", \"level\": %d, \"n\": %d, ",
+          first?"":",",gen_name[g],level,n);
+   printf("\"z_mean\": %.3f, \"z_variance\": %.3f, ",z[0],z[1]);
+   if (gen_gauss[g]==0)
+      printf("\"z_chi2\": %.3f, ",z[2]);
+   else
+      printf("\"z_moment4\": %.3f, ",z[2]);
+   printf("\"z_lag1\": %.3f, \"pass\": %s}",z[3],pass?"true":"false");
+   first=0;
+
+   return pass;
+}
+
+
+int main(void)
+{
+   int b,n,def,npass,ntests;
+
+   rs=malloc(MAXBATCH*sizeof(float));
+   rd=malloc(MAXBATCH*sizeof(double));
+   rb=malloc(sizeof(ranbuf_t));
+
+   if ((rs==NULL)||(rd==NULL)||(rb==NULL))
+   {
+      fprintf(stderr,"Unable to allocate the buffers\n");
+      exit(1);
+   }
+
+   printf("{\n  \"ntot\": %d,\n  \"clock\": \"processor time\",\n",NTOT);
+   def=rlx_backend();
+   printf("  \"default_kernel\": \"%s\",\n",rlx_backend_name(def));
+   printf("  \"timing\": [");
+
+   n=0;
+
+   for (b=0;b<RLX_NBACKENDS;b++)
+   {
+      if (rlx_backend_available(b))
+      {
+         rlx_set_backend(b);
+         time_kernel(rlx_backend_name(b));
+         n+=1;
+      }
+   }
+
+   if (n==0)
+      time_kernel(rlx_backend_name(def));
+   else
+      rlx_set_backend(def);
+
+   time_gen(RANPHX,"none",0);
+
+   printf("\n  ],\n  \"quality\": [");
+   first=1;
+   npass=0;
+   ntests=0;
+
+   for (b=0;b<=2;b++)
+   {
+      npass+=quality(RANLXS,b);
+      ntests+=1;
+   }
+
+   for (b=1;b<=2;b++)
+   {
+      npass+=quality(RANLXD,b);
+      npass+=quality(RANBUF,b);
+      ntests+=2;
+   }
+
+   npass+=quality(RANPHX,0);
+   npass+=quality(GAUSS,1);
+   npass+=quality(GAUSS_DBLE,1);
+   npass+=quality(GAUSS_BLOCK,1);
+   npass+=quality(GAUSS_ZIG,1);
+   ntests+=5;
+
+   printf("\n  ],\n  \"passed\": %d,\n  \"tests\": %d\n}\n",npass,ntests);
+
+   free(rs);
+   free(rd);
+   free(rb);
+   exit(0);
+}
+
@@ -4,7 +4,7 @@
 * File check1.c
 *
 * This program checks that ranlxs and ranlxd implement the basic algorithm
-* correctly
+* correctly, with every kernel of the update available on this machine
 *
 * Author: Martin Luescher <luscher@mail.cern.ch>
 *
@@ -19,7 +19,7 @@
 #define NXD 99
 
 
-int main(void)
+static void check_generators(void)
 {
    int k,test1,test2;
    int *state1,*state2;
@@ -307,6 +307,37 @@ int main(void)
       printf("=> ranlxd works correctly on this machine\n");
       printf("\n");
    }
+
+   free(state1);
+   free(state2);
+}
+
+
+int main(void)
+{
+   int b,n;
+
+   n=0;
+
+   for (b=0;b<RLX_NBACKENDS;b++)
+   {
+      if (rlx_backend_available(b))
+      {
+         rlx_set_backend(b);
+         printf("\n");
+         printf("Kernel %s:\n",rlx_backend_name(b));
+         check_generators();
+         n+=1;
+      }
+   }
+
+   if (n==0)
+   {
+      printf("\n");
+      printf("Kernel %s:\n",rlx_backend_name(rlx_backend()));
+      check_generators();
+   }
+
    exit(0);
 }
 
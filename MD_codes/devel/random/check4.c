@@ -0,0 +1,107 @@
+
+/*******************************************************************************
+*
+* File check4.c
+*
+* Generators with explicit states (ranlxs_r and ranlxd_r): two independent
+* generators with different seeds, used alternately, must produce the same
+* numbers as the generator of the file initialized with the same seeds.
+* The state of an explicit generator must be saved and restored correctly
+* by rlxd_get_r and rlxd_reset_r
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "random.h"
+
+#define N 1000
+#define NLOOPS 100
+
+
+int main(void)
+{
+   int k,l,ns,*state,errors;
+   float rs1[N],rs2[N],ss1[N],ss2[N];
+   double rd1[N],rd2[N],sd1[N],sd2[N];
+   rlxs_state_t sta,stb;
+   rlxd_state_t dta,dtb;
+
+   errors=0;
+
+   rlxs_init_r(&sta,1,1234);
+   rlxs_init_r(&stb,2,98765);
+   rlxd_init_r(&dta,1,1234);
+   rlxd_init_r(&dtb,2,98765);
+
+   for (l=0;l<NLOOPS;l++)
+   {
+      ranlxs_r(&sta,rs1,N);
+      ranlxs_r(&stb,rs2,N);
+      ranlxd_r(&dta,rd1,N);
+      ranlxd_r(&dtb,rd2,N);
+   }
+
+   rlxs_init(1,1234);
+   for (l=0;l<NLOOPS;l++)
+      ranlxs(ss1,N);
+   rlxs_init(2,98765);
+   for (l=0;l<NLOOPS;l++)
+      ranlxs(ss2,N);
+   rlxd_init(1,1234);
+   for (l=0;l<NLOOPS;l++)
+      ranlxd(sd1,N);
+   rlxd_init(2,98765);
+   for (l=0;l<NLOOPS;l++)
+      ranlxd(sd2,N);
+
+   for (k=0;k<N;k++)
+   {
+      if ((rs1[k]!=ss1[k])||(rs2[k]!=ss2[k])||
+          (rd1[k]!=sd1[k])||(rd2[k]!=sd2[k]))
+         errors++;
+   }
+
+   ns=rlxd_size();
+   state=malloc(ns*sizeof(int));
+   rlxd_get_r(&dta,state);
+   ranlxd_r(&dta,rd1,N);
+   rlxd_reset_r(&dtb,state);
+   ranlxd_r(&dtb,rd2,N);
+
+   for (k=0;k<N;k++)
+   {
+      if (rd1[k]!=rd2[k])
+         errors++;
+   }
+
+   free(state);
+   ns=rlxs_size();
+   state=malloc(ns*sizeof(int));
+   rlxs_get_r(&sta,state);
+   ranlxs_r(&sta,rs1,N);
+   rlxs_reset_r(&stb,state);
+   ranlxs_r(&stb,rs2,N);
+
+   for (k=0;k<N;k++)
+   {
+      if (rs1[k]!=rs2[k])
+         errors++;
+   }
+
+   free(state);
+
+   printf("\n");
+
+   if (errors==0)
+      printf("Explicit states and generator of the file agree\n");
+   else
+      printf("%d numbers differ => explicit states do not work\n",errors);
+
+   printf("\n");
+   exit(0);
+}
+
@@ -0,0 +1,140 @@
+
+/*******************************************************************************
+*
+* File check6.c
+*
+* Gaussian random numbers of gauss_dble, gauss_dble_block and gauss_dble_zig.
+* gauss_dble_block must reproduce gauss_dble up to rounding errors, and the
+* moments <x^2>, <x^4>, <x^6> and the tail probabilities P(|x|>t) of all
+* generators must agree with the ones of the distribution exp(-x^2) within
+* 5 standard deviations
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "random.h"
+
+#define NBLK 100001
+#define NLOOPS 100
+#define NTAIL 5
+
+static double moment[4]={1.0,0.5,0.75,1.875};
+static double sigma[4]={0.707106781186548,0.707106781186548,2.449489742783178,
+                        12.60456268829689};
+static double tail[NTAIL]={1.0,2.0,2.5,3.0,3.5};
+static double erfc_tail[NTAIL]={1.5729920705028513e-1,4.677734981047265e-3,
+                                4.069520174449589e-4,2.2090496998585438e-5,
+                                7.430983723414128e-7};
+
+
+static int check_distribution(char *name,void (*gen)(double rd[],int n))
+{
+   int k,l,i,errors;
+   double *rd,x,x2,n,sum[4],count[NTAIL],dev;
+
+   rd=malloc(NBLK*sizeof(double));
+   n=(double)(NBLK)*(double)(NLOOPS);
+   errors=0;
+
+   for (i=0;i<4;i++)
+      sum[i]=0.0;
+   for (i=0;i<NTAIL;i++)
+      count[i]=0.0;
+
+   rlxd_init(1,123456);
+
+   for (l=0;l<NLOOPS;l++)
+   {
+      gen(rd,NBLK);
+
+      for (k=0;k<NBLK;k++)
+      {
+         x=rd[k];
+         x2=x*x;
+         sum[0]+=x;
+         sum[1]+=x2;
+         sum[2]+=x2*x2;
+         sum[3]+=x2*x2*x2;
+
+         for (i=0;i<NTAIL;i++)
+         {
+            if (fabs(x)>tail[i])
+               count[i]+=1.0;
+         }
+      }
+   }
+
+   printf("%s:\n",name);
+
+   for (i=0;i<4;i++)
+   {
+      dev=(sum[i]/n-((i==0)?0.0:moment[i]))/(sigma[i]/sqrt(n));
+      printf("   <x^%d> = % .6f (expected %.6f, %+.2f sigma)\n",
+             2*i+(i==0),sum[i]/n,(i==0)?0.0:moment[i],dev);
+      if (fabs(dev)>5.0)
+         errors++;
+   }
+
+   for (i=0;i<NTAIL;i++)
+   {
+      dev=(count[i]-n*erfc_tail[i])/sqrt(n*erfc_tail[i]);
+      printf("   P(|x|>%.1f) = %.4e (expected %.4e, %+.2f sigma)\n",
+             tail[i],count[i]/n,erfc_tail[i],dev);
+      if (fabs(dev)>5.0)
+         errors++;
+   }
+
+   free(rd);
+
+   return errors;
+}
+
+
+int main(void)
+{
+   int k,errors;
+   double *rd,*sd,dmax;
+
+   rd=malloc(NBLK*sizeof(double));
+   sd=malloc(NBLK*sizeof(double));
+
+   rlxd_init(1,4321);
+   gauss_dble(rd,NBLK);
+   rlxd_init(1,4321);
+   gauss_dble_block(sd,NBLK);
+
+   dmax=0.0;
+
+   for (k=0;k<NBLK;k++)
+   {
+      if (fabs(rd[k]-sd[k])>dmax)
+         dmax=fabs(rd[k]-sd[k]);
+   }
+
+   printf("\n");
+   printf("Maximal deviation of gauss_dble_block from gauss_dble: %.1e\n",dmax);
+   printf("\n");
+
+   errors=(dmax>1.0e-13);
+   errors+=check_distribution("gauss_dble",gauss_dble);
+   errors+=check_distribution("gauss_dble_block",gauss_dble_block);
+   errors+=check_distribution("gauss_dble_zig",gauss_dble_zig);
+
+   printf("\n");
+
+   if (errors==0)
+      printf("All Gaussian generators are correct\n");
+   else
+      printf("%d tests failed\n",errors);
+
+   printf("\n");
+
+   free(rd);
+   free(sd);
+   exit(0);
+}
+
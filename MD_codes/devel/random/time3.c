@@ -0,0 +1,93 @@
+
+/*******************************************************************************
+*
+* File time3.c
+*
+* Measurement of the processor time required to produce single random
+* numbers, one call at a time, with ranlxd and with the buffered generator
+* (doubles, 48-bit integers and integers in a range)
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "random.h"
+
+#define N 10000000
+
+
+static void report(char *name,clock_t t1,clock_t t2,double sum)
+{
+   double dt;
+
+   dt=(double)(t2-t1)/(double)(CLOCKS_PER_SEC);
+   dt*=1.0e9/(double)(N);
+
+   printf("%-28s %6.2f ns per number (sum %.3e)\n",name,dt,sum);
+}
+
+
+int main(void)
+{
+   int k;
+   clock_t t1,t2;
+   double r,sum;
+   ranbuf_t *b;
+
+   b=malloc(sizeof(ranbuf_t));
+
+   printf("\n");
+   printf("Timing of single random numbers (level 1)\n");
+   printf("\n");
+
+   rlxd_init(1,1);
+   sum=0.0;
+   t1=clock();
+   for (k=0;k<N;k++)
+   {
+      ranlxd(&r,1);
+      sum+=r;
+   }
+   t2=clock();
+   report("ranlxd(&r,1)",t1,t2,sum);
+
+   ranbuf_init(b,1,1);
+   sum=0.0;
+   t1=clock();
+   for (k=0;k<N;k++)
+      sum+=ranbuf_double(b);
+   t2=clock();
+   report("ranbuf_double",t1,t2,sum);
+
+   ranbuf_init(b,1,1);
+   sum=0.0;
+   t1=clock();
+   for (k=0;k<N;k++)
+      sum+=(double)(ranbuf_raw(b));
+   t2=clock();
+   report("ranbuf_raw",t1,t2,sum);
+
+   ranbuf_init(b,1,1);
+   sum=0.0;
+   t1=clock();
+   for (k=0;k<N;k++)
+      sum+=(double)(ranbuf_int(b,1000));
+   t2=clock();
+   report("ranbuf_int (n=1000)",t1,t2,sum);
+
+   ranbuf_init(b,1,1);
+   sum=0.0;
+   t1=clock();
+   for (k=0;k<N;k++)
+      sum+=(double)(ranbuf_index(b,1000003));
+   t2=clock();
+   report("ranbuf_index (n=1000003)",t1,t2,sum);
+
+   free(b);
+   printf("\n");
+   exit(0);
+}
+
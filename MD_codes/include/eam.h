@@ -0,0 +1,12 @@
+#ifndef EAM_H
+#define EAM_H
+
+void set_eam_sutton_chen(double eps, double c, double a, int n, int m, double rc);
+void load_eam(char file_name[]);
+void use_eam(int on);
+int eam_active();
+double eam_cutoff();
+double eval_eam(int with_forces);
+void free_eam();
+
+#endif /*EAM_H*/
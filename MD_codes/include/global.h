@@ -5,10 +5,25 @@
  *
  * Global parameters and arrays
  *
- * N number of atoms
+ * N number of atoms (may be set at compile time with -DN=...)
  * EPS, SIGMA parameters of Lennard Jones potential
  * RC cutoff radius for Lennard Jones
+ * RP start of the polinomial junction that brings the potential to zero at
+ *    RC (none if RP>=RC); the potential can be changed at run time with
+ *    set_potential() of lattice.c
  * x, y, z atoms positions in the lattice
+ * atom_id original index (row of the input file) of the atom stored at
+ *    each position of the arrays, atom_slot position in the arrays of the
+ *    atom with each original index: they differ from the identity only
+ *    after reorder_atoms() of lattice.c
+ * SC_EPS, SC_C, SC_A, SC_N, SC_M, SC_RC Sutton-Chen EAM for silver (see
+ *    set_eam_sutton_chen() in eam.c)
+ * PBCX, PBCY, PBCZ periodic directions and SIZE_X, SIZE_Y, SIZE_Z lengths of
+ *    the box (SIZE along each direction if not set at compile time), the
+ *    default of set_box() in lattice.c
+ * T_TARGET temperature of the thermostats
+ * GAMMA friction of the Langevin thermostat
+ * TAU_NH relaxation time of the Nose-Hoover chain, of NH_CHAIN thermostats
  *
  *
  *
@@ -19,31 +34,50 @@
 #ifndef GLOBAL_H
 #define GLOBAL_H
 
+#ifndef N
 #define N 256                     /*atoms*/
+#endif
 #define EPS 0.345                 /*eV*/
 #define SIGMA 2.644               /*A*/
 #define RC 4.5                    /*A*/
 #define RP 4.6                    /*A*/
+#define SC_EPS 2.5415e-3          /*eV*/
+#define SC_C 144.41
+#define SC_A 4.09                 /*A*/
+#define SC_N 12
+#define SC_M 6
+#define SC_RC 6.2                 /*A*/
 #define KB 0.00008618460742911316 /*eV/K*/
 #define M 11.205e-27              /*kg*/
 #define DT 8e-15                  /*seconds*/
 #define T_INIT 15                 /*Kelvin*/
 #define TERM_TIME 3e-12           /*seconds*/
 #define TOT_TIME 10e-12           /*seconds*/
+#define T_TARGET 15               /*Kelvin*/
+#define GAMMA 1e12                /*1/seconds*/
+#define TAU_NH 1e-13              /*seconds*/
+#define NH_CHAIN 3
+#ifndef PBCX
 #define PBCX 0                    /*1 with PBC, 0 without*/
+#endif
+#ifndef PBCY
 #define PBCY 0                    /*1 with PBC, 0 without*/
+#endif
+#ifndef PBCZ
 #define PBCZ 0                    /*1 with PBC, 0 without*/
+#endif
 #define SIZE 16.641600            /*A*/
+#ifndef SIZE_X
+#define SIZE_X SIZE               /*A*/
+#endif
+#ifndef SIZE_Y
+#define SIZE_Y SIZE               /*A*/
+#endif
+#ifndef SIZE_Z
+#define SIZE_Z SIZE               /*A*/
+#endif
 #define MAX_FORCE 0.01            /*eV/A*/
 #define C_STEEP 0.001
-#define A 1.762150591975983e+08
-#define B -2.840236130038733e+08
-#define C 1.961490151653693e+08
-#define D -7.523885828765376e+07
-#define E 1.731196189189488e+07
-#define F -2.389452170224014e+06
-#define G 1.831785386120462e+05
-#define H -6.016872195722493e+03
 
 #ifdef MAIN_PROGRAM
 #define EXTERN
@@ -62,6 +96,8 @@ EXTERN double vzz[N];
 EXTERN double Fxx[N];
 EXTERN double Fyy[N];
 EXTERN double Fzz[N];
+EXTERN int atom_id[N];
+EXTERN int atom_slot[N];
 
 #undef EXTERN
 
@@ -1,24 +1,81 @@
 #ifndef LATTICE_H
 #define LATTICE_H
 
+#define LANGEVIN 0
+#define NOSE_HOOVER 1
+
+/*
+ * Pair potential (see set_potential() in lattice.c): Lennard Jones up to rp,
+ * U = c12/r^12 - c6/r^6 with force along the distance divided by the
+ * distance f12/r^14 - f6/r^8, then U = poly[0] + poly[1]*r + ... +
+ * poly[7]*r^7 up to the cutoff rc, with -U'(r)/r = dpoly[0]/r + dpoly[1] +
+ * dpoly[2]*r + ... + dpoly[6]*r^5.
+ */
+typedef struct
+{
+    double eps, sigma, rc, rp, rc2, rp2;
+    double c12, c6, f12, f6;
+    double poly[8], dpoly[7];
+} potential_t;
+
+/*
+ * Orthorhombic box (see set_box() in lattice.c): lengths l[] and periodic
+ * directions pbc[] along x, y and z.
+ */
+typedef struct
+{
+    double l[3];
+    int pbc[3];
+} box_t;
+
+/*
+ * Atoms and their periodic images (ghosts) near the faces of the box (see
+ * use_ghosts() in lattice.c): n atoms and ghosts with positions x, y and z,
+ * the N atoms first, brought back in the box. owner[k] is the atom of which
+ * k is an image (k itself if k < N), shift[3*k...3*k+2] the translation
+ * from the atom to k. size is the length of the arrays.
+ */
+typedef struct
+{
+    int n, size;
+    double *x, *y, *z, *shift;
+    int *owner;
+} halo_t;
+
 double powerd(double x, int y);
 void free_all();
 void load_data(char file_name[]);
+void set_box(double lx, double ly, double lz, int pbcx, int pbcy, int pbcz);
+box_t *get_box();
+void use_ghosts(int on);
+halo_t *get_halo();
+void set_potential(double eps, double sigma, double rc, double rp);
+potential_t *get_potential();
 double eval_nn_distance();
 double eval_U();
 void eval_nbrs();
+void set_reordering(int every);
+void reorder_atoms();
 void generate_inital_v();
 double eval_K();
 double eval_temperature();
 void eval_forces();
+double eval_U_and_forces();
 void verlet_evolution();
 void euler_evolution();
+void langevin_evolution(double t, double gamma);
+void nose_hoover_evolution(double t, double tau);
+void nvt_evolution(int thermostat, double t, double coupling);
+double eval_nose_hoover_energy(double t, double tau);
+void reset_thermostat();
 void thermalization(char file_name[]);
-void eval_coefficients();
+void thermalization_nvt(char file_name[], int thermostat, double t, double coupling);
 void print_potential();
 double *eval_L();
 double *eval_v_cm();
 double eval_max_force();
-void steepest_descent(char file_name[]);
+int steepest_descent(char file_name[]);
+int fire(char file_name[]);
+int lbfgs(char file_name[]);
 
 #endif /*LATTICE_H*/
@@ -0,0 +1,44 @@
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+#include <stdio.h>
+
+/*
+ * Events counted by perfcount.c in every region
+ */
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_L1D_MISSES 2
+#define PERF_LLC_MISSES 3
+#define PERF_BRANCHES 4
+#define PERF_BRANCH_MISSES 5
+#define PERF_TASK_CLOCK 6
+#define N_PERF_EVENTS 7
+
+#define MAX_PERF_REGIONS 32
+
+#ifndef PERFCOUNT_C
+extern int perf_region(char name[]);
+extern void perf_start(char name[]);
+extern void perf_stop(char name[]);
+extern int perf_available(void);
+extern double perf_count(char name[], int event);
+extern void perf_reset(void);
+extern void perf_print(FILE *fd);
+#endif
+
+/*
+ * The regions of the engine are counted only with -DPERFCOUNT, otherwise
+ * the macros disappear
+ */
+#ifdef PERFCOUNT
+#define PERF_START(name) perf_start(name)
+#define PERF_STOP(name) perf_stop(name)
+#define PERF_PRINT(fd) perf_print(fd)
+#else
+#define PERF_START(name)
+#define PERF_STOP(name)
+#define PERF_PRINT(fd)
+#endif
+
+#endif /*PERFCOUNT_H*/
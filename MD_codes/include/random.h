@@ -2,12 +2,113 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+/*
+ * State of a generator (see ranlxs.c and ranlxd.c). The fields are private
+ * to the generator, a state is zero-initialized or set by rlxs_init_r() and
+ * rlxd_init_r().
+ */
+
+#if ((defined SSE)||(defined SSE2))
+
+typedef struct
+{
+   float c1,c2,c3,c4;
+} rlx_vec_t __attribute__ ((aligned (16)));
+
+typedef struct
+{
+   rlx_vec_t c1,c2;
+} rlx_dble_vec_t __attribute__ ((aligned (16)));
+
+typedef struct
+{
+   int init,pr,prm,ir,jr,is,is_old,next[96];
+   rlx_vec_t one,one_bit,carry;
+   union
+   {
+      rlx_dble_vec_t vec[12];
+      float num[96];
+   } x;
+} rlxs_state_t;
+
+typedef struct
+{
+   int init,pr,prm,ir,jr,is,is_old,next[96];
+   rlx_vec_t one,one_bit,carry;
+   union
+   {
+      rlx_dble_vec_t vec[12];
+      float num[96];
+   } x;
+} rlxd_state_t;
+
+#else
+
+typedef struct
+{
+   int c1,c2,c3,c4;
+} rlx_vec_t;
+
+typedef struct
+{
+   rlx_vec_t c1,c2;
+} rlx_dble_vec_t;
+
+typedef struct
+{
+   int init,pr,prm,ir,jr,is,is_old,next[96];
+   float one_bit;
+   rlx_vec_t carry;
+   union
+   {
+      rlx_dble_vec_t vec[12];
+      int num[96];
+   } x;
+} rlxs_state_t;
+
+typedef struct
+{
+   int init,pr,prm,ir,jr,is,is_old,next[96];
+   double one_bit;
+   rlx_vec_t carry;
+   union
+   {
+      rlx_dble_vec_t vec[12];
+      int num[96];
+   } x;
+} rlxd_state_t;
+
+#endif
+
+/*
+ * Kernels of the update of ranlxs and ranlxd (see rlxvec.c)
+ */
+#define RLX_SCALAR 0
+#define RLX_SSE2 1
+#define RLX_AVX2 2
+#define RLX_AVX512 3
+#define RLX_NBACKENDS 4
+
+#ifndef RLXVEC_C
+#if (!((defined SSE)||(defined SSE2)))
+extern void rlx_update(rlx_dble_vec_t x[],rlx_vec_t *carry,int ir,int jr,int n);
+#endif
+extern int rlx_backend(void);
+extern int rlx_backend_available(int b);
+extern void rlx_set_backend(int b);
+extern char *rlx_backend_name(int b);
+#endif
+
 #ifndef RANLXS_C
 extern void ranlxs(float r[],int n);
 extern void rlxs_init(int level,int seed);
 extern int rlxs_size(void);
 extern void rlxs_get(int state[]);
 extern void rlxs_reset(int state[]);
+extern void ranlxs_r(rlxs_state_t *st,float r[],int n);
+extern void rlxs_init_r(rlxs_state_t *st,int level,int seed);
+extern void rlxs_get_r(rlxs_state_t *st,int state[]);
+extern void rlxs_reset_r(rlxs_state_t *st,int state[]);
 #endif
 
 #ifndef RANLXD_C
@@ -16,6 +117,70 @@ extern void rlxd_init(int level,int seed);
 extern int rlxd_size(void);
 extern void rlxd_get(int state[]);
 extern void rlxd_reset(int state[]);
+extern void ranlxd_r(rlxd_state_t *st,double r[],int n);
+extern void rlxd_init_r(rlxd_state_t *st,int level,int seed);
+extern void rlxd_get_r(rlxd_state_t *st,int state[]);
+extern void rlxd_reset_r(rlxd_state_t *st,int state[]);
+extern void ranlxd_raw_r(rlxd_state_t *st,long long r[],int n);
+#endif
+
+/*
+ * Buffered ranlxd (see ranbuf.c). The numbers are produced RANBUF_SIZE at a
+ * time as 48-bit integers and handed out by the macros
+ *
+ *   ranbuf_raw(b)     next 48-bit integer k (a long long)
+ *   ranbuf_double(b)  next number k*2^-48 in [0,1), the same that
+ *                     ranlxd_r() would give
+ *   ranbuf_int(b,n)   next integer in 0...n-1, i.e. floor(k*n*2^-48),
+ *                     for 0<n<=32768
+ *
+ * and by the function ranbuf_index(b,n) for any 0<n<2^31 (e.g. the index
+ * of a site of a large lattice).
+ */
+
+#define RANBUF_SIZE 4096
+#define RANBUF_ONE_BIT 3.552713678800500929355621337890625e-15
+
+typedef struct
+{
+   long long raw[RANBUF_SIZE];
+   rlxd_state_t st;
+   int next;
+} ranbuf_t;
+
+#ifndef RANBUF_C
+extern void ranbuf_init(ranbuf_t *b,int level,int seed);
+extern int ranbuf_refill(ranbuf_t *b);
+extern int ranbuf_index(ranbuf_t *b,int n);
+#endif
+
+#define ranbuf_raw(b) \
+   ((b)->raw[((b)->next==RANBUF_SIZE)?ranbuf_refill(b):(b)->next++])
+
+#define ranbuf_double(b) \
+   (RANBUF_ONE_BIT*(double)(ranbuf_raw(b)))
+
+#define ranbuf_int(b,n) \
+   ((int)((ranbuf_raw(b)*(long long)(n))>>48))
+
+/*
+ * Counter-based generator (see philox.c). A stream is labelled by the key
+ * (seed,replica) and by the counter (index,step), e.g. an atom and a sweep,
+ * and gives the same numbers whatever thread draws them and in what order.
+ */
+
+typedef struct
+{
+   unsigned int key[2],ctr[4];
+   long long raw[2];
+   int next;
+} phx_state_t;
+
+#ifndef PHILOX_C
+extern void philox4x32(unsigned int ctr[4],unsigned int key[2],unsigned int x[4]);
+extern void phx_init_r(phx_state_t *st,int seed,int replica,int index,int step);
+extern void ranphx_raw_r(phx_state_t *st,long long r[],int n);
+extern void ranphx_r(phx_state_t *st,double r[],int n);
 #endif
 
 #ifndef GAUSS_C
@@ -23,4 +188,9 @@ extern void gauss(float r[],int n);
 extern void gauss_dble(double r[],int n);
 #endif
 
+#ifndef GAUSSV_C
+extern void gauss_dble_block(double rd[],int n);
+extern void gauss_dble_zig(double rd[],int n);
+#endif
+
 #endif
@@ -0,0 +1,47 @@
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include <stdio.h>
+
+/*
+ * Phases of the MD engine timed by timers.c
+ */
+#define TIMER_NBRS 0
+#define TIMER_FORCES 1
+#define TIMER_INTEGRATION 2
+#define TIMER_THERMOSTAT 3
+#define TIMER_OBSERVABLES 4
+#define TIMER_IO 5
+#define N_TIMERS 6
+
+#ifndef TIMERS_C
+extern void timer_start(int phase);
+extern void timer_stop(int phase);
+extern void timer_pairs(int phase, double n);
+extern void timer_nbrs(int n_atoms, int total, int max);
+extern void timers_reset(void);
+extern void timers_print(FILE *fd);
+extern void timers_sample(FILE *fd, double t);
+#endif
+
+/*
+ * The instrumentation of the engine is compiled only with -DTIMERS,
+ * otherwise the macros (and the evaluation of their arguments) disappear
+ */
+#ifdef TIMERS
+#define TIMER_START(phase) timer_start(phase)
+#define TIMER_STOP(phase) timer_stop(phase)
+#define TIMER_PAIRS(phase, n) timer_pairs(phase, n)
+#define TIMER_NBRS_BUILD(n_atoms, total, max) timer_nbrs(n_atoms, total, max)
+#define TIMERS_PRINT(fd) timers_print(fd)
+#define TIMERS_SAMPLE(fd, t) timers_sample(fd, t)
+#else
+#define TIMER_START(phase)
+#define TIMER_STOP(phase)
+#define TIMER_PAIRS(phase, n)
+#define TIMER_NBRS_BUILD(n_atoms, total, max)
+#define TIMERS_PRINT(fd)
+#define TIMERS_SAMPLE(fd, t)
+#endif
+
+#endif /*TIMERS_H*/
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ *
+ * File ex1_nvt.c
+ *
+ * Canonical MD: thermalization and evolution at the temperature T with
+ * a Langevin (THERMOSTAT=0) or Nose-Hoover chain (THERMOSTAT=1)
+ * thermostat. COUPLING is the friction (1/s) of the Langevin thermostat
+ * or the relaxation time (s) of the chain, by default GAMMA or TAU_NH of
+ * global.h. Prints on file time, energy, temperature and the conserved
+ * energy of the chain (the energy for Langevin) at each time step, e.g.
+ *
+ *  ./ex1_nvt THERMOSTAT=1 T=30 COUPLING=2e-13
+ *
+ * With EAM=SC the atoms interact with the Sutton-Chen EAM of silver of
+ * global.h, with EAM=file_name with the EAM tables of the funcfl file (see
+ * eam.c), instead of the pair potential. With REORDER=k the atoms are
+ * sorted along a Morton curve every k builds of the neighbour lists (see
+ * reorder_atoms() in lattice.c).
+ *
+ * When compiled with -DTIMERS the time spent in each phase of the
+ * evolution is written every SAMPLE_STEPS steps in a separate file and a
+ * summary is printed at the end. When compiled with -DPERFCOUNT the
+ * hardware counters of the neighbour lists and of the forces are printed
+ * at the end (see perfcount.c).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define MAIN_PROGRAM
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "global.h"
+#include "lattice.h"
+#include "random.h"
+#include "timers.h"
+#include "perfcount.h"
+#include "eam.h"
+#include <assert.h>
+
+#define SAMPLE_STEPS 100
+
+int main(int argc, char *argv[])
+{
+    int i, ok, thermostat, set_coupling, reorder;
+    double t, coupling, energy, temperature, conserved;
+    char file_name[100], *eam;
+    FILE *fd;
+#ifdef TIMERS
+    FILE *fd_timers;
+#endif
+
+    thermostat = LANGEVIN;
+    t = T_TARGET;
+    set_coupling = 0;
+    coupling = 0;
+    eam = NULL;
+    reorder = 0;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "THERMOSTAT=", 11) == 0)
+            ok = sscanf(argv[i] + 11, "%d", &thermostat);
+        else if (strncmp(argv[i], "T=", 2) == 0)
+            ok = sscanf(argv[i] + 2, "%lf", &t);
+        else if (strncmp(argv[i], "COUPLING=", 9) == 0)
+            ok = set_coupling = sscanf(argv[i] + 9, "%lf", &coupling);
+        else if (strncmp(argv[i], "EAM=", 4) == 0)
+        {
+            eam = argv[i] + 4;
+            ok = (eam[0] != '\0');
+        }
+        else if (strncmp(argv[i], "REORDER=", 8) == 0)
+            ok = sscanf(argv[i] + 8, "%d", &reorder);
+        else
+            ok = 0;
+
+        if (ok != 1)
+        {
+            fprintf(stderr, "Usage: %s [THERMOSTAT=0|1] [T=kelvin] [COUPLING=value]\n"
+                            "       [EAM=SC|file] [REORDER=k]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    assert(thermostat == LANGEVIN || thermostat == NOSE_HOOVER);
+    assert(reorder >= 0);
+    if (!set_coupling)
+        coupling = (thermostat == LANGEVIN) ? GAMMA : TAU_NH;
+
+    sprintf(file_name, "../data/input_files/fcc100a%d.dat", N);
+    load_data(file_name);
+
+    if (eam != NULL && strcmp(eam, "SC") == 0)
+        set_eam_sutton_chen(SC_EPS, SC_C, SC_A, SC_N, SC_M, SC_RC);
+    else if (eam != NULL)
+        load_eam(eam);
+
+    set_reordering(reorder);
+
+    sprintf(file_name, "../data/ex1_nvt/therm_energy_temperature%dT%.0f.dat", thermostat, t);
+    thermalization_nvt(file_name, thermostat, t, coupling);
+
+    sprintf(file_name, "../data/ex1_nvt/energy_temperature%dT%.0f.dat", thermostat, t);
+    fd = fopen(file_name, "w");
+    assert(fd != NULL);
+
+#ifdef TIMERS
+    sprintf(file_name, "../data/ex1_nvt/timers%dT%.0f.dat", thermostat, t);
+    fd_timers = fopen(file_name, "w");
+    assert(fd_timers != NULL);
+    fprintf(fd_timers, "# time neighbours forces integration thermostat observables output\n");
+    TIMERS_SAMPLE(fd_timers, 0); /*thermalization*/
+#endif
+
+    for (i = 0; i * DT < TOT_TIME; i++)
+    {
+        energy = eval_K() + eval_U();
+        temperature = eval_temperature();
+        conserved = (thermostat == NOSE_HOOVER) ? eval_nose_hoover_energy(t, coupling) : energy;
+
+        TIMER_START(TIMER_IO);
+        fprintf(fd, "%.15e %.15e %.15e %.15e\n", i * DT, energy, temperature, conserved);
+        TIMER_STOP(TIMER_IO);
+
+        nvt_evolution(thermostat, t, coupling);
+
+        if ((i + 1) % SAMPLE_STEPS == 0)
+            TIMERS_SAMPLE(fd_timers, (i + 1) * DT);
+    }
+
+    fclose(fd);
+
+#ifdef TIMERS
+    fclose(fd_timers);
+#endif
+    TIMERS_PRINT(stdout);
+    PERF_PRINT(stdout);
+
+    free_all();
+    free_eam();
+
+    return 0;
+}
@@ -3,7 +3,8 @@
  *
  * File ex1_part2_4a.c
  *
- * Print on file energy and temperature at each time step.
+ * Print on file energy and temperature at each time step, and the
+ * positions of the atoms in the order of the input file.
  *
  * Author: Lorenzo Tasca
  *
@@ -43,9 +44,9 @@ int main(int argc, char *argv[])
 
         for (j = 0; j < N; j++)
         {
-            fprintf(fd2, "%.15e ", xx[j]);
-            fprintf(fd3, "%.15e ", yy[j]);
-            fprintf(fd4, "%.15e ", zz[j]);
+            fprintf(fd2, "%.15e ", xx[atom_slot[j]]);
+            fprintf(fd3, "%.15e ", yy[atom_slot[j]]);
+            fprintf(fd4, "%.15e ", zz[atom_slot[j]]);
         }
         fprintf(fd2, "\n");
         fprintf(fd3, "\n");
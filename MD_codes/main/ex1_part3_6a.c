@@ -36,7 +36,7 @@ int main(int argc, char *argv[])
     for (i = 0; i * DT < TOT_TIME; i++)
     {
         fprintf(fd1, "%.15e %.15e %.15e\n", i * DT, eval_K() + eval_U(), eval_temperature());
-        fprintf(fd2, "%.15e %.15e %.15e\n", xx[N-1], yy[N-1], zz[N-1]);
+        fprintf(fd2, "%.15e %.15e %.15e\n", xx[atom_slot[N - 1]], yy[atom_slot[N - 1]], zz[atom_slot[N - 1]]);
         verlet_evolution();
     }
 
@@ -0,0 +1,523 @@
+/*******************************************************************************
+ *
+ * Library eam.c
+ *
+ * Embedded atom method for fcc metals. The energy is
+ *
+ *  U = sum_i F(rho_i) + 1/2 sum_i sum_j phi(r_ij),  rho_i = sum_j f(r_ij)
+ *
+ * with the pair potential phi, the density f and the embedding function F
+ * tabulated on uniform grids and interpolated with cubic splines (the
+ * derivatives at the grid points are estimated by finite differences, as in
+ * the DYNAMO and LAMMPS codes). As in those codes r*phi(r) is tabulated
+ * instead of phi(r). The sums run on the neighbour lists of lattice.c,
+ * which must be built with the cutoff of the tables (eval_nbrs() does it
+ * while the EAM is in use).
+ *
+ * eval_eam() makes two passes over the pairs. Each pair i<k of the lists is
+ * visited once: the first pass looks up r*phi and f with a single index into
+ * the tables, accumulates the densities of both atoms and the pair energy
+ * and caches phi'(r)/r and f'(r)/r; then F and F' are evaluated for every
+ * atom, and the second pass accumulates the forces of both atoms of every
+ * pair from the cache and F'. With OpenMP the pairs of both passes are
+ * shared among the threads in fixed chunks, each with its own densities,
+ * forces and energy, which are summed in the order of the threads at the
+ * end of the pass (the result depends on the number of threads only through
+ * the rounding, and is reproducible for a given number of threads). With the ghosts of lattice.c (see
+ * use_ghosts()) the distances are plain differences and the density and
+ * the force of a ghost go to its owner, otherwise the minimum image
+ * convention is applied along the periodic directions of the box.
+ *
+ * The externally accessible functions are:
+ *
+ *  void set_eam_sutton_chen(double eps, double c, double a, int n, int m,
+ *                           double rc)
+ *      Tabulates the Sutton-Chen potential, phi(r) = eps*(a/r)^n,
+ *      f(r) = (a/r)^m and F(rho) = -eps*c*sqrt(rho), with phi and f shifted
+ *      so that they and their derivative vanish at rc. The densities are
+ *      tabulated up to twice the one of the perfect fcc crystal with
+ *      lattice constant a. The EAM is then in use.
+ *
+ *  void load_eam(char file_name[])
+ *      Reads the tables from a file in the funcfl format of DYNAMO (single
+ *      element, e.g. Ag_u3.eam): a comment line, a line with the atomic
+ *      number, the mass, the lattice constant and the lattice, a line with
+ *      nrho, drho, nr, dr and the cutoff, then F on nrho points, Z on nr
+ *      points and f on nr points, with phi(r) = 27.2*0.529*Z(r)^2/r (eV).
+ *      The EAM is then in use.
+ *
+ *  void use_eam(int on)
+ *      Switches from the pair potential of lattice.c to the EAM (on != 0)
+ *      and back. The neighbour lists must be evaluated again.
+ *
+ *  int eam_active()
+ *      1 if the EAM is in use, 0 otherwise.
+ *
+ *  double eam_cutoff()
+ *      Cutoff of the tables.
+ *
+ *  double eval_eam(int with_forces)
+ *      Returns the energy and, if with_forces != 0, evaluates the forces in
+ *      Fxx, Fyy and Fzz. eval_U(), eval_forces() and eval_U_and_forces() of
+ *      lattice.c call it while the EAM is in use.
+ *
+ *  void free_eam()
+ *      Frees the tables and the work arrays (the EAM is no longer in use).
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "global.h"
+#include "lattice.h"
+#include "eam.h"
+
+#define EAM_TABLE 2000      /*points of the tables of set_eam_sutton_chen()*/
+#define HARTREE_BOHR 14.388 /*27.2*0.529 eV*A*/
+#define EAM_CHUNK 16        /*atoms per chunk of the passes with OpenMP*/
+
+/*
+ * Function tabulated on the uniform grid x0+k*dx, k=0...n-1, with the
+ * coefficients c[4*k]...c[4*k+3] of the cubic between the points k and k+1
+ */
+typedef struct
+{
+    int n;
+    double x0, dx, inv_dx;
+    double *c;
+} spline_t;
+
+static spline_t z2r = {0, 0, 0, 0, NULL}, dens = {0, 0, 0, 0, NULL}, embed = {0, 0, 0, 0, NULL};
+static double cutoff, cutoff2;
+static int tables = 0, active = 0;
+
+/*
+ * Work arrays: densities and F' of the atoms, densities and forces of the
+ * threads and phi'(r)/r, f'(r)/r of every entry of the neighbour lists
+ */
+static double rho[N], fp[N];
+static double *rho_thread = NULL, *force_thread = NULL, *u_thread = NULL, *cache = NULL;
+static int n_threads = 0, cache_size = 0, offset[N];
+
+static void free_spline(spline_t *s)
+{
+    free(s->c);
+    s->c = NULL;
+    s->n = 0;
+}
+
+/*
+ * Cubic interpolation of the values y[0...n-1] at x0+k*dx
+ */
+static void make_spline(spline_t *s, double y[], int n, double x0, double dx)
+{
+    int k;
+    double *s1, dy;
+
+    assert(n >= 5 && dx > 0);
+
+    free_spline(s);
+    s->n = n;
+    s->x0 = x0;
+    s->dx = dx;
+    s->inv_dx = 1 / dx;
+    s->c = (double *)malloc(4 * n * sizeof(double));
+    s1 = (double *)malloc(n * sizeof(double));
+    assert(s->c != NULL && s1 != NULL);
+
+    /*derivatives (times dx) at the grid points*/
+    s1[0] = y[1] - y[0];
+    s1[1] = 0.5 * (y[2] - y[0]);
+    s1[n - 2] = 0.5 * (y[n - 1] - y[n - 3]);
+    s1[n - 1] = y[n - 1] - y[n - 2];
+    for (k = 2; k < n - 2; k++)
+        s1[k] = ((y[k - 2] - y[k + 2]) + 8 * (y[k + 1] - y[k - 1])) / 12;
+
+    for (k = 0; k < n - 1; k++)
+    {
+        dy = y[k + 1] - y[k];
+        s->c[4 * k] = y[k];
+        s->c[4 * k + 1] = s1[k];
+        s->c[4 * k + 2] = 3 * dy - 2 * s1[k] - s1[k + 1];
+        s->c[4 * k + 3] = s1[k] + s1[k + 1] - 2 * dy;
+    }
+
+    /*beyond the last point: linear extrapolation*/
+    s->c[4 * (n - 1)] = y[n - 1];
+    s->c[4 * (n - 1) + 1] = s1[n - 1];
+    s->c[4 * (n - 1) + 2] = 0;
+    s->c[4 * (n - 1) + 3] = 0;
+
+    free(s1);
+}
+
+/*
+ * Value of the spline at x, with the derivative in *dy
+ */
+static double eval_spline(spline_t *s, double x, double *dy)
+{
+    int k;
+    double p, *c;
+
+    p = (x - s->x0) * s->inv_dx;
+    k = (int)p;
+    if (k < 0)
+        k = 0;
+    else if (k > s->n - 1)
+        k = s->n - 1;
+    p -= k;
+    c = s->c + 4 * k;
+
+    *dy = ((3 * c[3] * p + 2 * c[2]) * p + c[1]) * s->inv_dx;
+
+    return ((c[3] * p + c[2]) * p + c[1]) * p + c[0];
+}
+
+static void set_tables(double *y_z2r, double *y_dens, int nr, double dr, double *y_embed, int nrho,
+                       double drho, double rc)
+{
+    make_spline(&z2r, y_z2r, nr, 0, dr);
+    make_spline(&dens, y_dens, nr, 0, dr);
+    make_spline(&embed, y_embed, nrho, 0, drho);
+
+    cutoff = rc;
+    cutoff2 = rc * rc;
+    tables = 1;
+    active = 1;
+}
+
+void set_eam_sutton_chen(double eps, double c, double a, int n, int m, double rc)
+{
+    int i, j, k, l, L;
+    double r, dr, drho, rho_max, phi_rc, dphi_rc, f_rc, df_rc, *y;
+
+    assert(eps > 0 && c > 0 && a > 0 && n > 0 && m > 0 && rc > 0);
+
+    phi_rc = eps * pow(a / rc, n);
+    dphi_rc = -n * phi_rc / rc;
+    f_rc = pow(a / rc, m);
+    df_rc = -m * f_rc / rc;
+
+    y = (double *)malloc(3 * EAM_TABLE * sizeof(double));
+    assert(y != NULL);
+
+    dr = rc / (EAM_TABLE - 1);
+    for (k = 1; k < EAM_TABLE; k++)
+    {
+        r = k * dr;
+        y[k] = r * (eps * pow(a / r, n) - phi_rc - (r - rc) * dphi_rc);
+        y[EAM_TABLE + k] = pow(a / r, m) - f_rc - (r - rc) * df_rc;
+    }
+    /*never used, atoms do not get that close*/
+    y[0] = y[1];
+    y[EAM_TABLE] = y[EAM_TABLE + 1];
+
+    /*density of the perfect fcc crystal, sites a/2*(i,j,k) with i+j+k even*/
+    rho_max = 0;
+    L = (int)(2 * rc / a) + 1;
+    for (i = -L; i <= L; i++)
+        for (j = -L; j <= L; j++)
+            for (l = -L; l <= L; l++)
+            {
+                r = 0.5 * a * sqrt((double)(i * i + j * j + l * l));
+                if ((i + j + l) % 2 == 0 && r > 0 && r < rc)
+                    rho_max += pow(a / r, m) - f_rc - (r - rc) * df_rc;
+            }
+    rho_max *= 2;
+
+    drho = rho_max / (EAM_TABLE - 1);
+    for (k = 0; k < EAM_TABLE; k++)
+        y[2 * EAM_TABLE + k] = -eps * c * sqrt(k * drho);
+
+    set_tables(y, y + EAM_TABLE, EAM_TABLE, dr, y + 2 * EAM_TABLE, EAM_TABLE, drho, rc);
+
+    free(y);
+}
+
+void load_eam(char file_name[])
+{
+    int k, nrho, nr, z;
+    double drho, dr, rc, mass, lattice, *y;
+    char line[256];
+    FILE *fd;
+
+    fd = fopen(file_name, "r");
+    assert(fd != NULL);
+
+    assert(fgets(line, 256, fd) != NULL);
+    assert(fscanf(fd, "%d %lf %lf %255s", &z, &mass, &lattice, line) == 4);
+    assert(fscanf(fd, "%d %lf %d %lf %lf", &nrho, &drho, &nr, &dr, &rc) == 5);
+    assert(nrho >= 5 && nr >= 5 && drho > 0 && dr > 0 && rc > 0);
+
+    y = (double *)malloc((nrho + 2 * nr) * sizeof(double));
+    assert(y != NULL);
+
+    for (k = 0; k < nrho + 2 * nr; k++)
+        assert(fscanf(fd, "%lf", y + k) == 1);
+
+    fclose(fd);
+
+    /*r*phi(r) from the effective charge*/
+    for (k = 0; k < nr; k++)
+        y[nrho + k] = HARTREE_BOHR * y[nrho + k] * y[nrho + k];
+
+    set_tables(y + nrho, y + nrho + nr, nr, dr, y, nrho, drho, rc);
+
+    free(y);
+}
+
+void use_eam(int on)
+{
+    assert(!on || tables);
+    active = (on != 0);
+}
+
+int eam_active()
+{
+    return active;
+}
+
+double eam_cutoff()
+{
+    assert(tables);
+    return cutoff;
+}
+
+void free_eam()
+{
+    free_spline(&z2r);
+    free_spline(&dens);
+    free_spline(&embed);
+    free(rho_thread);
+    free(force_thread);
+    free(u_thread);
+    free(cache);
+    rho_thread = NULL;
+    force_thread = NULL;
+    u_thread = NULL;
+    cache = NULL;
+    n_threads = 0;
+    cache_size = 0;
+    tables = 0;
+    active = 0;
+}
+
+static double min_image(double d, int pbc, double l)
+{
+    if (pbc)
+        d -= l * floor(d / l + 0.5);
+
+    return d;
+}
+
+/*
+ * Allocates the work arrays for the threads and the neighbour lists and
+ * evaluates the offsets of the lists in the cache
+ */
+static void alloc_work(void)
+{
+    int i, threads;
+
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#else
+    threads = 1;
+#endif
+
+    if (threads > n_threads)
+    {
+        free(rho_thread);
+        free(force_thread);
+        free(u_thread);
+        rho_thread = (double *)malloc(threads * N * sizeof(double));
+        force_thread = (double *)malloc(3 * threads * N * sizeof(double));
+        u_thread = (double *)malloc(threads * sizeof(double));
+        assert(rho_thread != NULL && force_thread != NULL && u_thread != NULL);
+        n_threads = threads;
+    }
+
+    offset[0] = 0;
+    for (i = 1; i < N; i++)
+        offset[i] = offset[i - 1] + number_nbrs[i - 1];
+
+    if (offset[N - 1] + number_nbrs[N - 1] > cache_size)
+    {
+        cache_size = offset[N - 1] + number_nbrs[N - 1];
+        free(cache);
+        cache = (double *)malloc(2 * cache_size * sizeof(double));
+        assert(cache != NULL);
+    }
+}
+
+double eval_eam(int with_forces)
+{
+    int pbc[3], a, t;
+    double U, *x, *y, *z, *l;
+    halo_t *h;
+
+    assert(tables);
+    alloc_work();
+
+    for (t = 0; t < n_threads; t++)
+        u_thread[t] = 0;
+
+    /*plain differences with the ghosts, minimum image otherwise*/
+    h = get_halo();
+    x = (h != NULL) ? h->x : xx;
+    y = (h != NULL) ? h->y : yy;
+    z = (h != NULL) ? h->z : zz;
+    l = get_box()->l;
+    for (a = 0; a < 3; a++)
+        pbc[a] = (h == NULL) && get_box()->pbc[a];
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int i, j, k, o, t, idx, m;
+        double dx, dy, dz, r2, r, p, f, df, z2, dz2, phi, s, u, *c, *rho_t, *force_t;
+
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        m = omp_get_num_threads();
+#else
+        t = 0;
+        m = 1;
+#endif
+        rho_t = rho_thread + t * N;
+        force_t = force_thread + 3 * t * N;
+
+        u = 0;
+        for (i = 0; i < N; i++)
+            rho_t[i] = 0;
+
+        /*densities and pair energy*/
+#ifdef _OPENMP
+#pragma omp for schedule(static, EAM_CHUNK)
+#endif
+        for (i = 0; i < N; i++)
+        {
+            for (j = 0; j < number_nbrs[i]; j++)
+            {
+                k = which_nbrs[i][j];
+                o = (h != NULL) ? h->owner[k] : k;
+                if (o < i)
+                    continue;
+
+                dx = min_image(x[i] - x[k], pbc[0], l[0]);
+                dy = min_image(y[i] - y[k], pbc[1], l[1]);
+                dz = min_image(z[i] - z[k], pbc[2], l[2]);
+                r2 = dx * dx + dy * dy + dz * dz;
+                if (r2 >= cutoff2)
+                    continue;
+
+                /*r*phi and f share the grid*/
+                r = sqrt(r2);
+                p = r * z2r.inv_dx;
+                idx = (int)p;
+                if (idx > z2r.n - 1)
+                    idx = z2r.n - 1;
+                p -= idx;
+                c = z2r.c + 4 * idx;
+                z2 = ((c[3] * p + c[2]) * p + c[1]) * p + c[0];
+                dz2 = ((3 * c[3] * p + 2 * c[2]) * p + c[1]) * z2r.inv_dx;
+                c = dens.c + 4 * idx;
+                f = ((c[3] * p + c[2]) * p + c[1]) * p + c[0];
+                df = ((3 * c[3] * p + 2 * c[2]) * p + c[1]) * dens.inv_dx;
+
+                phi = z2 / r;
+                u += phi;
+                rho_t[i] += f;
+                rho_t[o] += f;
+
+                if (with_forces)
+                {
+                    idx = 2 * (offset[i] + j);
+                    cache[idx] = (dz2 - phi) / r2;
+                    cache[idx + 1] = df / r;
+                }
+            }
+        }
+
+        /*embedding energy, F'*/
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (i = 0; i < N; i++)
+        {
+            rho[i] = 0;
+            for (k = 0; k < m; k++)
+                rho[i] += rho_thread[k * N + i];
+
+            u += eval_spline(&embed, rho[i], fp + i);
+        }
+
+        u_thread[t] = u;
+
+        if (with_forces)
+        {
+            for (i = 0; i < 3 * N; i++)
+                force_t[i] = 0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static, EAM_CHUNK)
+#endif
+            for (i = 0; i < N; i++)
+            {
+                for (j = 0; j < number_nbrs[i]; j++)
+                {
+                    k = which_nbrs[i][j];
+                    o = (h != NULL) ? h->owner[k] : k;
+                    if (o < i)
+                        continue;
+
+                    dx = min_image(x[i] - x[k], pbc[0], l[0]);
+                    dy = min_image(y[i] - y[k], pbc[1], l[1]);
+                    dz = min_image(z[i] - z[k], pbc[2], l[2]);
+                    if (dx * dx + dy * dy + dz * dz >= cutoff2)
+                        continue;
+
+                    /*force on i along the distance divided by the distance*/
+                    idx = 2 * (offset[i] + j);
+                    s = -(cache[idx] + (fp[i] + fp[o]) * cache[idx + 1]);
+
+                    force_t[3 * i] += s * dx;
+                    force_t[3 * i + 1] += s * dy;
+                    force_t[3 * i + 2] += s * dz;
+                    force_t[3 * o] -= s * dx;
+                    force_t[3 * o + 1] -= s * dy;
+                    force_t[3 * o + 2] -= s * dz;
+                }
+            }
+
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (i = 0; i < N; i++)
+            {
+                Fxx[i] = 0;
+                Fyy[i] = 0;
+                Fzz[i] = 0;
+                for (k = 0; k < m; k++)
+                {
+                    Fxx[i] += force_thread[3 * (k * N + i)];
+                    Fyy[i] += force_thread[3 * (k * N + i) + 1];
+                    Fzz[i] += force_thread[3 * (k * N + i) + 2];
+                }
+            }
+        }
+    }
+
+    U = 0;
+    for (t = 0; t < n_threads; t++)
+        U += u_thread[t];
+
+    return U;
+}
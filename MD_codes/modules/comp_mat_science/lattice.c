@@ -10,7 +10,36 @@
  *
  *  void load_data(char file_name[])
  *      Load the atom positions from the file "file_name"
- *      into global variables xx, yy and zz.
+ *      into global variables xx, yy and zz, in the order of the file
+ *      (atom_id and atom_slot are set to the identity).
+ *
+ *  void set_box(double lx, double ly, double lz, int pbcx, int pbcy,
+ *               int pbcz)
+ *      Sets the orthorhombic box: lengths lx, ly and lz, and periodic
+ *      boundary conditions along the directions with pbc != 0. Until it is
+ *      called the box is the one of SIZE_X, SIZE_Y, SIZE_Z and PBCX, PBCY,
+ *      PBCZ in global.h. The neighbour lists must be evaluated again.
+ *
+ *  box_t *get_box()
+ *      Returns the current box (see lattice.h).
+ *
+ *  void use_ghosts(int on)
+ *      Switches the periodic boundary conditions from the minimum image
+ *      convention, applied to every pair at every evaluation, to ghost
+ *      atoms (on != 0) and back. With the ghosts the neighbour lists are
+ *      built after bringing the atoms back in the box and replicating the
+ *      ones closer than the cutoff of the lists (skin included) to a face
+ *      along a periodic direction on the opposite side. The lists then
+ *      contain the indexes N, N+1, ... of the ghosts, the distances are
+ *      plain differences of the positions and every pair is visited once,
+ *      the force on a ghost being added to its owner. The ghosts follow
+ *      their owners until the lists are built again. No effect without
+ *      periodic directions. The neighbour lists must be evaluated again.
+ *
+ *  halo_t *get_halo()
+ *      Updates the positions of the ghosts from the ones of their owners
+ *      and returns the atoms with the ghosts (see lattice.h), NULL if the
+ *      ghosts are not in use or the lists have not been built with them.
  *
  *  double eval_nn_distance()
  *      Evaluates the nearest neighbours distance of the lattice.
@@ -18,14 +47,44 @@
  *  void eval_nbrs(int *number_nbrs, int **number_nbrs)
  *      Evaluates the number of neighbors of the atom i (number_nbrs[i]) and
  *      the list of their indexes (which_nbrs[i]). which_nbrs[i] has lenght
- *      number_nbrs[i].
+ *      number_nbrs[i]. The neighbours are the atoms closer than the cutoff
+ *      of the pair potential, or of the EAM tables while the EAM is in use
+ *      (see eam.c). The atoms are first reordered with reorder_atoms() if
+ *      this is due (see set_reordering()).
+ *
+ *  void set_reordering(int every)
+ *      Makes eval_nbrs() reorder the atoms at its first call and then
+ *      every "every" calls, never if every is 0 (the default). Calls to
+ *      eval_nbrs() are counted from here.
+ *
+ *  void reorder_atoms()
+ *      Sorts the atoms along a Morton (Z-order) curve through the bounding
+ *      box of the lattice (the box along periodic directions), so that
+ *      atoms close in space are close in memory and the neighbours of
+ *      consecutive atoms share cache lines. Positions, velocities and
+ *      forces are permuted together, atom_id[i] becomes the original index
+ *      of the atom now at i and atom_slot the inverse map, to be used to
+ *      write per-atom data in the original order. The neighbour lists
+ *      must be evaluated again.
+ *
+ *  void set_potential(double eps, double sigma, double rc, double rp)
+ *      Sets the pair potential: Lennard Jones with parameters eps and sigma
+ *      up to rp, then a seventh order polinomial that brings smoothly the
+ *      potential and its first three derivatives to zero at the cutoff rc.
+ *      To remove the junction (sharp cutoff approach) it is sufficient to
+ *      set rp>=rc. The prefactors of Lennard Jones and the coefficients of
+ *      the polinomial and of its derivative are evaluated here once and
+ *      cached in a potential_t (see lattice.h). Until it is called the
+ *      potential is the one of EPS, SIGMA, RC and RP in global.h. The
+ *      neighbour lists must be evaluated again after a change of rc.
+ *
+ *  potential_t *get_potential()
+ *      Returns the current pair potential.
  *
  *  double eval_U()
- *      Evaluates the potential energy of the lattice using Lennard Jones
- *      potential with smooth junction. It sums only on neighbors (r<RC).
- *      Between RP and RC the potential is a seventh order polinomial that
- *      brings smootlhy the potential to zero. To remove the junction
- *      (sharp cutoff approach) it is sufficient to set RP>RC.
+ *      Evaluates the potential energy of the lattice with the current pair
+ *      potential, or with eval_eam() while the EAM is in use. It sums only
+ *      on neighbors closer than the cutoff.
  *
  *  double eval_K()
  *      Evaluates the kinetic energy of the lattice.
@@ -36,31 +95,107 @@
  *  void generate_inital_v()
  *      Generates inital velocities sampling from a uniform distribution.
  *      Velocities are generated to have a initial temperature T_INIT and
- *      a stationary centre of mass of the lattice.
+ *      a stationary centre of mass of the lattice. The random numbers of
+ *      the atom i are those of the counter-based generator with counter
+ *      (atom_id[i],0), so they depend neither on the order in which atoms
+ *      are drawn nor on the order of the atoms in the arrays.
  *
  *  void eval_forces()
  *      Evaluates forces acting on each atom of the lattice due to the
- *      potential (LJ with smooth junction). It sums only on neighbors (r<RC).
+ *      pair potential, or to the EAM while it is in use. It sums only on
+ *      neighbors closer than the cutoff.
+ *
+ *  double eval_U_and_forces()
+ *      Evaluates the forces as eval_forces() and returns the potential
+ *      energy, in a single pass over the neighbours. The pairs at the
+ *      cutoff distance or larger are skipped, hence the neighbour lists may
+ *      also have been built with a larger cutoff.
  *
  *  void verlet_evolution()
- *      Evolves the system of a time step DT, using Verlet algorithm.
+ *      Evolves the system of a time step DT, using velocity Verlet
+ *      algorithm (half kick, drift, half kick).
  *
  *  void euler_evolution()
  *      Evolves the system of a time step DT, using Euler algorithm.
  *
+ *  void langevin_evolution(double t, double gamma)
+ *      Evolves the system of a time step DT with Langevin dynamics at
+ *      temperature t and friction gamma (1/s), using the BAOAB splitting
+ *      (Leimkuhler and Matthews): half kick, half drift, exact
+ *      Ornstein-Uhlenbeck update of the velocities, half drift, half kick.
+ *      The noise of the atom i at the step k is drawn from the
+ *      counter-based generator with counter (atom_id[i],k).
+ *
+ *  void nose_hoover_evolution(double t, double tau)
+ *      Evolves the system of a time step DT with a Nose-Hoover chain of
+ *      NH_CHAIN thermostats at temperature t with relaxation time tau (s),
+ *      using the Trotter splitting of Martyna, Tuckerman and Klein: half
+ *      step of the chain, Verlet step, half step of the chain.
+ *
+ *  void nvt_evolution(int thermostat, double t, double coupling)
+ *      langevin_evolution(t,coupling) if thermostat is LANGEVIN,
+ *      nose_hoover_evolution(t,coupling) if it is NOSE_HOOVER.
+ *
+ *  double eval_nose_hoover_energy(double t, double tau)
+ *      Evaluates the quantity conserved by nose_hoover_evolution(), that is
+ *      the energy of the lattice plus the energy of the chain.
+ *
+ *  void reset_thermostat()
+ *      Resets the variables of the Nose-Hoover chain and the step of the
+ *      Langevin noise.
+ *
  *  void thermalization()
  *      Thermalizes the system evolving the system for TERM_TIME seconds.
  *      It automatically generates the initial velocities.
  *
- *  void eval_coefficients()
- *      Calculates the coefficients of the polynomial junction given RC and RP.
+ *  void thermalization_nvt(char file_name[], int thermostat, double t,
+ *                          double coupling)
+ *      As thermalization(), evolving with nvt_evolution(), so that the
+ *      system reaches the temperature t instead of about T_INIT/2.
  *
  *  void print_potential()
- *      Print on file the Lennard Jones potential with junction.
+ *      Print on file the current pair potential.
+ *
+ *  int steepest_descent(char file_name[])
+ *      Minimizes the potential energy moving the atoms by C_STEEP times the
+ *      force until the largest force is smaller than MAX_FORCE. Prints on
+ *      file_name (if not empty) the largest force and the energy at each
+ *      iteration and returns the number of force evaluations.
+ *
+ *  int fire(char file_name[])
+ *      As steepest_descent(), with the fast inertial relaxation engine
+ *      (Bitzek et al. 2006): MD with semi-implicit Euler steps in which the
+ *      velocities are mixed with the direction of the force, the time step
+ *      grows from DT up to FIRE_DT_MAX while the power F.v stays positive
+ *      and the atoms are stopped as soon as it becomes negative. The
+ *      velocities are zero on exit.
+ *
+ *  int lbfgs(char file_name[])
+ *      As steepest_descent(), with the limited-memory BFGS method (Nocedal
+ *      1980): the search direction is obtained from the last LBFGS_MEMORY
+ *      changes of positions and forces, and a backtracking line search
+ *      along it accepts the first step satisfying the Armijo condition.
+ *      Steps are limited to LBFGS_MAX_STEP per atom. If the step gets
+ *      shorter than LBFGS_MIN_STEP the search is restarted along the force,
+ *      and if this fails too the minimization stops. The neighbour lists
+ *      are built with a skin of LBFGS_SKIN and rebuilt only when an atom
+ *      has moved more than half of it, and the energy and the forces come
+ *      from eval_U_and_forces(). The number of force evaluations is
+ *      returned with the minus sign if the line search fails or if the
+ *      largest force is still above MAX_FORCE after LBFGS_MAX_ITER
+ *      iterations; the atoms are then left at the lowest energy found. On
+ *      exit the lists are the ones of eval_nbrs().
  *
  *  void free_all()
  *      Fress all dynamically allocated memory.
  *
+ * The phases of the evolution (neighbour lists, forces, integration,
+ * thermostats, observables and output) are timed through the macros of
+ * timers.h when compiled with -DTIMERS (the reordering of the atoms counts
+ * as neighbour lists). The hardware counters of the neighbour lists, of
+ * the reordering and of the forces are read through the macros of
+ * perfcount.h when compiled with -DPERFCOUNT.
+ *
  * Author: Lorenzo Tasca
  *
  *******************************************************************************/
@@ -72,6 +207,76 @@
 #include "global.h"
 #include "random.h"
 #include "lattice.h"
+#include "timers.h"
+#include "perfcount.h"
+#include "eam.h"
+
+#define PI 3.141592653589793
+
+/*parameters of fire() (Bitzek et al. 2006)*/
+#define FIRE_DT_MAX (10 * DT)
+#define FIRE_N_MIN 5
+#define FIRE_F_INC 1.1
+#define FIRE_F_DEC 0.5
+#define FIRE_ALPHA 0.1
+#define FIRE_F_ALPHA 0.99
+
+/*parameters of lbfgs()*/
+#define LBFGS_MEMORY 8
+#define LBFGS_MAX_STEP 0.2 /*A*/
+#define LBFGS_SKIN 0.5     /*A*/
+#define LBFGS_ARMIJO 1e-4
+#define LBFGS_MIN_STEP 1e-10 /*A*/
+#define LBFGS_MAX_ITER 10000
+
+/*bits per direction of the Morton keys of reorder_atoms()*/
+#define MORTON_BITS 10
+
+typedef struct
+{
+    unsigned long key;
+    int slot;
+} morton_t;
+
+#ifdef TIMERS
+/*
+ * Pairs in the neighbour lists and largest number of neighbours
+ */
+static int count_pairs(void)
+{
+    int i, total;
+
+    total = 0;
+    for (i = 0; i < N; i++)
+        total += number_nbrs[i];
+
+    return total;
+}
+
+static int max_nbrs(void)
+{
+    int i, max;
+
+    max = 0;
+    for (i = 0; i < N; i++)
+        if (number_nbrs[i] > max)
+            max = number_nbrs[i];
+
+    return max;
+}
+#endif
+
+static potential_t pot;
+static int pot_set = 0;
+
+/*reorder_atoms() every reorder_every builds of the lists (never if 0)*/
+static int reorder_every = 0, n_builds = 0;
+
+/*box, by default the one of global.h, and ghosts (see use_ghosts())*/
+static box_t box = {{SIZE_X, SIZE_Y, SIZE_Z}, {PBCX, PBCY, PBCZ}};
+static int periodic = PBCX || PBCY || PBCZ;
+static halo_t halo = {0, 0, NULL, NULL, NULL, NULL, NULL};
+static int ghosts = 0;
 
 double powerd(double x, int y)
 {
@@ -101,6 +306,16 @@ void free_all()
         free(which_nbrs[i]);
         which_nbrs[i] = NULL;
     }
+
+    free(halo.x);
+    free(halo.y);
+    free(halo.z);
+    free(halo.shift);
+    free(halo.owner);
+    halo.x = halo.y = halo.z = halo.shift = NULL;
+    halo.owner = NULL;
+    halo.n = 0;
+    halo.size = 0;
 }
 
 void load_data(char file_name[])
@@ -112,25 +327,185 @@ void load_data(char file_name[])
     assert(file != NULL);
 
     for (row = 0; row < N; row++)
+    {
         assert(fscanf(file, "%lf %lf %lf", xx + row, yy + row, zz + row) == 3);
+        atom_id[row] = row;
+        atom_slot[row] = row;
+    }
 
     fclose(file);
 }
 
-static double eval_dist1D(double a, double b, int pbc)
+void set_box(double lx, double ly, double lz, int pbcx, int pbcy, int pbcz)
+{
+    assert(lx > 0 && ly > 0 && lz > 0);
+
+    box.l[0] = lx;
+    box.l[1] = ly;
+    box.l[2] = lz;
+    box.pbc[0] = (pbcx != 0);
+    box.pbc[1] = (pbcy != 0);
+    box.pbc[2] = (pbcz != 0);
+    periodic = box.pbc[0] || box.pbc[1] || box.pbc[2];
+}
+
+box_t *get_box()
+{
+    return &box;
+}
+
+void use_ghosts(int on)
+{
+    ghosts = (on != 0);
+    halo.n = 0;
+}
+
+/*
+ * Ghosts are in use only along at least a periodic direction
+ */
+static int halo_active(void)
+{
+    return ghosts && periodic;
+}
+
+static void alloc_halo(int size)
+{
+    halo.size = size;
+    halo.x = (double *)realloc(halo.x, size * sizeof(double));
+    halo.y = (double *)realloc(halo.y, size * sizeof(double));
+    halo.z = (double *)realloc(halo.z, size * sizeof(double));
+    halo.shift = (double *)realloc(halo.shift, 3 * size * sizeof(double));
+    halo.owner = (int *)realloc(halo.owner, size * sizeof(int));
+    assert(halo.x != NULL && halo.y != NULL && halo.z != NULL && halo.shift != NULL &&
+           halo.owner != NULL);
+}
+
+static double halo_coord(int k, int axis)
+{
+    return (axis == 0) ? halo.x[k] : (axis == 1) ? halo.y[k] : halo.z[k];
+}
+
+/*
+ * Appends to the halo the image of k translated by t along the axis
+ */
+static void add_ghost(int k, int axis, double t)
+{
+    int m;
+
+    if (halo.n == halo.size)
+        alloc_halo(2 * halo.size);
+
+    m = halo.n++;
+    halo.owner[m] = halo.owner[k];
+    halo.shift[3 * m] = halo.shift[3 * k];
+    halo.shift[3 * m + 1] = halo.shift[3 * k + 1];
+    halo.shift[3 * m + 2] = halo.shift[3 * k + 2];
+    halo.shift[3 * m + axis] += t;
+    halo.x[m] = halo.x[k] + ((axis == 0) ? t : 0);
+    halo.y[m] = halo.y[k] + ((axis == 1) ? t : 0);
+    halo.z[m] = halo.z[k] + ((axis == 2) ? t : 0);
+}
+
+/*
+ * Brings the atoms back in the box and replicates on the opposite side the
+ * ones closer than width to a face along a periodic direction: first along
+ * x, then along y and z including the ghosts already made, so that edges
+ * and corners are covered
+ */
+static void build_halo(double width)
+{
+    int i, k, a, n;
+    double c;
+
+    if (halo.size < N)
+        alloc_halo(2 * N);
+
+    for (i = 0; i < N; i++)
+    {
+        halo.owner[i] = i;
+        halo.shift[3 * i] = box.pbc[0] ? -box.l[0] * floor(xx[i] / box.l[0]) : 0;
+        halo.shift[3 * i + 1] = box.pbc[1] ? -box.l[1] * floor(yy[i] / box.l[1]) : 0;
+        halo.shift[3 * i + 2] = box.pbc[2] ? -box.l[2] * floor(zz[i] / box.l[2]) : 0;
+        halo.x[i] = xx[i] + halo.shift[3 * i];
+        halo.y[i] = yy[i] + halo.shift[3 * i + 1];
+        halo.z[i] = zz[i] + halo.shift[3 * i + 2];
+    }
+    halo.n = N;
+
+    for (a = 0; a < 3; a++)
+    {
+        if (!box.pbc[a])
+            continue;
+
+        /*an atom must not see its own images*/
+        assert(2 * width < box.l[a]);
+
+        n = halo.n;
+        for (k = 0; k < n; k++)
+        {
+            c = halo_coord(k, a);
+            if (c < width)
+                add_ghost(k, a, box.l[a]);
+            else if (c >= box.l[a] - width)
+                add_ghost(k, a, -box.l[a]);
+        }
+    }
+}
+
+halo_t *get_halo()
+{
+    int k;
+
+    if (!halo_active() || halo.n == 0)
+        return NULL;
+
+    for (k = 0; k < halo.n; k++)
+    {
+        halo.x[k] = xx[halo.owner[k]] + halo.shift[3 * k];
+        halo.y[k] = yy[halo.owner[k]] + halo.shift[3 * k + 1];
+        halo.z[k] = zz[halo.owner[k]] + halo.shift[3 * k + 2];
+    }
+
+    return &halo;
+}
+
+static double eval_dist1D(double a, double b, int axis)
 {
     double res;
 
     res = a - b;
-    if (pbc)
-        res -= SIZE * floor(res / SIZE + 0.5);
+    if (box.pbc[axis])
+        res -= box.l[axis] * floor(res / box.l[axis] + 0.5);
 
     return res;
 }
 
+/*
+ * Squared distance of the differences d[] of the positions, with the
+ * minimum image convention along the periodic directions (the check of the
+ * box is made once, since pairs are mostly evaluated in a box without
+ * periodic directions or with the ghosts)
+ */
+static double min_image2(double d[3])
+{
+    int a;
+
+    if (periodic)
+        for (a = 0; a < 3; a++)
+            d[a] = eval_dist1D(d[a], 0, a);
+
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
 static double eval_dist(double x1, double y1, double z1, double x2, double y2, double z2)
 {
-    return sqrt(eval_dist1D(x1, x2, PBCX) * eval_dist1D(x1, x2, PBCX) + eval_dist1D(y1, y2, PBCY) * eval_dist1D(y1, y2, PBCY) + eval_dist1D(z1, z2, PBCZ) * eval_dist1D(z1, z2, PBCZ));
+    double d[3];
+
+    d[0] = x1 - x2;
+    d[1] = y1 - y2;
+    d[2] = z1 - z2;
+
+    return sqrt(min_image2(d));
 }
 
 double eval_nn_distance()
@@ -153,20 +528,191 @@ double eval_nn_distance()
     return nn_distance;
 }
 
-static double lennard_jones(double r)
+/*
+ * Coefficients of the polinomial junction between rp and rc
+ */
+static void eval_coefficients(potential_t *p)
 {
-    assert(r < RC);
-    if (r < RP)
-        return 4 * EPS * (powerd(SIGMA / r, 12) - powerd(SIGMA / r, 6));
-    else
-        return A + B * powerd(r, 1) + C * powerd(r, 2) + D * powerd(r, 3) + E * powerd(r, 4) + F * powerd(r, 5) + G * powerd(r, 6) + H * powerd(r, 7);
+    double a, b, c, d, e, f, g, h, eps, sigma, rc, rp;
+
+    eps = p->eps;
+    sigma = p->sigma;
+    rc = p->rc;
+    rp = p->rp;
+
+    a = (1 / (powerd(rc - rp, 7) * powerd(rp, 12))) * 4 * eps * powerd(rc, 4) * powerd(sigma, 6) * (2 * powerd(rp, 6) * (-42 * powerd(rc, 3) + 182 * powerd(rc, 2) * rp - 273 * rc * powerd(rp, 2) + 143 * powerd(rp, 3)) + (455 * powerd(rc, 3) - 1729 * powerd(rc, 2) * rp + 2223 * rc * powerd(rp, 2) - 969 * powerd(rp, 3)) * powerd(sigma, 6));
+    b = (1 / (powerd(rc - rp, 7) * powerd(rp, 13))) * 16 * eps * powerd(rc, 3) * powerd(sigma, 6) * (powerd(rp, 6) * (54 * powerd(rc, 4) - 154 * powerd(rc, 3) * rp + 351 * rc * powerd(rp, 3) - 286 * powerd(rp, 4)) + (-315 * powerd(rc, 4) + 749 * powerd(rc, 3) * rp + 171 * powerd(rc, 2) * powerd(rp, 2) - 1539 * rc * powerd(rp, 3) + 969 * powerd(rp, 4)) * powerd(sigma, 6));
+    c = (1 / (powerd(rc - rp, 7) * powerd(rp, 14))) * 12 * eps * powerd(rc, 2) * powerd(sigma, 6) * (powerd(rp, 6) * (-63 * powerd(rc, 5) - 7 * powerd(rc, 4) * rp + 665 * powerd(rc, 3) * powerd(rp, 2) - 975 * powerd(rc, 2) * powerd(rp, 3) - 52 * rc * powerd(rp, 4) + 572 * powerd(rp, 5)) + 2 * (195 * powerd(rc, 5) + 91 * powerd(rc, 4) * rp - 1781 * powerd(rc, 3) * powerd(rp, 2) + 1995 * powerd(rc, 2) * powerd(rp, 3) + 399 * rc * powerd(rp, 4) - 969 * powerd(rp, 5)) * powerd(sigma, 6));
+    d = (1 / (powerd(rc - rp, 7) * powerd(rp, 15))) * 16 * eps * powerd(sigma, 6) * (rc * powerd(rp, 6) * (14 * powerd(rc, 6) + 126 * powerd(rc, 5) * rp - 420 * powerd(rc, 4) * powerd(rp, 2) - 90 * powerd(rc, 3) * powerd(rp, 3) + 1105 * powerd(rc, 2) * powerd(rp, 4) - 624 * rc * powerd(rp, 5) - 286 * powerd(rp, 6)) + rc * (-91 * powerd(rc, 6) - 819 * powerd(rc, 5) * rp + 2145 * powerd(rc, 4) * powerd(rp, 2) + 1125 * powerd(rc, 3) * powerd(rp, 3) - 5035 * powerd(rc, 2) * powerd(rp, 4) + 1881 * rc * powerd(rp, 5) + 969 * powerd(rp, 6)) * powerd(sigma, 6));
+    e = (1 / (powerd(rc - rp, 7) * powerd(rp, 15))) * 4 * eps * powerd(sigma, 6) * (2 * powerd(rp, 6) * (-112 * powerd(rc, 6) - 63 * powerd(rc, 5) * rp + 1305 * powerd(rc, 4) * powerd(rp, 2) - 1625 * powerd(rc, 3) * powerd(rp, 3) - 585 * powerd(rc, 2) * powerd(rp, 4) + 1287 * rc * powerd(rp, 5) + 143 * powerd(rp, 6)) + (1456 * powerd(rc, 6) + 1404 * powerd(rc, 5) * rp - 14580 * powerd(rc, 4) * powerd(rp, 2) + 13015 * powerd(rc, 3) * powerd(rp, 3) + 7695 * powerd(rc, 2) * powerd(rp, 4) - 8721 * rc * powerd(rp, 5) - 969 * powerd(rp, 6)) * powerd(sigma, 6));
+    f = (1 / (powerd(rc - rp, 7) * powerd(rp, 15))) * 48 * eps * powerd(sigma, 6) * (-powerd(rp, 6) * (-28 * powerd(rc, 5) + 63 * powerd(rc, 4) * rp + 65 * powerd(rc, 3) * powerd(rp, 2) - 247 * powerd(rc, 2) * powerd(rp, 3) + 117 * rc * powerd(rp, 4) + 65 * powerd(rp, 5)) + (-182 * powerd(rc, 5) + 312 * powerd(rc, 4) * rp + 475 * powerd(rc, 3) * powerd(rp, 2) - 1140 * powerd(rc, 2) * powerd(rp, 3) + 342 * rc * powerd(rp, 4) + 228 * powerd(rp, 5)) * powerd(sigma, 6));
+    g = (1 / (powerd(rc - rp, 7) * powerd(rp, 15))) * 4 * eps * powerd(sigma, 6) * (powerd(rp, 6) * (-224 * powerd(rc, 4) + 819 * powerd(rc, 3) * rp - 741 * powerd(rc, 2) * powerd(rp, 2) - 429 * rc * powerd(rp, 3) + 715 * powerd(rp, 4)) + 2 * (728 * powerd(rc, 4) - 2223 * powerd(rc, 3) * rp + 1425 * powerd(rc, 2) * powerd(rp, 2) + 1292 * rc * powerd(rp, 3) - 1292 * powerd(rp, 4)) * powerd(sigma, 6));
+    h = (1 / (powerd(rc - rp, 7) * powerd(rp, 15))) * 16 * eps * powerd(sigma, 6) * (powerd(rp, 6) * (14 * powerd(rc, 3) - 63 * powerd(rc, 2) * rp + 99 * rc * powerd(rp, 2) - 55 * powerd(rp, 3)) + (-91 * powerd(rc, 3) + 351 * powerd(rc, 2) * rp - 459 * rc * powerd(rp, 2) + 204 * powerd(rp, 3)) * powerd(sigma, 6));
+
+    p->poly[0] = a;
+    p->poly[1] = b;
+    p->poly[2] = c;
+    p->poly[3] = d;
+    p->poly[4] = e;
+    p->poly[5] = f;
+    p->poly[6] = g;
+    p->poly[7] = h;
+}
+
+void set_potential(double eps, double sigma, double rc, double rp)
+{
+    int k;
+
+    assert(sigma > 0 && rc > 0 && rp > 0);
+
+    pot.eps = eps;
+    pot.sigma = sigma;
+    pot.rc = rc;
+    pot.rp = rp;
+    pot.rc2 = rc * rc;
+    pot.rp2 = rp * rp;
+    pot.c12 = 4 * eps * powerd(sigma, 12);
+    pot.c6 = 4 * eps * powerd(sigma, 6);
+    pot.f12 = 48 * eps * powerd(sigma, 12);
+    pot.f6 = 24 * eps * powerd(sigma, 6);
+
+    for (k = 0; k < 8; k++)
+        pot.poly[k] = 0;
+
+    if (rp < rc)
+        eval_coefficients(&pot);
+
+    /*-U'(r)/r = dpoly[0]/r + dpoly[1] + dpoly[2]*r + ... + dpoly[6]*r^5*/
+    for (k = 0; k < 7; k++)
+        pot.dpoly[k] = -(k + 1) * pot.poly[k + 1];
+
+    pot_set = 1;
+}
+
+potential_t *get_potential()
+{
+    if (!pot_set)
+        set_potential(EPS, SIGMA, RC, RP);
+
+    return &pot;
+}
+
+/*
+ * Pair potential at the squared distance r2 < rc2, on exit *f is the force
+ * along the distance divided by the distance
+ */
+static double pair_potential(potential_t *p, double r2, double *f)
+{
+    double r, inv2, inv6;
+
+    if (r2 < p->rp2)
+    {
+        inv2 = 1 / r2;
+        inv6 = inv2 * inv2 * inv2;
+        *f = inv6 * inv2 * (p->f12 * inv6 - p->f6);
+
+        return inv6 * (p->c12 * inv6 - p->c6);
+    }
+
+    r = sqrt(r2);
+    *f = p->dpoly[0] / r + p->dpoly[1] + r * (p->dpoly[2] + r * (p->dpoly[3] + r * (p->dpoly[4] + r * (p->dpoly[5] + r * p->dpoly[6]))));
+
+    return p->poly[0] + r * (p->poly[1] + r * (p->poly[2] + r * (p->poly[3] + r * (p->poly[4] + r * (p->poly[5] + r * (p->poly[6] + r * p->poly[7]))))));
+}
+
+/*
+ * Squared distance of the atoms i and k, with its components in d[]
+ */
+static double eval_dist2(int i, int k, double d[3])
+{
+    d[0] = xx[i] - xx[k];
+    d[1] = yy[i] - yy[k];
+    d[2] = zz[i] - zz[k];
+
+    return periodic ? min_image2(d) : d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
+/*
+ * Cutoff of the neighbour lists: the one of the EAM tables while the EAM is
+ * in use, of the pair potential otherwise
+ */
+static double eval_cutoff()
+{
+    return eam_active() ? eam_cutoff() : get_potential()->rc;
+}
+
+/*
+ * Energy and, if with_forces != 0, forces of the pair potential with the
+ * ghosts of h. Every pair is visited once, from the atom with the lower
+ * index, with plain differences of the positions, and the force on a
+ * ghost is added to its owner.
+ */
+static double eval_pairs_halo(halo_t *h, int with_forces)
+{
+    int i, j, k, o;
+    double U, r2, f, dx, dy, dz;
+    potential_t *p;
+
+    p = get_potential();
+    U = 0;
+
+    for (i = 0; i < N && with_forces; i++)
+    {
+        Fxx[i] = 0;
+        Fyy[i] = 0;
+        Fzz[i] = 0;
+    }
+
+    for (i = 0; i < N; i++)
+    {
+        for (j = 0; j < number_nbrs[i]; j++)
+        {
+            k = which_nbrs[i][j];
+            o = h->owner[k];
+            if (o < i)
+                continue;
+
+            dx = h->x[i] - h->x[k];
+            dy = h->y[i] - h->y[k];
+            dz = h->z[i] - h->z[k];
+            r2 = dx * dx + dy * dy + dz * dz;
+            if (r2 >= p->rc2)
+                continue;
+
+            U += pair_potential(p, r2, &f);
+            if (with_forces)
+            {
+                Fxx[i] += f * dx;
+                Fyy[i] += f * dy;
+                Fzz[i] += f * dz;
+                Fxx[o] -= f * dx;
+                Fyy[o] -= f * dy;
+                Fzz[o] -= f * dz;
+            }
+        }
+    }
+
+    return U;
 }
 
 double eval_U()
 {
     int i, j, k;
-    double U;
+    double U, r2, f, d[3];
+    potential_t *p;
+    halo_t *h;
+
+    TIMER_START(TIMER_OBSERVABLES);
+    h = eam_active() ? NULL : get_halo();
+    if (eam_active() || h != NULL)
+    {
+        U = (h == NULL) ? eval_eam(0) : eval_pairs_halo(h, 0);
+        TIMER_STOP(TIMER_OBSERVABLES);
+        TIMER_PAIRS(TIMER_OBSERVABLES, count_pairs());
+        return U;
+    }
 
+    p = get_potential();
     U = 0;
 
     for (i = 0; i < N; i++)
@@ -174,21 +720,51 @@ double eval_U()
         for (j = 0; j < number_nbrs[i]; j++)
         {
             k = which_nbrs[i][j];
-            U += lennard_jones(eval_dist(xx[i], yy[i], zz[i], xx[k], yy[k], zz[k]));
+            r2 = eval_dist2(i, k, d);
+            if (r2 < p->rc2)
+                U += pair_potential(p, r2, &f);
         }
     }
     U /= 2;
 
+    TIMER_STOP(TIMER_OBSERVABLES);
+    TIMER_PAIRS(TIMER_OBSERVABLES, count_pairs());
+
     return U;
 }
 
-void eval_nbrs()
+static void build_nbrs(double cutoff)
 {
-    int i, j, count, *temp;
+    int i, j, count, n, plain, *temp;
+    double d[3], *x, *y, *z;
 
-    temp = (int *)malloc(N * sizeof(int));
+    TIMER_START(TIMER_NBRS);
+    PERF_START("neighbours");
 
-    free_all();
+    for (i = 0; i < N; i++)
+    {
+        free(which_nbrs[i]);
+        which_nbrs[i] = NULL;
+    }
+
+    /*with the ghosts the neighbours k >= N are images of the atoms*/
+    n = N;
+    x = xx;
+    y = yy;
+    z = zz;
+    if (halo_active())
+    {
+        build_halo(cutoff);
+        n = halo.n;
+        x = halo.x;
+        y = halo.y;
+        z = halo.z;
+    }
+    temp = (int *)malloc(n * sizeof(int));
+    assert(temp != NULL);
+
+    /*minimum image only along periodic directions without the ghosts*/
+    plain = (n > N) || !periodic;
 
     for (i = 0; i < N; i++)
     {
@@ -196,12 +772,17 @@ void eval_nbrs()
         count = 0;
 
         /*I calculate the number of neighbors and save their indexes in temp*/
-        for (j = 0; j < N; j++)
-            if (eval_dist(xx[i], yy[i], zz[i], xx[j], yy[j], zz[j]) < RC && j != i)
+        for (j = 0; j < n; j++)
+        {
+            d[0] = x[i] - x[j];
+            d[1] = y[i] - y[j];
+            d[2] = z[i] - z[j];
+            if ((plain ? d[0] * d[0] + d[1] * d[1] + d[2] * d[2] : min_image2(d)) < cutoff * cutoff && j != i)
             {
                 number_nbrs[i]++;
                 temp[count++] = j;
             }
+        }
         /*I allocate the memory for which_nbrs[i] and copy the indexes from temp*/
         if (number_nbrs[i] != 0)
         {
@@ -211,15 +792,149 @@ void eval_nbrs()
         }
     }
     free(temp);
+
+    PERF_STOP("neighbours");
+    TIMER_STOP(TIMER_NBRS);
+    TIMER_PAIRS(TIMER_NBRS, (double)N * n);
+    TIMER_NBRS_BUILD(N, count_pairs(), max_nbrs());
+}
+
+void eval_nbrs()
+{
+    if (reorder_every > 0 && n_builds++ % reorder_every == 0)
+        reorder_atoms();
+
+    build_nbrs(eval_cutoff());
+}
+
+void set_reordering(int every)
+{
+    assert(every >= 0);
+
+    reorder_every = every;
+    n_builds = 0;
+}
+
+/*
+ * Spreads the lowest MORTON_BITS bits of v on the bits 0, 3, 6, ... of the
+ * result
+ */
+static unsigned long spread_bits(unsigned long v)
+{
+    v &= 0x3ffUL;
+    v = (v | (v << 16)) & 0x30000ffUL;
+    v = (v | (v << 8)) & 0x300f00fUL;
+    v = (v | (v << 4)) & 0x30c30c3UL;
+    v = (v | (v << 2)) & 0x9249249UL;
+
+    return v;
+}
+
+/*
+ * Cell of the coordinate a (brought back in the box along periodic
+ * directions) on a grid of 2^MORTON_BITS cells between lo and hi
+ */
+static unsigned long morton_cell(double a, double lo, double hi, int axis)
+{
+    if (box.pbc[axis])
+        a -= box.l[axis] * floor(a / box.l[axis]);
+    if (hi <= lo)
+        return 0;
+
+    return (unsigned long)((a - lo) / (hi - lo) * ((1 << MORTON_BITS) - 1) + 0.5);
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    const morton_t *ka = (const morton_t *)a, *kb = (const morton_t *)b;
+
+    if (ka->key != kb->key)
+        return (ka->key < kb->key) ? -1 : 1;
+
+    return ka->slot - kb->slot;
+}
+
+/*
+ * a[i] = a[order[i].slot] for every i, through the buffer tmp
+ */
+static void permute(double a[], morton_t order[], double tmp[])
+{
+    int i;
+
+    for (i = 0; i < N; i++)
+        tmp[i] = a[order[i].slot];
+    for (i = 0; i < N; i++)
+        a[i] = tmp[i];
+}
+
+void reorder_atoms()
+{
+    int i, k, *id;
+    double *x[3], lo[3], hi[3], a, *tmp;
+    morton_t *order;
+
+    TIMER_START(TIMER_NBRS);
+    PERF_START("reorder");
+    x[0] = xx;
+    x[1] = yy;
+    x[2] = zz;
+
+    for (k = 0; k < 3; k++)
+    {
+        lo[k] = box.pbc[k] ? 0 : x[k][0];
+        hi[k] = box.pbc[k] ? box.l[k] : x[k][0];
+        for (i = 0; i < N && !box.pbc[k]; i++)
+        {
+            a = x[k][i];
+            lo[k] = (a < lo[k]) ? a : lo[k];
+            hi[k] = (a > hi[k]) ? a : hi[k];
+        }
+    }
+
+    order = (morton_t *)malloc(N * sizeof(morton_t));
+    tmp = (double *)malloc(N * sizeof(double));
+    assert(order != NULL && tmp != NULL);
+
+    for (i = 0; i < N; i++)
+    {
+        order[i].slot = i;
+        order[i].key = spread_bits(morton_cell(xx[i], lo[0], hi[0], 0)) |
+                       (spread_bits(morton_cell(yy[i], lo[1], hi[1], 1)) << 1) |
+                       (spread_bits(morton_cell(zz[i], lo[2], hi[2], 2)) << 2);
+    }
+    qsort(order, N, sizeof(morton_t), compare_keys);
+
+    permute(xx, order, tmp);
+    permute(yy, order, tmp);
+    permute(zz, order, tmp);
+    permute(vxx, order, tmp);
+    permute(vyy, order, tmp);
+    permute(vzz, order, tmp);
+    permute(Fxx, order, tmp);
+    permute(Fyy, order, tmp);
+    permute(Fzz, order, tmp);
+
+    id = (int *)tmp; /*N ints fit in N doubles*/
+    for (i = 0; i < N; i++)
+        id[i] = atom_id[order[i].slot];
+    for (i = 0; i < N; i++)
+    {
+        atom_id[i] = id[i];
+        atom_slot[atom_id[i]] = i;
+    }
+
+    free(order);
+    free(tmp);
+    PERF_STOP("reorder");
+    TIMER_STOP(TIMER_NBRS);
 }
 
 void generate_inital_v()
 {
     int i;
-    double c, r[3 * N], v_tot_x, v_tot_y, v_tot_z, T_temp;
+    double c, r[3], v_tot_x, v_tot_y, v_tot_z, T_temp;
+    phx_state_t st;
 
-    rlxd_init(1, 3122000); /*seed*/
-    ranlxd(r, 3 * N);
     c = sqrt(3 * KB * T_INIT / M);
     v_tot_x = 0;
     v_tot_y = 0;
@@ -228,9 +943,11 @@ void generate_inital_v()
     /*Generate inital velocities*/
     for (i = 0; i < N; i++)
     {
-        vxx[i] = 2 * c * (r[i] - 0.5);
-        vyy[i] = 2 * c * (r[i + N] - 0.5);
-        vzz[i] = 2 * c * (r[i + 2 * N] - 0.5);
+        phx_init_r(&st, 3122000, 0, atom_id[i], 0); /*seed*/
+        ranphx_r(&st, r, 3);
+        vxx[i] = 2 * c * (r[0] - 0.5);
+        vyy[i] = 2 * c * (r[1] - 0.5);
+        vzz[i] = 2 * c * (r[2] - 0.5);
         v_tot_x += vxx[i];
         v_tot_y += vyy[i];
         v_tot_z += vzz[i];
@@ -259,12 +976,17 @@ double eval_K()
 {
     int i;
     double K;
+
+    TIMER_START(TIMER_OBSERVABLES);
     K = 0;
 
     for (i = 0; i < N; i++)
         K += vxx[i] * vxx[i] + vyy[i] * vyy[i] + vzz[i] * vzz[i];
 
     K *= M / 2;
+
+    TIMER_STOP(TIMER_OBSERVABLES);
+
     return K;
 }
 
@@ -274,9 +996,31 @@ double eval_temperature()
 }
 
 void eval_forces()
+{
+    eval_U_and_forces();
+}
+
+double eval_U_and_forces()
 {
     int i, j, k;
-    double r;
+    double r2, U, f, d[3];
+    potential_t *p;
+    halo_t *h;
+
+    TIMER_START(TIMER_FORCES);
+    PERF_START("forces");
+    h = eam_active() ? NULL : get_halo();
+    if (eam_active() || h != NULL)
+    {
+        U = (h == NULL) ? eval_eam(1) : eval_pairs_halo(h, 1);
+        PERF_STOP("forces");
+        TIMER_STOP(TIMER_FORCES);
+        TIMER_PAIRS(TIMER_FORCES, count_pairs());
+        return U;
+    }
+
+    p = get_potential();
+    U = 0;
 
     for (i = 0; i < N; i++)
     {
@@ -286,55 +1030,64 @@ void eval_forces()
         for (j = 0; j < number_nbrs[i]; j++)
         {
             k = which_nbrs[i][j];
-            r = eval_dist(xx[i], yy[i], zz[i], xx[k], yy[k], zz[k]);
-            assert(r < RC);
-            if (r < RP)
-            {
-                Fxx[i] += 24 * EPS * powerd(SIGMA, 6) * powerd(r, -8) * eval_dist1D(xx[i], xx[k], PBCX) * (2 * powerd(SIGMA, 6) * powerd(r, -6) - 1);
-                Fyy[i] += 24 * EPS * powerd(SIGMA, 6) * powerd(r, -8) * eval_dist1D(yy[i], yy[k], PBCY) * (2 * powerd(SIGMA, 6) * powerd(r, -6) - 1);
-                Fzz[i] += 24 * EPS * powerd(SIGMA, 6) * powerd(r, -8) * eval_dist1D(zz[i], zz[k], PBCZ) * (2 * powerd(SIGMA, 6) * powerd(r, -6) - 1);
-            }
-            else
-            {
-                Fxx[i] -= eval_dist1D(xx[i], xx[k], PBCX) * (B * powerd(r, -1) + 2 * C + 3 * D * r + 4 * E * powerd(r, 2) + 5 * F * powerd(r, 3) + 6 * G * powerd(r, 4) + 7 * H * powerd(r, 5));
-                Fyy[i] -= eval_dist1D(yy[i], yy[k], PBCY) * (B * powerd(r, -1) + 2 * C + 3 * D * r + 4 * E * powerd(r, 2) + 5 * F * powerd(r, 3) + 6 * G * powerd(r, 4) + 7 * H * powerd(r, 5));
-                Fzz[i] -= eval_dist1D(zz[i], zz[k], PBCZ) * (B * powerd(r, -1) + 2 * C + 3 * D * r + 4 * E * powerd(r, 2) + 5 * F * powerd(r, 3) + 6 * G * powerd(r, 4) + 7 * H * powerd(r, 5));
-            }
+            r2 = eval_dist2(i, k, d);
+            if (r2 >= p->rc2)
+                continue;
+
+            U += pair_potential(p, r2, &f);
+            Fxx[i] += f * d[0];
+            Fyy[i] += f * d[1];
+            Fzz[i] += f * d[2];
         }
     }
+
+    PERF_STOP("forces");
+    TIMER_STOP(TIMER_FORCES);
+    TIMER_PAIRS(TIMER_FORCES, count_pairs());
+
+    return U / 2;
 }
 
 void verlet_evolution()
 {
     int i;
-    double old_Fx[N], old_Fy[N], old_Fz[N];
 
+    TIMER_START(TIMER_INTEGRATION);
+
+    /*half kick and drift, so that no per-atom state is kept across
+      eval_nbrs(), which may reorder the atoms*/
     for (i = 0; i < N; i++)
     {
-        old_Fx[i] = Fxx[i];
-        old_Fy[i] = Fyy[i];
-        old_Fz[i] = Fzz[i];
+        vxx[i] += Fxx[i] * DT / (2 * M);
+        vyy[i] += Fyy[i] * DT / (2 * M);
+        vzz[i] += Fzz[i] * DT / (2 * M);
 
-        xx[i] += vxx[i] * DT + Fxx[i] * DT * DT / (2 * M);
-        yy[i] += vyy[i] * DT + Fyy[i] * DT * DT / (2 * M);
-        zz[i] += vzz[i] * DT + Fzz[i] * DT * DT / (2 * M);
+        xx[i] += vxx[i] * DT;
+        yy[i] += vyy[i] * DT;
+        zz[i] += vzz[i] * DT;
     }
 
+    TIMER_STOP(TIMER_INTEGRATION);
     eval_nbrs();
     eval_forces();
+    TIMER_START(TIMER_INTEGRATION);
 
     for (i = 0; i < N; i++)
     {
-        vxx[i] += (Fxx[i] + old_Fx[i]) * DT / (2 * M);
-        vyy[i] += (Fyy[i] + old_Fy[i]) * DT / (2 * M);
-        vzz[i] += (Fzz[i] + old_Fz[i]) * DT / (2 * M);
+        vxx[i] += Fxx[i] * DT / (2 * M);
+        vyy[i] += Fyy[i] * DT / (2 * M);
+        vzz[i] += Fzz[i] * DT / (2 * M);
     }
+
+    TIMER_STOP(TIMER_INTEGRATION);
 }
 
 void euler_evolution()
 {
     int i;
 
+    TIMER_START(TIMER_INTEGRATION);
+
     for (i = 0; i < N; i++)
     {
         xx[i] += DT * vxx[i];
@@ -345,13 +1098,184 @@ void euler_evolution()
         vzz[i] += DT * Fzz[i] / M;
     }
 
+    TIMER_STOP(TIMER_INTEGRATION);
     eval_nbrs();
     eval_forces();
 }
 
+/*
+ * State of the thermostats: step of the Langevin noise, positions and
+ * velocities (1/s) of the Nose-Hoover chain
+ */
+static int langevin_step = 0;
+static double xi[NH_CHAIN], v_xi[NH_CHAIN];
+
+static void gauss_triplet(int i, double g[3])
+{
+    double r[4], rho;
+    phx_state_t st;
+
+    phx_init_r(&st, 3122000, 1, atom_id[i], langevin_step); /*seed, replica 1 for the noise*/
+    ranphx_r(&st, r, 4);
+
+    /*Box-Muller, 1-r is in (0,1]*/
+    rho = sqrt(-2 * log(1 - r[0]));
+    g[0] = rho * cos(2 * PI * r[1]);
+    g[1] = rho * sin(2 * PI * r[1]);
+    g[2] = sqrt(-2 * log(1 - r[2])) * cos(2 * PI * r[3]);
+}
+
+void langevin_evolution(double t, double gamma)
+{
+    int i;
+    double c1, c2, g[3];
+
+    assert(t >= 0 && gamma >= 0);
+
+    TIMER_START(TIMER_INTEGRATION);
+    c1 = exp(-gamma * DT);
+    c2 = sqrt((1 - c1 * c1) * KB * t / M);
+
+    for (i = 0; i < N; i++)
+    {
+        vxx[i] += Fxx[i] * DT / (2 * M);
+        vyy[i] += Fyy[i] * DT / (2 * M);
+        vzz[i] += Fzz[i] * DT / (2 * M);
+
+        xx[i] += vxx[i] * DT / 2;
+        yy[i] += vyy[i] * DT / 2;
+        zz[i] += vzz[i] * DT / 2;
+
+        gauss_triplet(i, g);
+        vxx[i] = c1 * vxx[i] + c2 * g[0];
+        vyy[i] = c1 * vyy[i] + c2 * g[1];
+        vzz[i] = c1 * vzz[i] + c2 * g[2];
+
+        xx[i] += vxx[i] * DT / 2;
+        yy[i] += vyy[i] * DT / 2;
+        zz[i] += vzz[i] * DT / 2;
+    }
+
+    TIMER_STOP(TIMER_INTEGRATION);
+    eval_nbrs();
+    eval_forces();
+    TIMER_START(TIMER_INTEGRATION);
+
+    for (i = 0; i < N; i++)
+    {
+        vxx[i] += Fxx[i] * DT / (2 * M);
+        vyy[i] += Fyy[i] * DT / (2 * M);
+        vzz[i] += Fzz[i] * DT / (2 * M);
+    }
+
+    langevin_step++;
+    TIMER_STOP(TIMER_INTEGRATION);
+}
+
+/*
+ * Force on the thermostat j of the chain (1/s^2), given twice the kinetic
+ * energy of the atoms. The masses are Q_0 = 3N*KB*t*tau^2 and
+ * Q_j = KB*t*tau^2 for j > 0.
+ */
+static double chain_force(int j, double k2, double kt, double tau)
+{
+    if (j == 0)
+        return (k2 - 3 * N * kt) / (3 * N * kt * tau * tau);
+
+    return v_xi[j - 1] * v_xi[j - 1] * (j == 1 ? 3 * N : 1) - 1 / (tau * tau);
+}
+
+static void chain_half_step(double t, double tau)
+{
+    int i, j;
+    double kt, k2, a, scale;
+
+    TIMER_START(TIMER_THERMOSTAT);
+    kt = KB * t;
+    k2 = 0;
+    for (i = 0; i < N; i++)
+        k2 += M * (vxx[i] * vxx[i] + vyy[i] * vyy[i] + vzz[i] * vzz[i]);
+
+    for (j = NH_CHAIN - 1; j >= 0; j--)
+    {
+        a = (j < NH_CHAIN - 1) ? exp(-v_xi[j + 1] * DT / 8) : 1;
+        v_xi[j] = (v_xi[j] * a + chain_force(j, k2, kt, tau) * DT / 4) * a;
+    }
+
+    scale = exp(-v_xi[0] * DT / 2);
+
+    for (i = 0; i < N; i++)
+    {
+        vxx[i] *= scale;
+        vyy[i] *= scale;
+        vzz[i] *= scale;
+    }
+
+    k2 *= scale * scale;
+
+    for (j = 0; j < NH_CHAIN; j++)
+        xi[j] += v_xi[j] * DT / 2;
+
+    for (j = 0; j < NH_CHAIN; j++)
+    {
+        a = (j < NH_CHAIN - 1) ? exp(-v_xi[j + 1] * DT / 8) : 1;
+        v_xi[j] = (v_xi[j] * a + chain_force(j, k2, kt, tau) * DT / 4) * a;
+    }
+
+    TIMER_STOP(TIMER_THERMOSTAT);
+}
+
+void nose_hoover_evolution(double t, double tau)
+{
+    assert(t > 0 && tau > 0);
+
+    chain_half_step(t, tau);
+    verlet_evolution();
+    chain_half_step(t, tau);
+}
+
+void nvt_evolution(int thermostat, double t, double coupling)
+{
+    assert(thermostat == LANGEVIN || thermostat == NOSE_HOOVER);
+
+    if (thermostat == LANGEVIN)
+        langevin_evolution(t, coupling);
+    else
+        nose_hoover_evolution(t, coupling);
+}
+
+double eval_nose_hoover_energy(double t, double tau)
+{
+    int j;
+    double kt, q, energy;
+
+    kt = KB * t;
+    q = kt * tau * tau;
+    energy = eval_K() + eval_U() + 3 * N * (q * v_xi[0] * v_xi[0] / 2 + kt * xi[0]);
+
+    for (j = 1; j < NH_CHAIN; j++)
+        energy += q * v_xi[j] * v_xi[j] / 2 + kt * xi[j];
+
+    return energy;
+}
+
+void reset_thermostat()
+{
+    int j;
+
+    langevin_step = 0;
+
+    for (j = 0; j < NH_CHAIN; j++)
+    {
+        xi[j] = 0;
+        v_xi[j] = 0;
+    }
+}
+
 void thermalization(char file_name[])
 {
     int i;
+    double energy, temperature;
 
     if (file_name[0] == '\0')
     {
@@ -376,58 +1300,71 @@ void thermalization(char file_name[])
         for (i = 0; i * DT < TERM_TIME; i++)
         {
             verlet_evolution();
-            fprintf(fd, "%.15e %.15e %.15e\n", i * DT, eval_K() + eval_U(), eval_temperature());
+            energy = eval_K() + eval_U();
+            temperature = eval_temperature();
+
+            TIMER_START(TIMER_IO);
+            fprintf(fd, "%.15e %.15e %.15e\n", i * DT, energy, temperature);
+            TIMER_STOP(TIMER_IO);
         }
 
         fclose(fd);
     }
 }
 
-void eval_coefficients()
+void thermalization_nvt(char file_name[], int thermostat, double t, double coupling)
 {
-    double a, b, c, d, e, f, g, h;
+    int i;
+    double energy, temperature;
+    FILE *fd;
 
-    a = (1 / (powerd(RC - RP, 7) * powerd(RP, 12))) * 4 * EPS * powerd(RC, 4) * powerd(SIGMA, 6) * (2 * powerd(RP, 6) * (-42 * powerd(RC, 3) + 182 * powerd(RC, 2) * RP - 273 * RC * powerd(RP, 2) + 143 * powerd(RP, 3)) + (455 * powerd(RC, 3) - 1729 * powerd(RC, 2) * RP + 2223 * RC * powerd(RP, 2) - 969 * powerd(RP, 3)) * powerd(SIGMA, 6));
-    b = (1 / (powerd(RC - RP, 7) * powerd(RP, 13))) * 16 * EPS * powerd(RC, 3) * powerd(SIGMA, 6) * (powerd(RP, 6) * (54 * powerd(RC, 4) - 154 * powerd(RC, 3) * RP + 351 * RC * powerd(RP, 3) - 286 * powerd(RP, 4)) + (-315 * powerd(RC, 4) + 749 * powerd(RC, 3) * RP + 171 * powerd(RC, 2) * powerd(RP, 2) - 1539 * RC * powerd(RP, 3) + 969 * powerd(RP, 4)) * powerd(SIGMA, 6));
-    c = (1 / (powerd(RC - RP, 7) * powerd(RP, 14))) * 12 * EPS * powerd(RC, 2) * powerd(SIGMA, 6) * (powerd(RP, 6) * (-63 * powerd(RC, 5) - 7 * powerd(RC, 4) * RP + 665 * powerd(RC, 3) * powerd(RP, 2) - 975 * powerd(RC, 2) * powerd(RP, 3) - 52 * RC * powerd(RP, 4) + 572 * powerd(RP, 5)) + 2 * (195 * powerd(RC, 5) + 91 * powerd(RC, 4) * RP - 1781 * powerd(RC, 3) * powerd(RP, 2) + 1995 * powerd(RC, 2) * powerd(RP, 3) + 399 * RC * powerd(RP, 4) - 969 * powerd(RP, 5)) * powerd(SIGMA, 6));
-    d = (1 / (powerd(RC - RP, 7) * powerd(RP, 15))) * 16 * EPS * powerd(SIGMA, 6) * (RC * powerd(RP, 6) * (14 * powerd(RC, 6) + 126 * powerd(RC, 5) * RP - 420 * powerd(RC, 4) * powerd(RP, 2) - 90 * powerd(RC, 3) * powerd(RP, 3) + 1105 * powerd(RC, 2) * powerd(RP, 4) - 624 * RC * powerd(RP, 5) - 286 * powerd(RP, 6)) + RC * (-91 * powerd(RC, 6) - 819 * powerd(RC, 5) * RP + 2145 * powerd(RC, 4) * powerd(RP, 2) + 1125 * powerd(RC, 3) * powerd(RP, 3) - 5035 * powerd(RC, 2) * powerd(RP, 4) + 1881 * RC * powerd(RP, 5) + 969 * powerd(RP, 6)) * powerd(SIGMA, 6));
-    e = (1 / (powerd(RC - RP, 7) * powerd(RP, 15))) * 4 * EPS * powerd(SIGMA, 6) * (2 * powerd(RP, 6) * (-112 * powerd(RC, 6) - 63 * powerd(RC, 5) * RP + 1305 * powerd(RC, 4) * powerd(RP, 2) - 1625 * powerd(RC, 3) * powerd(RP, 3) - 585 * powerd(RC, 2) * powerd(RP, 4) + 1287 * RC * powerd(RP, 5) + 143 * powerd(RP, 6)) + (1456 * powerd(RC, 6) + 1404 * powerd(RC, 5) * RP - 14580 * powerd(RC, 4) * powerd(RP, 2) + 13015 * powerd(RC, 3) * powerd(RP, 3) + 7695 * powerd(RC, 2) * powerd(RP, 4) - 8721 * RC * powerd(RP, 5) - 969 * powerd(RP, 6)) * powerd(SIGMA, 6));
-    f = (1 / (powerd(RC - RP, 7) * powerd(RP, 15))) * 48 * EPS * powerd(SIGMA, 6) * (-powerd(RP, 6) * (-28 * powerd(RC, 5) + 63 * powerd(RC, 4) * RP + 65 * powerd(RC, 3) * powerd(RP, 2) - 247 * powerd(RC, 2) * powerd(RP, 3) + 117 * RC * powerd(RP, 4) + 65 * powerd(RP, 5)) + (-182 * powerd(RC, 5) + 312 * powerd(RC, 4) * RP + 475 * powerd(RC, 3) * powerd(RP, 2) - 1140 * powerd(RC, 2) * powerd(RP, 3) + 342 * RC * powerd(RP, 4) + 228 * powerd(RP, 5)) * powerd(SIGMA, 6));
-    g = (1 / (powerd(RC - RP, 7) * powerd(RP, 15))) * 4 * EPS * powerd(SIGMA, 6) * (powerd(RP, 6) * (-224 * powerd(RC, 4) + 819 * powerd(RC, 3) * RP - 741 * powerd(RC, 2) * powerd(RP, 2) - 429 * RC * powerd(RP, 3) + 715 * powerd(RP, 4)) + 2 * (728 * powerd(RC, 4) - 2223 * powerd(RC, 3) * RP + 1425 * powerd(RC, 2) * powerd(RP, 2) + 1292 * RC * powerd(RP, 3) - 1292 * powerd(RP, 4)) * powerd(SIGMA, 6));
-    h = (1 / (powerd(RC - RP, 7) * powerd(RP, 15))) * 16 * EPS * powerd(SIGMA, 6) * (powerd(RP, 6) * (14 * powerd(RC, 3) - 63 * powerd(RC, 2) * RP + 99 * RC * powerd(RP, 2) - 55 * powerd(RP, 3)) + (-91 * powerd(RC, 3) + 351 * powerd(RC, 2) * RP - 459 * RC * powerd(RP, 2) + 204 * powerd(RP, 3)) * powerd(SIGMA, 6));
+    eval_nbrs();
+    eval_forces();
+    generate_inital_v();
+    reset_thermostat();
 
-    printf("#define A ");
-    printf("%.15e\n", a);
-    printf("#define B ");
-    printf("%.15e\n", b);
-    printf("#define C ");
-    printf("%.15e\n", c);
-    printf("#define D ");
-    printf("%.15e\n", d);
-    printf("#define E ");
-    printf("%.15e\n", e);
-    printf("#define F ");
-    printf("%.15e\n", f);
-    printf("#define G ");
-    printf("%.15e\n", g);
-    printf("#define H ");
-    printf("%.15e\n", h);
+    fd = NULL;
+    if (file_name[0] != '\0')
+    {
+        fd = fopen(file_name, "w");
+        assert(fd != NULL);
+    }
+
+    for (i = 0; i * DT < TERM_TIME; i++)
+    {
+        nvt_evolution(thermostat, t, coupling);
+
+        if (fd != NULL)
+        {
+            energy = eval_K() + eval_U();
+            temperature = eval_temperature();
+
+            TIMER_START(TIMER_IO);
+            fprintf(fd, "%.15e %.15e %.15e\n", i * DT, energy, temperature);
+            TIMER_STOP(TIMER_IO);
+        }
+    }
+
+    if (fd != NULL)
+        fclose(fd);
 }
 
 void print_potential()
 {
-    double r;
+    double r, f;
     char file_name[100];
     FILE *fd;
+    potential_t *p;
 
+    p = get_potential();
     r = 2.5;
 
     sprintf(file_name, "../../data/test_files/potential.dat");
     fd = fopen(file_name, "w");
 
-    while (r < RC)
+    while (r < p->rc)
     {
-        fprintf(fd, "%.15e %.15e\n", r, lennard_jones(r));
+        fprintf(fd, "%.15e %.15e\n", r, pair_potential(p, r * r, &f));
         r += 0.0001;
     }
 
@@ -495,18 +1432,25 @@ double eval_max_force()
     return max_force;
 }
 
-void steepest_descent(char file_name[])
+int steepest_descent(char file_name[])
 {
-    int i;
+    int i, n_forces;
     FILE *fd;
     double max_force;
 
-    fd = fopen(file_name, "w");
+    fd = NULL;
+    if (file_name[0] != '\0')
+    {
+        fd = fopen(file_name, "w");
+        assert(fd != NULL);
+    }
 
     eval_nbrs();
     eval_forces();
+    n_forces = 1;
     max_force = eval_max_force();
-    fprintf(fd, "%.15e %.15e\n", max_force, eval_U());
+    if (fd != NULL)
+        fprintf(fd, "%.15e %.15e\n", max_force, eval_U());
 
     while (max_force > MAX_FORCE)
     {
@@ -519,10 +1463,376 @@ void steepest_descent(char file_name[])
 
         eval_nbrs();
         eval_forces();
+        n_forces++;
         max_force = eval_max_force();
 
+        if (fd != NULL)
+            fprintf(fd, "%.15e %.15e\n", max_force, eval_U());
+    }
+
+    if (fd != NULL)
+        fclose(fd);
+
+    return n_forces;
+}
+
+int fire(char file_name[])
+{
+    int i, n_forces, n_positive;
+    FILE *fd;
+    double max_force, dt, alpha, power, norm_v, norm_F, mix;
+
+    fd = NULL;
+    if (file_name[0] != '\0')
+    {
+        fd = fopen(file_name, "w");
+        assert(fd != NULL);
+    }
+
+    for (i = 0; i < N; i++)
+    {
+        vxx[i] = 0;
+        vyy[i] = 0;
+        vzz[i] = 0;
+    }
+
+    dt = DT;
+    alpha = FIRE_ALPHA;
+    n_positive = 0;
+
+    eval_nbrs();
+    eval_forces();
+    n_forces = 1;
+    max_force = eval_max_force();
+    if (fd != NULL)
         fprintf(fd, "%.15e %.15e\n", max_force, eval_U());
+
+    while (max_force > MAX_FORCE)
+    {
+        power = 0;
+        norm_v = 0;
+        norm_F = 0;
+
+        for (i = 0; i < N; i++)
+        {
+            power += Fxx[i] * vxx[i] + Fyy[i] * vyy[i] + Fzz[i] * vzz[i];
+            norm_v += vxx[i] * vxx[i] + vyy[i] * vyy[i] + vzz[i] * vzz[i];
+            norm_F += Fxx[i] * Fxx[i] + Fyy[i] * Fyy[i] + Fzz[i] * Fzz[i];
+        }
+
+        if (power > 0)
+        {
+            /*v = (1-alpha)*v + alpha*|v|*F/|F|*/
+            mix = alpha * sqrt(norm_v / norm_F);
+
+            for (i = 0; i < N; i++)
+            {
+                vxx[i] = (1 - alpha) * vxx[i] + mix * Fxx[i];
+                vyy[i] = (1 - alpha) * vyy[i] + mix * Fyy[i];
+                vzz[i] = (1 - alpha) * vzz[i] + mix * Fzz[i];
+            }
+
+            if (++n_positive > FIRE_N_MIN)
+            {
+                dt = (dt * FIRE_F_INC < FIRE_DT_MAX) ? dt * FIRE_F_INC : FIRE_DT_MAX;
+                alpha *= FIRE_F_ALPHA;
+            }
+        }
+        else
+        {
+            n_positive = 0;
+            dt *= FIRE_F_DEC;
+            alpha = FIRE_ALPHA;
+
+            for (i = 0; i < N; i++)
+            {
+                vxx[i] = 0;
+                vyy[i] = 0;
+                vzz[i] = 0;
+            }
+        }
+
+        for (i = 0; i < N; i++)
+        {
+            vxx[i] += Fxx[i] * dt / M;
+            vyy[i] += Fyy[i] * dt / M;
+            vzz[i] += Fzz[i] * dt / M;
+
+            xx[i] += vxx[i] * dt;
+            yy[i] += vyy[i] * dt;
+            zz[i] += vzz[i] * dt;
+        }
+
+        eval_nbrs();
+        eval_forces();
+        n_forces++;
+        max_force = eval_max_force();
+
+        if (fd != NULL)
+            fprintf(fd, "%.15e %.15e\n", max_force, eval_U());
     }
 
-    fclose(fd);
-}
\ No newline at end of file
+    for (i = 0; i < N; i++)
+    {
+        vxx[i] = 0;
+        vyy[i] = 0;
+        vzz[i] = 0;
+    }
+
+    if (fd != NULL)
+        fclose(fd);
+
+    return n_forces;
+}
+
+/*
+ * Positions and forces of the atoms as vectors of 3N components
+ */
+static void get_positions(double x[])
+{
+    int i;
+
+    for (i = 0; i < N; i++)
+    {
+        x[3 * i] = xx[i];
+        x[3 * i + 1] = yy[i];
+        x[3 * i + 2] = zz[i];
+    }
+}
+
+static void set_positions(double x[])
+{
+    int i;
+
+    for (i = 0; i < N; i++)
+    {
+        xx[i] = x[3 * i];
+        yy[i] = x[3 * i + 1];
+        zz[i] = x[3 * i + 2];
+    }
+}
+
+static void get_forces(double f[])
+{
+    int i;
+
+    for (i = 0; i < N; i++)
+    {
+        f[3 * i] = Fxx[i];
+        f[3 * i + 1] = Fyy[i];
+        f[3 * i + 2] = Fzz[i];
+    }
+}
+
+static double dot(double a[], double b[])
+{
+    int i;
+    double res;
+
+    res = 0;
+    for (i = 0; i < 3 * N; i++)
+        res += a[i] * b[i];
+
+    return res;
+}
+
+/*
+ * Energy and forces at the positions x, rebuilding the neighbour lists if
+ * an atom has moved more than LBFGS_SKIN/2 since the positions x_list of
+ * the last build
+ */
+static double lbfgs_eval(double x[], double x_list[])
+{
+    int i;
+    double d2, max_d2;
+
+    set_positions(x);
+    max_d2 = 0;
+
+    for (i = 0; i < N; i++)
+    {
+        d2 = eval_dist(x[3 * i], x[3 * i + 1], x[3 * i + 2], x_list[3 * i], x_list[3 * i + 1],
+                       x_list[3 * i + 2]);
+        d2 *= d2;
+        if (d2 > max_d2)
+            max_d2 = d2;
+    }
+
+    if (max_d2 > LBFGS_SKIN * LBFGS_SKIN / 4)
+    {
+        build_nbrs(eval_cutoff() + LBFGS_SKIN);
+        for (i = 0; i < 3 * N; i++)
+            x_list[i] = x[i];
+    }
+
+    return eval_U_and_forces();
+}
+
+int lbfgs(char file_name[])
+{
+    int i, k, n, n_pairs, newest, n_forces, iter, failed;
+    double *x, *x_new, *x_list, *f, *f_new, *d, *s, *y, rho[LBFGS_MEMORY], a[LBFGS_MEMORY];
+    double U, U_new, max_force, step, slope, beta, max_d, gamma;
+    FILE *fd;
+
+    x = (double *)malloc((6 + 2 * LBFGS_MEMORY) * 3 * N * sizeof(double));
+    assert(x != NULL);
+    x_new = x + 3 * N;
+    x_list = x + 6 * N;
+    f = x + 9 * N;
+    f_new = x + 12 * N;
+    d = x + 15 * N;
+    s = x + 18 * N;
+    y = s + 3 * N * LBFGS_MEMORY;
+
+    fd = NULL;
+    if (file_name[0] != '\0')
+    {
+        fd = fopen(file_name, "w");
+        assert(fd != NULL);
+    }
+
+    get_positions(x);
+    get_positions(x_list);
+    build_nbrs(eval_cutoff() + LBFGS_SKIN);
+    U = eval_U_and_forces();
+    get_forces(f);
+    n_forces = 1;
+    n_pairs = 0;
+    newest = -1;
+    failed = 0;
+    max_force = eval_max_force();
+    if (fd != NULL)
+        fprintf(fd, "%.15e %.15e\n", max_force, U);
+
+    for (iter = 0; max_force > MAX_FORCE; iter++)
+    {
+        if (iter == LBFGS_MAX_ITER)
+        {
+            failed = 1;
+            break;
+        }
+
+        /*two-loop recursion, d = H*F with H the inverse Hessian*/
+        for (i = 0; i < 3 * N; i++)
+            d[i] = f[i];
+
+        for (n = 0; n < n_pairs; n++)
+        {
+            k = (newest - n + LBFGS_MEMORY) % LBFGS_MEMORY;
+            a[k] = rho[k] * dot(s + 3 * N * k, d);
+            for (i = 0; i < 3 * N; i++)
+                d[i] -= a[k] * y[3 * N * k + i];
+        }
+
+        gamma = C_STEEP;
+        if (n_pairs > 0)
+            gamma = 1 / (rho[newest] * dot(y + 3 * N * newest, y + 3 * N * newest));
+
+        for (i = 0; i < 3 * N; i++)
+            d[i] *= gamma;
+
+        for (n = n_pairs - 1; n >= 0; n--)
+        {
+            k = (newest - n + LBFGS_MEMORY) % LBFGS_MEMORY;
+            beta = rho[k] * dot(y + 3 * N * k, d);
+            for (i = 0; i < 3 * N; i++)
+                d[i] += (a[k] - beta) * s[3 * N * k + i];
+        }
+
+        /*restart along the force if d is not a descent direction*/
+        slope = dot(f, d);
+        if (slope <= 0)
+        {
+            n_pairs = 0;
+            for (i = 0; i < 3 * N; i++)
+                d[i] = C_STEEP * f[i];
+            slope = dot(f, d);
+        }
+
+        max_d = 0;
+        for (i = 0; i < N; i++)
+            if (d[3 * i] * d[3 * i] + d[3 * i + 1] * d[3 * i + 1] + d[3 * i + 2] * d[3 * i + 2] > max_d)
+                max_d = d[3 * i] * d[3 * i] + d[3 * i + 1] * d[3 * i + 1] + d[3 * i + 2] * d[3 * i + 2];
+        max_d = sqrt(max_d);
+        step = (max_d > LBFGS_MAX_STEP) ? LBFGS_MAX_STEP / max_d : 1;
+
+        /*backtracking line search with the Armijo condition*/
+        while (1)
+        {
+            for (i = 0; i < 3 * N; i++)
+                x_new[i] = x[i] + step * d[i];
+
+            U_new = lbfgs_eval(x_new, x_list);
+            n_forces++;
+
+            if (U_new <= U - LBFGS_ARMIJO * step * slope)
+                break;
+
+            step /= 2;
+
+            if (step * max_d < LBFGS_MIN_STEP)
+            {
+                failed = 1;
+                break;
+            }
+        }
+
+        /*no uphill steps: restart along the force, or give up if the search
+          was already along it*/
+        if (failed)
+        {
+            U = lbfgs_eval(x, x_list);
+            n_forces++;
+
+            if (n_pairs == 0)
+                break;
+
+            n_pairs = 0;
+            failed = 0;
+            continue;
+        }
+
+        get_forces(f_new);
+
+        /*new pair (s,y), y being the change of the gradient, kept only if
+          its curvature is positive*/
+        beta = 0;
+        for (i = 0; i < 3 * N; i++)
+            beta += (x_new[i] - x[i]) * (f[i] - f_new[i]);
+
+        if (beta > 0)
+        {
+            newest = (newest + 1) % LBFGS_MEMORY;
+            rho[newest] = 1 / beta;
+            if (n_pairs < LBFGS_MEMORY)
+                n_pairs++;
+
+            for (i = 0; i < 3 * N; i++)
+            {
+                s[3 * N * newest + i] = x_new[i] - x[i];
+                y[3 * N * newest + i] = f[i] - f_new[i];
+            }
+        }
+
+        for (i = 0; i < 3 * N; i++)
+        {
+            x[i] = x_new[i];
+            f[i] = f_new[i];
+        }
+
+        U = U_new;
+        max_force = eval_max_force();
+
+        if (fd != NULL)
+            fprintf(fd, "%.15e %.15e\n", max_force, U);
+    }
+
+    if (fd != NULL)
+        fclose(fd);
+
+    eval_nbrs();
+    free(x);
+
+    return failed ? -n_forces : n_forces;
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ *
+ * Library timers.c
+ *
+ * Timers and counters of the phases of the MD engine (see timers.h): the
+ * construction of the neighbour lists, the forces, the integration, the
+ * thermostats, the observables and the output. For every phase the wall
+ * time (from the monotonic clock), the number of calls and the number of
+ * pair interactions are accumulated, both over the whole run and since the
+ * last sample; for the neighbour lists also the number of builds and the
+ * mean and largest number of neighbours.
+ *
+ * lattice.c calls these functions through the macros of timers.h, which
+ * are empty unless the programs are compiled with -DTIMERS, hence the
+ * instrumentation costs nothing when disabled. The phases must not be
+ * nested within themselves.
+ *
+ * The externally accessible functions are:
+ *
+ *  void timer_start(int phase)
+ *      Starts the clock of the phase.
+ *
+ *  void timer_stop(int phase)
+ *      Stops the clock of the phase and counts a call.
+ *
+ *  void timer_pairs(int phase, double n)
+ *      Adds n pair interactions to the phase.
+ *
+ *  void timer_nbrs(int n_atoms, int total, int max)
+ *      Records a build of the neighbour lists of n_atoms atoms with total
+ *      neighbours in all and at most max neighbours per atom.
+ *
+ *  void timers_reset(void)
+ *      Sets all timers and counters to zero.
+ *
+ *  void timers_print(FILE *fd)
+ *      Prints the summary of the run: time, share of the total, calls,
+ *      time per call and pairs per second of each phase, and the
+ *      statistics of the neighbour lists.
+ *
+ *  void timers_sample(FILE *fd, double t)
+ *      Writes a line with t and the time (s) of each phase since the last
+ *      sample, then starts a new interval.
+ *
+ * Author: Lorenzo Tasca
+ *
+ *******************************************************************************/
+#define _POSIX_C_SOURCE 199309L
+#define TIMERS_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "timers.h"
+
+static char *phase_names[N_TIMERS] = {"neighbours", "forces", "integration", "thermostat",
+                                      "observables", "output"};
+static double total[N_TIMERS], interval[N_TIMERS], started[N_TIMERS], pairs[N_TIMERS];
+static long calls[N_TIMERS];
+static long n_builds = 0;
+static double nbrs_total = 0;
+static int nbrs_max = 0;
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void timer_start(int phase)
+{
+    started[phase] = now();
+}
+
+void timer_stop(int phase)
+{
+    double dt;
+
+    dt = now() - started[phase];
+    total[phase] += dt;
+    interval[phase] += dt;
+    calls[phase]++;
+}
+
+void timer_pairs(int phase, double n)
+{
+    pairs[phase] += n;
+}
+
+void timer_nbrs(int n_atoms, int total, int max)
+{
+    n_builds++;
+    nbrs_total += (double)total / n_atoms;
+    if (max > nbrs_max)
+        nbrs_max = max;
+}
+
+void timers_reset(void)
+{
+    int k;
+
+    for (k = 0; k < N_TIMERS; k++)
+    {
+        total[k] = 0;
+        interval[k] = 0;
+        pairs[k] = 0;
+        calls[k] = 0;
+    }
+
+    n_builds = 0;
+    nbrs_total = 0;
+    nbrs_max = 0;
+}
+
+void timers_print(FILE *fd)
+{
+    int k;
+    double sum;
+
+    sum = 0;
+    for (k = 0; k < N_TIMERS; k++)
+        sum += total[k];
+
+    fprintf(fd, "# phase         time (s)   share   calls      us/call    pairs/s\n");
+
+    for (k = 0; k < N_TIMERS; k++)
+    {
+        fprintf(fd, "# %-12s  %9.4f  %5.1f%%  %8ld  %10.2f  %10.3e\n", phase_names[k], total[k],
+                (sum > 0) ? 100 * total[k] / sum : 0, calls[k],
+                (calls[k] > 0) ? 1e6 * total[k] / calls[k] : 0,
+                (total[k] > 0) ? pairs[k] / total[k] : 0);
+    }
+
+    fprintf(fd, "# total         %9.4f\n", sum);
+
+    if (n_builds > 0)
+        fprintf(fd, "# neighbour lists: %ld builds, %.2f neighbours per atom on average, "
+                    "at most %d\n",
+                n_builds, nbrs_total / n_builds, nbrs_max);
+}
+
+void timers_sample(FILE *fd, double t)
+{
+    int k;
+
+    fprintf(fd, "%.15e", t);
+
+    for (k = 0; k < N_TIMERS; k++)
+    {
+        fprintf(fd, " %.6e", interval[k]);
+        interval[k] = 0;
+    }
+
+    fprintf(fd, "\n");
+}
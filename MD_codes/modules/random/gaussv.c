@@ -0,0 +1,362 @@
+
+/*******************************************************************************
+*
+* File gaussv.c
+*
+* Generation of large arrays of double-precision Gaussian random numbers,
+* with the same distribution as gauss_dble(), i.e. proportional to exp(-x^2)
+*
+* The externally accessible functions are
+*
+*   void gauss_dble_block(double rd[],int n)
+*     Box-Muller method as in gauss_dble(), applied to blocks of uniform
+*     random numbers. The numbers are those of gauss_dble() (same uniform
+*     numbers, same order) up to rounding errors. If the machine supports
+*     AVX2 and FMA, log, sin and cos are evaluated by vectorized polynomial
+*     approximations accurate to a few ulp
+*
+*   void gauss_dble_zig(double rd[],int n)
+*     Ziggurat method of Marsaglia and Tsang (128 layers, in the version of
+*     Doornik). Most numbers cost one uniform random number and a
+*     comparison; the layer and the abscissa are taken from disjoint bits of
+*     the 48-bit output of ranlxd
+*
+* Both functions use the generator of ranlxd.c
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+#define GAUSSV_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "random.h"
+
+#if ((defined __GNUC__)&&((defined __x86_64__)||(defined __i386__)))
+#define X86
+#include <immintrin.h>
+#endif
+
+#define PI 3.141592653589793
+#define NBLK 256
+
+#define ZIG_C 128
+#define ZIG_R 3.442619855899
+#define ZIG_V 9.91256303526217e-3
+#define TWO48 281474976710656.0
+#define ZIG_ONE_BIT 9.094947017729282379150390625e-13
+
+static int simd=-1,zig_init=0;
+static double zig_x[ZIG_C+1],zig_r[ZIG_C];
+
+
+static void bm_scalar(double u[],double y[],int m)
+{
+   int k;
+   double x1,x2,rho;
+
+   for (k=0;k<m;k++)
+   {
+      x1=u[2*k];
+      x2=u[2*k+1];
+
+      rho=-log(1.0-x1);
+      rho=sqrt(rho);
+      x2*=2.0*PI;
+      y[2*k]=rho*sin(x2);
+      y[2*k+1]=rho*cos(x2);
+   }
+}
+
+#ifdef X86
+
+/*
+ * Four pairs at a time. log(x) for 0<x<=1 is e*log(2)+2*atanh(f) with
+ * x=2^e*m, sqrt(1/2)<=m<sqrt(2) and f=(m-1)/(m+1). The angle 2*pi*x2 is
+ * reduced to an octant, where the polynomials of sin and cos are the ones
+ * of the Cephes library
+ */
+
+__attribute__ ((target ("avx2,fma")))
+static void bm_avx2(double u[],double y[],int m)
+{
+   int k;
+   __m256d a,b,x1,x2,x,mt,f,s,p,e,rho,t,j,z,ps,pc,sn,cs,swap,y1,y2;
+   __m256i bits,ebits,odd,neg;
+
+   for (k=0;k+4<=m;k+=4)
+   {
+      a=_mm256_loadu_pd(u+2*k);
+      b=_mm256_loadu_pd(u+2*k+4);
+      x1=_mm256_unpacklo_pd(a,b);
+      x2=_mm256_unpackhi_pd(a,b);
+
+      /* rho=sqrt(-log(1-x1)) */
+      x=_mm256_sub_pd(_mm256_set1_pd(1.0),x1);
+      bits=_mm256_castpd_si256(x);
+      ebits=_mm256_srli_epi64(bits,52);
+      mt=_mm256_castsi256_pd(_mm256_or_si256(
+            _mm256_and_si256(bits,_mm256_set1_epi64x(0x000fffffffffffffLL)),
+            _mm256_set1_epi64x(0x3ff0000000000000LL)));
+      e=_mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(ebits,
+            _mm256_set1_epi64x(0x4330000000000000LL))),
+            _mm256_set1_pd(4503599627370496.0+1023.0));
+      t=_mm256_cmp_pd(mt,_mm256_set1_pd(1.4142135623730951),_CMP_GT_OQ);
+      mt=_mm256_blendv_pd(mt,_mm256_mul_pd(mt,_mm256_set1_pd(0.5)),t);
+      e=_mm256_add_pd(e,_mm256_and_pd(t,_mm256_set1_pd(1.0)));
+
+      f=_mm256_div_pd(_mm256_sub_pd(mt,_mm256_set1_pd(1.0)),
+                      _mm256_add_pd(mt,_mm256_set1_pd(1.0)));
+      s=_mm256_mul_pd(f,f);
+      p=_mm256_set1_pd(1.0/23.0);
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/21.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/19.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/17.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/15.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/13.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/11.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/9.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/7.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/5.0));
+      p=_mm256_fmadd_pd(p,s,_mm256_set1_pd(1.0/3.0));
+      p=_mm256_mul_pd(_mm256_mul_pd(p,s),f);
+      p=_mm256_add_pd(_mm256_add_pd(f,p),_mm256_add_pd(f,p));
+
+      /* log(x)=e*log(2)+p, log(2) split in two parts */
+      t=_mm256_fmadd_pd(e,_mm256_set1_pd(1.9082149292705877e-10),p);
+      t=_mm256_fmadd_pd(e,_mm256_set1_pd(6.93147180369123816490e-1),t);
+      rho=_mm256_sqrt_pd(_mm256_max_pd(_mm256_sub_pd(_mm256_setzero_pd(),t),
+                                       _mm256_setzero_pd()));
+
+      /* angle 2*pi*x2=2*pi*(j/4+r) with |r|<=1/8 */
+      j=_mm256_round_pd(_mm256_mul_pd(x2,_mm256_set1_pd(4.0)),
+                        _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+      t=_mm256_fnmadd_pd(j,_mm256_set1_pd(0.25),x2);
+      t=_mm256_mul_pd(t,_mm256_set1_pd(2.0*PI));
+      z=_mm256_mul_pd(t,t);
+
+      ps=_mm256_set1_pd(1.58962301576546568060e-10);
+      ps=_mm256_fmadd_pd(ps,z,_mm256_set1_pd(-2.50507477628578072866e-8));
+      ps=_mm256_fmadd_pd(ps,z,_mm256_set1_pd(2.75573136213857245213e-6));
+      ps=_mm256_fmadd_pd(ps,z,_mm256_set1_pd(-1.98412698295895385996e-4));
+      ps=_mm256_fmadd_pd(ps,z,_mm256_set1_pd(8.33333333332211858878e-3));
+      ps=_mm256_fmadd_pd(ps,z,_mm256_set1_pd(-1.66666666666666307295e-1));
+      sn=_mm256_fmadd_pd(_mm256_mul_pd(ps,z),t,t);
+
+      pc=_mm256_set1_pd(-1.13585365213876817300e-11);
+      pc=_mm256_fmadd_pd(pc,z,_mm256_set1_pd(2.08757008419747316778e-9));
+      pc=_mm256_fmadd_pd(pc,z,_mm256_set1_pd(-2.75573141792967388112e-7));
+      pc=_mm256_fmadd_pd(pc,z,_mm256_set1_pd(2.48015872888517045348e-5));
+      pc=_mm256_fmadd_pd(pc,z,_mm256_set1_pd(-1.38888888888730564116e-3));
+      pc=_mm256_fmadd_pd(pc,z,_mm256_set1_pd(4.16666666666665929218e-2));
+      cs=_mm256_fmadd_pd(_mm256_mul_pd(pc,z),z,
+                         _mm256_fnmadd_pd(z,_mm256_set1_pd(0.5),_mm256_set1_pd(1.0)));
+
+      /* quadrant j=0...4: sin and cos swapped if j is odd, sin negated if
+         j=2,3 and cos negated if j=1,2 */
+      bits=_mm256_castpd_si256(_mm256_add_pd(j,_mm256_set1_pd(4503599627370496.0)));
+      odd=_mm256_slli_epi64(bits,63);
+      swap=_mm256_castsi256_pd(_mm256_cmpeq_epi64(odd,_mm256_set1_epi64x(0x8000000000000000LL)));
+      y1=_mm256_blendv_pd(sn,cs,swap);
+      y2=_mm256_blendv_pd(cs,sn,swap);
+      neg=_mm256_slli_epi64(_mm256_srli_epi64(bits,1),63);
+      y1=_mm256_xor_pd(y1,_mm256_castsi256_pd(neg));
+      neg=_mm256_slli_epi64(_mm256_srli_epi64(_mm256_add_epi64(bits,_mm256_set1_epi64x(1)),1),63);
+      y2=_mm256_xor_pd(y2,_mm256_castsi256_pd(neg));
+
+      y1=_mm256_mul_pd(rho,y1);
+      y2=_mm256_mul_pd(rho,y2);
+
+      _mm256_storeu_pd(y+2*k,_mm256_unpacklo_pd(y1,y2));
+      _mm256_storeu_pd(y+2*k+4,_mm256_unpackhi_pd(y1,y2));
+   }
+
+   _mm256_zeroupper();
+   bm_scalar(u+2*k,y+2*k,m-k);
+}
+
+#endif
+
+void gauss_dble_block(double rd[],int n)
+{
+   int k,m,l,s;
+   double u[2*NBLK],y[2*NBLK];
+
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+   s=simd;
+
+   if (s<0)
+   {
+      s=0;
+#ifdef X86
+      __builtin_cpu_init();
+      s=((__builtin_cpu_supports("avx2")!=0)&&(__builtin_cpu_supports("fma")!=0));
+#endif
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+      simd=s;
+   }
+
+   for (k=0;k<n;k+=2*m)
+   {
+      m=(n-k+1)/2;
+      if (m>NBLK)
+         m=NBLK;
+
+      ranlxd(u,2*m);
+
+#ifdef X86
+      if (s)
+         bm_avx2(u,y,m);
+      else
+         bm_scalar(u,y,m);
+#else
+      bm_scalar(u,y,m);
+#endif
+
+      for (l=0;(l<2*m)&&(k+l<n);l++)
+         rd[k+l]=y[l];
+   }
+}
+
+
+static void init_zig(void)
+{
+   int i;
+   double f;
+
+   f=exp(-0.5*ZIG_R*ZIG_R);
+   zig_x[0]=ZIG_V/f;
+   zig_x[1]=ZIG_R;
+   zig_x[ZIG_C]=0.0;
+
+   for (i=2;i<ZIG_C;i++)
+   {
+      zig_x[i]=sqrt(-2.0*log(ZIG_V/zig_x[i-1]+f));
+      f=exp(-0.5*zig_x[i]*zig_x[i]);
+   }
+
+   for (i=0;i<ZIG_C;i++)
+      zig_r[i]=zig_x[i+1]/zig_x[i];
+
+   /* the tables are published by setting zig_init last */
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+   zig_init=1;
+}
+
+
+static int zig_ready(void)
+{
+   int r;
+
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+   r=zig_init;
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+
+   return r;
+}
+
+
+/*
+ * Standard normal number from the tail |x|>ZIG_R (Marsaglia's method)
+ */
+
+static double zig_tail(int neg)
+{
+   double v[2],x,y;
+
+   do
+   {
+      ranlxd(v,2);
+      x=log(1.0-v[0])/ZIG_R;
+      y=log(1.0-v[1]);
+   }
+   while ((-2.0*y)<(x*x));
+
+   return (neg ? x-ZIG_R : ZIG_R-x);
+}
+
+
+/*
+ * Standard normal number in the layer i with abscissa u*zig_x[i] (|u|<1),
+ * or 0 with *ok=0 if the point falls outside of the distribution
+ */
+
+static double zig_slow(int i,double u,int *ok)
+{
+   double x,f0,f1,v;
+
+   (*ok)=1;
+
+   if (i==0)
+      return zig_tail(u<0.0);
+
+   x=u*zig_x[i];
+   f0=exp(-0.5*(zig_x[i]*zig_x[i]-x*x));
+   f1=exp(-0.5*(zig_x[i+1]*zig_x[i+1]-x*x));
+   ranlxd(&v,1);
+
+   if ((f1+v*(f0-f1))<1.0)
+      return x;
+
+   (*ok)=0;
+   return 0.0;
+}
+
+
+void gauss_dble_zig(double rd[],int n)
+{
+   int k,l,m,ok,i;
+   long long kr;
+   double u[NBLK],x,s;
+
+   if (zig_ready()==0)
+   {
+#ifdef _OPENMP
+#pragma omp critical (gaussv)
+#endif
+      {
+         if (zig_init==0)
+            init_zig();
+      }
+   }
+
+   /* the standard normal numbers are scaled to the distribution exp(-x^2) */
+   s=sqrt(0.5);
+
+   for (k=0;k<n;)
+   {
+      m=n-k;
+      if (m>NBLK)
+         m=NBLK;
+
+      ranlxd(u,m);
+
+      for (l=0;l<m;l++)
+      {
+         kr=(long long)(u[l]*TWO48);
+         i=(int)(kr&(ZIG_C-1));
+         x=ZIG_ONE_BIT*(double)(kr>>7)-1.0;
+
+         if (fabs(x)<zig_r[i])
+            rd[k++]=s*(x*zig_x[i]);
+         else
+         {
+            x=zig_slow(i,x,&ok);
+            if (ok)
+               rd[k++]=s*x;
+         }
+      }
+   }
+}
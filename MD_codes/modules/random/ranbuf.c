@@ -0,0 +1,68 @@
+
+/*******************************************************************************
+*
+* File ranbuf.c
+*
+* Buffered front-end of ranlxd for programs that consume the random numbers
+* one at a time. The numbers are computed in blocks of RANBUF_SIZE by
+* ranlxd_raw_r() and handed out by the macros ranbuf_raw(), ranbuf_double()
+* and ranbuf_int() of random.h, which cost an array access in the common
+* case. Integers in a range are obtained from the 48-bit output by integer
+* arithmetic, without the conversion to double precision.
+*
+* The sequence of numbers is the one of ranlxd with the same level and seed.
+* Every buffer has its own generator, independent buffers can be used at the
+* same time (e.g. one per thread).
+*
+* The externally accessible functions are
+*
+*   void ranbuf_init(ranbuf_t *b,int level,int seed)
+*     Initializes the generator of the buffer and empties the buffer
+*
+*   int ranbuf_refill(ranbuf_t *b)
+*     Refills the buffer and returns the index of the first number, which
+*     is marked as used. Called by the macros when the buffer is empty
+*
+*   int ranbuf_index(ranbuf_t *b,int n)
+*     Returns the next integer in 0...n-1 (for 0<n<2^31), that is
+*     floor(k*n*2^-48) for the next 48-bit integer k
+*
+* Author: Lorenzo Tasca
+*
+*******************************************************************************/
+#define RANBUF_C
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "start.h"
+#include "random.h"
+
+
+void ranbuf_init(ranbuf_t *b,int level,int seed)
+{
+   rlxd_init_r(&(b->st),level,seed);
+   b->next=RANBUF_SIZE;
+}
+
+
+int ranbuf_refill(ranbuf_t *b)
+{
+   ranlxd_raw_r(&(b->st),b->raw,RANBUF_SIZE);
+   b->next=1;
+
+   return 0;
+}
+
+
+int ranbuf_index(ranbuf_t *b,int n)
+{
+   long long k,hi,lo;
+
+   k=ranbuf_raw(b);
+   hi=k>>24;
+   lo=k&0xffffff;
+
+   /* floor((hi*2^24+lo)*n*2^-48) without overflow */
+   return (int)((hi*n+((lo*n)>>24))>>24);
+}
+
@@ -31,6 +31,22 @@
 *   void rlxs_reset(int state[])
 *     Resets the generator to the state defined by the array state[N]
 *
+*   void ranlxs_r(rlxs_state_t *st,float r[],int n)
+*   void rlxs_init_r(rlxs_state_t *st,int level,int seed)
+*   void rlxs_get_r(rlxs_state_t *st,int state[])
+*   void rlxs_reset_r(rlxs_state_t *st,int state[])
+*     Same as above for the generator with state *st (see random.h).
+*     Independent generators can be used at the same time, e.g. one
+*     per thread. A zero-initialized state is initialized on first use
+*     as ranlxs() is
+*
+* Without -DSSE/-DSSE2 the update of the state is done by rlx_update()
+* (rlxvec.c), which selects a vector kernel at run time.
+*
+* The functions without state act on a generator private to this file.
+* When compiled with OpenMP it is private to each thread, and every
+* thread must initialize its own generator
+*
 * Version: 3.0
 * Author: Martin Luescher <luscher@mail.cern.ch>
 *
@@ -43,27 +59,12 @@
 #include <stdio.h>
 #include <math.h>
 #include "start.h"
+#include "random.h"
 
 #if ((defined SSE)||(defined SSE2))
 
-typedef struct
-{
-   float c1,c2,c3,c4;
-} vec_t __attribute__ ((aligned (16)));
-
-typedef struct
-{
-   vec_t c1,c2;
-} dble_vec_t __attribute__ ((aligned (16)));
-
-static int init=0,pr,prm,ir,jr,is,is_old,next[96];
-static vec_t one,one_bit,carry;
-
-static union
-{
-   dble_vec_t vec[12];
-   float num[96];
-} x __attribute__ ((aligned (16)));
+typedef rlx_vec_t vec_t;
+typedef rlx_dble_vec_t dble_vec_t;
 
 #define STEP(pi,pj) \
   __asm__ __volatile__ ("movaps %2, %%xmm4 \n\t" \
@@ -94,25 +95,25 @@ static union
                         "m" ((*pj).c2))
 
 
-static void update()
+static void update(rlxs_state_t *st)
 {
    int k,kmax;
    dble_vec_t *pmin,*pmax,*pi,*pj;
 
-   kmax=pr;
-   pmin=&x.vec[0];
+   kmax=st->pr;
+   pmin=&st->x.vec[0];
    pmax=pmin+12;
-   pi=&x.vec[ir];
-   pj=&x.vec[jr];
+   pi=&st->x.vec[st->ir];
+   pj=&st->x.vec[st->jr];
 
    __asm__ __volatile__ ("movaps %0, %%xmm0 \n\t"
                          "movaps %1, %%xmm1 \n\t"
                          "movaps %2, %%xmm2"
                          :
                          :
-                         "m" (one_bit),
-                         "m" (one),
-                         "m" (carry));
+                         "m" (st->one_bit),
+                         "m" (st->one),
+                         "m" (st->carry));
    
    for (k=0;k<kmax;k++) 
    {
@@ -128,57 +129,57 @@ static void update()
    __asm__ __volatile__ ("movaps %%xmm2, %0"
                          :
                          :
-                         "m" (carry));
+                         "m" (st->carry));
    
-   ir+=prm;
-   jr+=prm;
-   if (ir>=12)
-      ir-=12;
-   if (jr>=12)
-      jr-=12;
-   is=8*ir;
-   is_old=is;
+   st->ir+=st->prm;
+   st->jr+=st->prm;
+   if (st->ir>=12)
+      st->ir-=12;
+   if (st->jr>=12)
+      st->jr-=12;
+   st->is=8*st->ir;
+   st->is_old=st->is;
 }
 
 
-static void define_constants()
+static void define_constants(rlxs_state_t *st)
 {
    int k;
    float b;
 
-   one.c1=1.0f;
-   one.c2=1.0f;
-   one.c3=1.0f;
-   one.c4=1.0f;   
+   st->one.c1=1.0f;
+   st->one.c2=1.0f;
+   st->one.c3=1.0f;
+   st->one.c4=1.0f;   
 
    b=(float)(ldexp(1.0,-24));
-   one_bit.c1=b;
-   one_bit.c2=b;
-   one_bit.c3=b;
-   one_bit.c4=b;
+   st->one_bit.c1=b;
+   st->one_bit.c2=b;
+   st->one_bit.c3=b;
+   st->one_bit.c4=b;
    
    for (k=0;k<96;k++)
-      next[k]=(k+1)%96;
+      st->next[k]=(k+1)%96;
 }
 
 
-void rlxs_init(int level,int seed)
+void rlxs_init_r(rlxs_state_t *st,int level,int seed)
 {
    int i,k,l;
    int ibit,jbit,xbit[31];
    int ix,iy;
 
-   define_constants();
+   define_constants(st);
 
    error((level<0)||(level>2),1,"rlxs_init [ranlxs.c]",
          "Bad choice of luxury level (should be 0,1 or 2)");
          
    if (level==0)
-      pr=109;
+      st->pr=109;
    else if (level==1)
-      pr=202;
+      st->pr=202;
    else if (level==2)
-      pr=397;
+      st->pr=397;
 
    i=seed;
 
@@ -213,37 +214,37 @@ void rlxs_init(int level,int seed)
          if ((k%4)==i)
             ix=16777215-ix;
 
-         x.num[4*k+i]=(float)(ldexp((double)(ix),-24));
+         st->x.num[4*k+i]=(float)(ldexp((double)(ix),-24));
       }
    }
 
-   carry.c1=0.0f;
-   carry.c2=0.0f;
-   carry.c3=0.0f;
-   carry.c4=0.0f;
+   st->carry.c1=0.0f;
+   st->carry.c2=0.0f;
+   st->carry.c3=0.0f;
+   st->carry.c4=0.0f;
    
-   ir=0;
-   jr=7;
-   is=95;
-   is_old=0;
-   prm=pr%12;
-   init=1;
+   st->ir=0;
+   st->jr=7;
+   st->is=95;
+   st->is_old=0;
+   st->prm=st->pr%12;
+   st->init=1;
 }
 
 
-void ranlxs(float r[],int n)
+void ranlxs_r(rlxs_state_t *st,float r[],int n)
 {
    int k;
 
-   if (init==0)
-      rlxs_init(0,1);
+   if (st->init==0)
+      rlxs_init_r(st,0,1);
 
    for (k=0;k<n;k++) 
    {
-      is=next[is];
-      if (is==is_old)
-         update();
-      r[k]=x.num[is];
+      st->is=st->next[st->is];
+      if (st->is==st->is_old)
+         update(st);
+      r[k]=st->x.num[st->is];
    }
 }
 
@@ -254,37 +255,37 @@ int rlxs_size(void)
 }
 
 
-void rlxs_get(int state[])
+void rlxs_get_r(rlxs_state_t *st,int state[])
 {
    int k;
    float base;
 
-   error(init==0,1,"rlxs_get [ranlxs.c]",
+   error(st->init==0,1,"rlxs_get [ranlxs.c]",
          "Undefined state (ranlxs is not initialized");
 
    base=(float)(ldexp(1.0,24));
    state[0]=rlxs_size();
 
    for (k=0;k<96;k++)
-      state[k+1]=(int)(base*x.num[k]);
+      state[k+1]=(int)(base*st->x.num[k]);
 
-   state[97]=(int)(base*carry.c1);
-   state[98]=(int)(base*carry.c2);
-   state[99]=(int)(base*carry.c3);
-   state[100]=(int)(base*carry.c4);
+   state[97]=(int)(base*st->carry.c1);
+   state[98]=(int)(base*st->carry.c2);
+   state[99]=(int)(base*st->carry.c3);
+   state[100]=(int)(base*st->carry.c4);
 
-   state[101]=pr;
-   state[102]=ir;
-   state[103]=jr;
-   state[104]=is;
+   state[101]=st->pr;
+   state[102]=st->ir;
+   state[103]=st->jr;
+   state[104]=st->is;
 }
 
 
-void rlxs_reset(int state[])
+void rlxs_reset_r(rlxs_state_t *st,int state[])
 {
    int k;
 
-   define_constants();
+   define_constants(st);
 
    error(state[0]!=rlxs_size(),1,"rlxs_reset [ranlxs.c]",
          "Unexpected input data");
@@ -294,7 +295,7 @@ void rlxs_reset(int state[])
       error((state[k+1]<0)||(state[k+1]>=167777216),1,
             "rlxs_reset [ranlxs.c]","Unexpected input data");
 
-      x.num[k]=(float)(ldexp((double)(state[k+1]),-24));
+      st->x.num[k]=(float)(ldexp((double)(state[k+1]),-24));
    }
 
    error(((state[97]!=0)&&(state[97]!=1))||
@@ -303,130 +304,54 @@ void rlxs_reset(int state[])
          ((state[100]!=0)&&(state[100]!=1)),1,
          "rlxs_reset [ranlxs.c]","Unexpected input data");
    
-   carry.c1=(float)(ldexp((double)(state[97]),-24));
-   carry.c2=(float)(ldexp((double)(state[98]),-24));
-   carry.c3=(float)(ldexp((double)(state[99]),-24));
-   carry.c4=(float)(ldexp((double)(state[100]),-24));
-
-   pr=state[101];
-   ir=state[102];
-   jr=state[103];
-   is=state[104];
-   is_old=8*ir;
-   prm=pr%12;
-   init=1;
+   st->carry.c1=(float)(ldexp((double)(state[97]),-24));
+   st->carry.c2=(float)(ldexp((double)(state[98]),-24));
+   st->carry.c3=(float)(ldexp((double)(state[99]),-24));
+   st->carry.c4=(float)(ldexp((double)(state[100]),-24));
+
+   st->pr=state[101];
+   st->ir=state[102];
+   st->jr=state[103];
+   st->is=state[104];
+   st->is_old=8*st->ir;
+   st->prm=st->pr%12;
+   st->init=1;
    
-   error(((pr!=109)&&(pr!=202)&&(pr!=397))||
-         (ir<0)||(ir>11)||(jr<0)||(jr>11)||(jr!=((ir+7)%12))||
-         (is<0)||(is>95),1,
+   error(((st->pr!=109)&&(st->pr!=202)&&(st->pr!=397))||
+         (st->ir<0)||(st->ir>11)||(st->jr<0)||(st->jr>11)||(st->jr!=((st->ir+7)%12))||
+         (st->is<0)||(st->is>95),1,
          "rlxs_reset [ranlxs.c]","Unexpected input data");
 }
 
 #else
 
-#define BASE 0x1000000
-#define MASK 0xffffff
-
-typedef struct
-{
-   int c1,c2,c3,c4;
-} vec_t;
-
-typedef struct
+static void update(rlxs_state_t *st)
 {
-   vec_t c1,c2;
-} dble_vec_t;
-
-static int init=0,pr,prm,ir,jr,is,is_old,next[96];
-static float one_bit;
-static vec_t carry;
-
-static union
-{
-   dble_vec_t vec[12];
-   int num[96];
-} x;
-
-#define STEP(pi,pj) \
-      d=(*pj).c1.c1-(*pi).c1.c1-carry.c1; \
-      (*pi).c2.c1+=(d<0); \
-      d+=BASE; \
-      (*pi).c1.c1=d&MASK; \
-      d=(*pj).c1.c2-(*pi).c1.c2-carry.c2; \
-      (*pi).c2.c2+=(d<0); \
-      d+=BASE; \
-      (*pi).c1.c2=d&MASK; \
-      d=(*pj).c1.c3-(*pi).c1.c3-carry.c3; \
-      (*pi).c2.c3+=(d<0); \
-      d+=BASE; \
-      (*pi).c1.c3=d&MASK; \
-      d=(*pj).c1.c4-(*pi).c1.c4-carry.c4; \
-      (*pi).c2.c4+=(d<0); \
-      d+=BASE; \
-      (*pi).c1.c4=d&MASK; \
-      d=(*pj).c2.c1-(*pi).c2.c1; \
-      carry.c1=(d<0); \
-      d+=BASE; \
-      (*pi).c2.c1=d&MASK; \
-      d=(*pj).c2.c2-(*pi).c2.c2; \
-      carry.c2=(d<0); \
-      d+=BASE; \
-      (*pi).c2.c2=d&MASK; \
-      d=(*pj).c2.c3-(*pi).c2.c3; \
-      carry.c3=(d<0); \
-      d+=BASE; \
-      (*pi).c2.c3=d&MASK; \
-      d=(*pj).c2.c4-(*pi).c2.c4; \
-      carry.c4=(d<0); \
-      d+=BASE; \
-      (*pi).c2.c4=d&MASK
-
-
-static void update()
-{
-   int k,kmax,d;
-   dble_vec_t *pmin,*pmax,*pi,*pj;
-
-   kmax=pr;
-   pmin=&x.vec[0];
-   pmax=pmin+12;
-   pi=&x.vec[ir];
-   pj=&x.vec[jr];
-      
-   for (k=0;k<kmax;k++) 
-   {
-      STEP(pi,pj);
-      pi+=1;
-      pj+=1;
-      if (pi==pmax)
-         pi=pmin;      
-      if (pj==pmax)
-         pj=pmin; 
-   }
-
-   ir+=prm;
-   jr+=prm;
-   if (ir>=12)
-      ir-=12;
-   if (jr>=12)
-      jr-=12;
-   is=8*ir;
-   is_old=is;
+   rlx_update(st->x.vec,&st->carry,st->ir,st->jr,st->pr);
+
+   st->ir+=st->prm;
+   st->jr+=st->prm;
+   if (st->ir>=12)
+      st->ir-=12;
+   if (st->jr>=12)
+      st->jr-=12;
+   st->is=8*st->ir;
+   st->is_old=st->is;
 }
 
 
-static void define_constants()
+static void define_constants(rlxs_state_t *st)
 {
    int k;
 
-   one_bit=(float)(ldexp(1.0,-24));
+   st->one_bit=(float)(ldexp(1.0,-24));
 
    for (k=0;k<96;k++)
-      next[k]=(k+1)%96;
+      st->next[k]=(k+1)%96;
 }
 
 
-void rlxs_init(int level,int seed)
+void rlxs_init_r(rlxs_state_t *st,int level,int seed)
 {
    int i,k,l;
    int ibit,jbit,xbit[31];
@@ -436,17 +361,17 @@ void rlxs_init(int level,int seed)
          "rlxs_init [ranlxs.c]",
          "Arithmetic on this machine is not suitable for ranlxs");
 
-   define_constants();
+   define_constants(st);
    
    error((level<0)||(level>2),1,"rlxs_init [ranlxs.c]",
          "Bad choice of luxury level (should be 0,1 or 2)");   
    
    if (level==0)
-      pr=109;
+      st->pr=109;
    else if (level==1)
-      pr=202;
+      st->pr=202;
    else if (level==2)
-      pr=397;
+      st->pr=397;
    
    i=seed;
 
@@ -481,37 +406,37 @@ void rlxs_init(int level,int seed)
          if ((k%4)==i)
             ix=16777215-ix;
 
-         x.num[4*k+i]=ix;
+         st->x.num[4*k+i]=ix;
       }
    }
 
-   carry.c1=0;
-   carry.c2=0;
-   carry.c3=0;
-   carry.c4=0;
-
-   ir=0;
-   jr=7;
-   is=95;
-   is_old=0;
-   prm=pr%12;
-   init=1;
+   st->carry.c1=0;
+   st->carry.c2=0;
+   st->carry.c3=0;
+   st->carry.c4=0;
+
+   st->ir=0;
+   st->jr=7;
+   st->is=95;
+   st->is_old=0;
+   st->prm=st->pr%12;
+   st->init=1;
 }
 
 
-void ranlxs(float r[],int n)
+void ranlxs_r(rlxs_state_t *st,float r[],int n)
 {
    int k;
 
-   if (init==0)
-      rlxs_init(0,1);
+   if (st->init==0)
+      rlxs_init_r(st,0,1);
 
    for (k=0;k<n;k++) 
    {
-      is=next[is];
-      if (is==is_old)
-         update();
-      r[k]=one_bit*(float)(x.num[is]);      
+      st->is=st->next[st->is];
+      if (st->is==st->is_old)
+         update(st);
+      r[k]=st->one_bit*(float)(st->x.num[st->is]);      
    }
 }
 
@@ -522,31 +447,31 @@ int rlxs_size(void)
 }
 
 
-void rlxs_get(int state[])
+void rlxs_get_r(rlxs_state_t *st,int state[])
 {
    int k;
 
-   error(init==0,1,"rlxs_get [ranlxs.c]",
+   error(st->init==0,1,"rlxs_get [ranlxs.c]",
          "Undefined state (ranlxs is not initialized");
 
    state[0]=rlxs_size();
 
    for (k=0;k<96;k++)
-      state[k+1]=x.num[k];
+      state[k+1]=st->x.num[k];
 
-   state[97]=carry.c1;
-   state[98]=carry.c2;
-   state[99]=carry.c3;
-   state[100]=carry.c4;
+   state[97]=st->carry.c1;
+   state[98]=st->carry.c2;
+   state[99]=st->carry.c3;
+   state[100]=st->carry.c4;
 
-   state[101]=pr;
-   state[102]=ir;
-   state[103]=jr;
-   state[104]=is;
+   state[101]=st->pr;
+   state[102]=st->ir;
+   state[103]=st->jr;
+   state[104]=st->is;
 }
 
 
-void rlxs_reset(int state[])
+void rlxs_reset_r(rlxs_state_t *st,int state[])
 {
    int k;
 
@@ -554,7 +479,7 @@ void rlxs_reset(int state[])
          "rlxs_reset [ranlxs.c]",
          "Arithmetic on this machine is not suitable for ranlxs");
 
-   define_constants();
+   define_constants(st);
 
    error(state[0]!=rlxs_size(),1,"rlxs_reset [ranlxs.c]",
          "Unexpected input data");   
@@ -564,7 +489,7 @@ void rlxs_reset(int state[])
       error((state[k+1]<0)||(state[k+1]>=167777216),1,
             "rlxs_reset [ranlxs.c]","Unexpected input data");      
 
-      x.num[k]=state[k+1];
+      st->x.num[k]=state[k+1];
    }
 
    error(((state[97]!=0)&&(state[97]!=1))||
@@ -573,24 +498,55 @@ void rlxs_reset(int state[])
          ((state[100]!=0)&&(state[100]!=1)),1,
          "rlxs_reset [ranlxs.c]","Unexpected input data");   
    
-   carry.c1=state[97];
-   carry.c2=state[98];
-   carry.c3=state[99];
-   carry.c4=state[100];
-
-   pr=state[101];
-   ir=state[102];
-   jr=state[103];
-   is=state[104];
-   is_old=8*ir;
-   prm=pr%12;
-   init=1;
-
-   error(((pr!=109)&&(pr!=202)&&(pr!=397))||
-         (ir<0)||(ir>11)||(jr<0)||(jr>11)||(jr!=((ir+7)%12))||
-         (is<0)||(is>95),1,
+   st->carry.c1=state[97];
+   st->carry.c2=state[98];
+   st->carry.c3=state[99];
+   st->carry.c4=state[100];
+
+   st->pr=state[101];
+   st->ir=state[102];
+   st->jr=state[103];
+   st->is=state[104];
+   st->is_old=8*st->ir;
+   st->prm=st->pr%12;
+   st->init=1;
+
+   error(((st->pr!=109)&&(st->pr!=202)&&(st->pr!=397))||
+         (st->ir<0)||(st->ir>11)||(st->jr<0)||(st->jr>11)||(st->jr!=((st->ir+7)%12))||
+         (st->is<0)||(st->is>95),1,
          "rlxs_reset [ranlxs.c]","Unexpected input data");   
 }
 
 #endif
 
+
+static rlxs_state_t rlxs_global;
+
+#ifdef _OPENMP
+#pragma omp threadprivate(rlxs_global)
+#endif
+
+
+void ranlxs(float r[],int n)
+{
+   ranlxs_r(&rlxs_global,r,n);
+}
+
+
+void rlxs_init(int level,int seed)
+{
+   rlxs_init_r(&rlxs_global,level,seed);
+}
+
+
+void rlxs_get(int state[])
+{
+   rlxs_get_r(&rlxs_global,state);
+}
+
+
+void rlxs_reset(int state[])
+{
+   rlxs_reset_r(&rlxs_global,state);
+}
+